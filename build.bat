@@ -5,6 +5,7 @@ set arch=
 set dll=false
 set staticcrt=false
 set test=false
+set benchmark=false
 
 :next-arg
 if "%1"=="" goto args-done
@@ -15,6 +16,7 @@ if /i "%1"=="x64"           set arch=x64&goto arg-ok
 if /i "%1"=="dll"           set dll=true&goto arg-ok
 if /i "%1"=="static"        set staticcrt=true&goto arg-ok
 if /i "%1"=="test"           set test=true&goto arg-ok
+if /i "%1"=="benchmark"     set benchmark=true&goto arg-ok
 REM if /i "%1"=="arm"           set arch=ARM&goto arg-ok
 REM if /i "%1"=="arm64"         set arch=ARM64&goto arg-ok
 
@@ -41,10 +43,10 @@ if "%staticcrt%"=="true" (
 )
 
 echo ========================================
-echo %cd%$ cmake -A %arch% -DCCPM_BUILD_DLL=%dll% -DCCPM_BUILD_TEST=%test% %staticcrtoverride% ..\..\..
+echo %cd%$ cmake -A %arch% -DCCPM_BUILD_DLL=%dll% -DCCPM_BUILD_TEST=%test% -DCCPM_BUILD_BENCHMARK=%benchmark% %staticcrtoverride% ..\..\..
 echo ========================================
 
-cmake -A %arch% -DCCPM_BUILD_DLL=%dll% -DCCPM_BUILD_TEST=%test% %staticcrtoverride% ..\..\..
+cmake -A %arch% -DCCPM_BUILD_DLL=%dll% -DCCPM_BUILD_TEST=%test% -DCCPM_BUILD_BENCHMARK=%benchmark% %staticcrtoverride% ..\..\..
 
 echo ========================================
 echo %cd%$ cmake --build . --config %mode%
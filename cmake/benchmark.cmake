@@ -0,0 +1,12 @@
+file(GLOB BENCHMARK_SOURCE_FILES "benchmark/*.cpp")
+
+foreach(BENCHMARK_SOURCE_FILE ${BENCHMARK_SOURCE_FILES})
+  get_filename_component(BENCHMARK_NAME ${BENCHMARK_SOURCE_FILE} NAME_WE)
+  set(BENCHMARK_EXE_NAME ${LIB_NAME}benchmark-${BENCHMARK_NAME})
+  add_executable(${BENCHMARK_EXE_NAME} ${BENCHMARK_SOURCE_FILE})
+  set_target_properties(${BENCHMARK_EXE_NAME} PROPERTIES CXX_STANDARD 11)
+  target_link_libraries(${BENCHMARK_EXE_NAME} ${LIB_NAME})
+  if(WIN32 AND MSVC)
+    target_compile_options(${BENCHMARK_EXE_NAME} PRIVATE /utf-8)
+  endif()
+endforeach()
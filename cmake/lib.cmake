@@ -18,6 +18,9 @@ endif()
 
 set_target_properties(${LIB_NAME} PROPERTIES CXX_STANDARD 11)
 
+find_package(Threads REQUIRED)
+target_link_libraries(${LIB_NAME} ${CMAKE_DL_LIBS} Threads::Threads)
+
 # set_target_properties(${LIB_NAME} PROPERTIES PREFIX "lib")
 
 if(WIN32 AND MSVC)
@@ -0,0 +1,32 @@
+set(COMMANDLINE_HELPGEN_SOURCE ${CMAKE_CURRENT_LIST_DIR}/../src/helpgen/main.cpp)
+
+# commandline_prerender_help(<target> SCHEMA <sources...> [SYMBOL <name>])
+#
+# Builds <target>-helpgen from the schema sources, which define
+# commandline::createPrerenderParser(), runs it and compiles the help it
+# renders into <target> as a CommandLinePrerenderedHelp named <name>
+# (default: prerenderedHelp). The tool passes it to usePrerenderedHelp().
+function(commandline_prerender_help TARGET)
+  cmake_parse_arguments(ARG "" "SYMBOL" "SCHEMA" ${ARGN})
+  if(NOT ARG_SYMBOL)
+    set(ARG_SYMBOL prerenderedHelp)
+  endif()
+
+  set(GENERATOR ${TARGET}-helpgen)
+  add_executable(${GENERATOR} ${COMMANDLINE_HELPGEN_SOURCE} ${ARG_SCHEMA})
+  set_target_properties(${GENERATOR} PROPERTIES CXX_STANDARD 11)
+  target_link_libraries(${GENERATOR} ${LIB_NAME})
+  if(WIN32 AND MSVC)
+    target_compile_options(${GENERATOR} PRIVATE /utf-8)
+  endif()
+
+  set(OUTPUT ${CMAKE_CURRENT_BINARY_DIR}/${TARGET}-help.cpp)
+  add_custom_command(
+    OUTPUT ${OUTPUT}
+    COMMAND ${GENERATOR} ${OUTPUT} ${ARG_SYMBOL}
+    DEPENDS ${GENERATOR}
+    COMMENT "Rendering the help of ${TARGET}"
+    VERBATIM
+  )
+  target_sources(${TARGET} PRIVATE ${OUTPUT})
+endfunction()
@@ -1,4 +1,5 @@
 file(GLOB_RECURSE TEST_SOURCE_FILES "test/*.c" "test/*.cpp")
+list(FILTER TEST_SOURCE_FILES EXCLUDE REGEX "/test/plugin/")
 
 add_executable(${TEST_EXE_NAME}
   ${TEST_SOURCE_FILES}
@@ -8,6 +9,28 @@ set_target_properties(${TEST_EXE_NAME} PROPERTIES CXX_STANDARD 11)
 
 target_link_libraries(${TEST_EXE_NAME} ${LIB_NAME})
 
+commandline_prerender_help(${TEST_EXE_NAME} SCHEMA test/schema.cpp SYMBOL testPrerenderedHelp)
+target_compile_definitions(${TEST_EXE_NAME} PRIVATE COMMANDLINE_TEST_PRERENDERED_HELP)
+
+if(NOT MSVC)
+  set(TEST_PLUGIN_NAME ${TEST_EXE_NAME}plugin)
+  file(GLOB_RECURSE TEST_PLUGIN_SOURCE_FILES "test/plugin/*.cpp")
+  add_library(${TEST_PLUGIN_NAME} MODULE ${TEST_PLUGIN_SOURCE_FILES})
+  set_target_properties(${TEST_PLUGIN_NAME} PROPERTIES CXX_STANDARD 11)
+  target_include_directories(${TEST_PLUGIN_NAME} PRIVATE ${CMAKE_CURRENT_SOURCE_DIR}/include)
+  if(CCPM_BUILD_DLL)
+    target_link_libraries(${TEST_PLUGIN_NAME} ${LIB_NAME})
+  else()
+    # resolve library symbols against the test executable at load time
+    set_target_properties(${TEST_EXE_NAME} PROPERTIES ENABLE_EXPORTS ON)
+    if(APPLE)
+      set_target_properties(${TEST_PLUGIN_NAME} PROPERTIES LINK_FLAGS "-undefined dynamic_lookup")
+    endif()
+  endif()
+  add_dependencies(${TEST_EXE_NAME} ${TEST_PLUGIN_NAME})
+  target_compile_definitions(${TEST_EXE_NAME} PRIVATE COMMANDLINE_TEST_PLUGIN_PATH="$<TARGET_FILE:${TEST_PLUGIN_NAME}>")
+endif()
+
 if(WIN32 AND MSVC)
   set_directory_properties(PROPERTIES VS_STARTUP_PROJECT ${TEST_EXE_NAME})
   # set_target_properties(${TEST_EXE_NAME} PROPERTIES MSVC_RUNTIME_LIBRARY "MultiThreaded$<$<CONFIG:Debug>:Debug>")
@@ -0,0 +1,7 @@
+# commandline-telemetry prints the reports of telemetry files
+add_executable(${LIB_NAME}-telemetry src/telemetry/main.cpp)
+set_target_properties(${LIB_NAME}-telemetry PROPERTIES CXX_STANDARD 11)
+target_link_libraries(${LIB_NAME}-telemetry ${LIB_NAME})
+if(WIN32 AND MSVC)
+  target_compile_options(${LIB_NAME}-telemetry PRIVATE /utf-8)
+endif()
@@ -2,8 +2,10 @@
 #define __COMMAND_LINE_ACTION_HPP__
 
 #include <regex>
+#include <future>
 #include "CommandLineParameterProvider.hpp"
 #include "CommandLineDefinition.hpp"
+#include "CommandLineExecution.hpp"
 
 namespace commandline {
 
@@ -12,8 +14,9 @@ class CommandLineAction : public CommandLineParameterProvider {
   void _init(const CommandLineActionOptions&);
  public:
   std::string actionName;
-  std::string summary;
-  std::string documentation;
+  CommandLineText summary;
+  CommandLineText documentation;
+  std::chrono::milliseconds timeout;
   CommandLineAction();
   CommandLineAction(const CommandLineActionOptions&);
   virtual ~CommandLineAction();
@@ -30,13 +33,26 @@ class CommandLineAction : public CommandLineParameterProvider {
 
   virtual void _processArgs(const std::vector<std::string>&);
 
+  /**
+   * Called by the parser once this action has been selected, before its
+   * arguments are processed or its help text is rendered.
+   */
+  virtual void _activate();
+
   virtual void onDefineParameters() = 0;
   virtual void onExecute() = 0;
+  /**
+   * Used by CommandLineParser::executeAsync(). The default implementation
+   * runs onExecute() and returns a ready future. Overrides should stop
+   * promptly once the token of the context is cancelled.
+   */
+  virtual std::future<void> onExecuteAsync(CommandLineExecutionContext&);
 
   virtual std::string renderHelpText(const std::string&) const;
 
   void _buildParser();
   void _execute();
+  std::future<void> _executeAsync(CommandLineExecutionContext&);
 };
 
 }
@@ -0,0 +1,112 @@
+#ifndef __COMMAND_LINE_ACTION_REGISTRY_HPP__
+#define __COMMAND_LINE_ACTION_REGISTRY_HPP__
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace commandline {
+
+class CommandLineAction;
+
+/** What a tool knows about a registered action before constructing it. */
+struct CommandLineActionDescriptor {
+  const char* actionName;
+  const char* summary;
+  CommandLineAction* (*create)();
+  // Only used where registrations are chained at startup, see below
+  const CommandLineActionDescriptor* next;
+};
+
+/**
+ * The actions registered with COMMANDLINE_REGISTER_ACTION() in one module.
+ * On ELF platforms the linker collects their descriptors into one section,
+ * so registering costs no code at startup; elsewhere each registration links
+ * its descriptor into a list during static initialization, without
+ * allocating.
+ */
+class CommandLineActionRegistry {
+ private:
+  const CommandLineActionDescriptor* const* _begin;
+  const CommandLineActionDescriptor* const* _end;
+  const CommandLineActionDescriptor* _list;
+  // Descriptors sorted by name, built by the first find()
+  mutable std::vector<const CommandLineActionDescriptor*> _index;
+
+ public:
+  CommandLineActionRegistry(const CommandLineActionDescriptor* const* begin, const CommandLineActionDescriptor* const* end, const CommandLineActionDescriptor* list);
+
+  /**
+   * Returns the descriptor registered under actionName, the first in link
+   * order if there are several, or nullptr. The first call sorts the
+   * descriptors by name; later ones are a binary search.
+   */
+  const CommandLineActionDescriptor* find(const std::string& actionName) const;
+  bool empty() const;
+
+  /** Calls visit for every descriptor, in link order. */
+  template <typename F>
+  void forEach(F visit) const {
+    for (const CommandLineActionDescriptor* const* it = this->_begin; it != this->_end; ++it) {
+      if (*it != nullptr) visit(**it);
+    }
+    for (const CommandLineActionDescriptor* d = this->_list; d != nullptr; d = d->next) {
+      visit(*d);
+    }
+  }
+};
+
+/** Chains a descriptor into the startup list; used by COMMANDLINE_REGISTER_ACTION() where there are no linker sections. */
+class CommandLineActionRegistrar {
+ public:
+  explicit CommandLineActionRegistrar(CommandLineActionDescriptor& descriptor);
+};
+
+/** The head of the startup list. */
+const CommandLineActionDescriptor* _registeredActionList();
+
+}
+
+#if defined(__ELF__)
+
+// Defined by the linker for the section of the module that refers to them;
+// weak, so a module without registrations sees an empty range
+extern "C" {
+  extern const commandline::CommandLineActionDescriptor* const __start_commandline_actions[] __attribute__((weak, visibility("hidden")));
+  extern const commandline::CommandLineActionDescriptor* const __stop_commandline_actions[] __attribute__((weak, visibility("hidden")));
+}
+
+/**
+ * Registers the action class Type, which needs a default constructor, under
+ * name. Type has to be an unqualified name; use it in the namespace of the
+ * class. The parser constructs the action only once it is selected.
+ */
+#define COMMANDLINE_REGISTER_ACTION(Type, name, summary) \
+  static commandline::CommandLineAction* commandlineCreate_##Type() { return new Type(); } \
+  static const commandline::CommandLineActionDescriptor commandlineDescriptor_##Type = { name, summary, &commandlineCreate_##Type, nullptr }; \
+  __attribute__((used, section("commandline_actions"))) \
+  static const commandline::CommandLineActionDescriptor* const commandlineEntry_##Type = &commandlineDescriptor_##Type;
+
+namespace commandline {
+  /** The actions registered in the calling module. */
+  inline CommandLineActionRegistry registeredActions() {
+    return CommandLineActionRegistry(__start_commandline_actions, __stop_commandline_actions, nullptr);
+  }
+}
+
+#else
+
+#define COMMANDLINE_REGISTER_ACTION(Type, name, summary) \
+  static commandline::CommandLineAction* commandlineCreate_##Type() { return new Type(); } \
+  static commandline::CommandLineActionDescriptor commandlineDescriptor_##Type = { name, summary, &commandlineCreate_##Type, nullptr }; \
+  static const commandline::CommandLineActionRegistrar commandlineRegistrar_##Type(commandlineDescriptor_##Type);
+
+namespace commandline {
+  inline CommandLineActionRegistry registeredActions() {
+    return CommandLineActionRegistry(nullptr, nullptr, _registeredActionList());
+  }
+}
+
+#endif
+
+#endif
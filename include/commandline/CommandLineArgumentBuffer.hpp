@@ -0,0 +1,81 @@
+#ifndef __COMMAND_LINE_ARGUMENT_BUFFER_HPP__
+#define __COMMAND_LINE_ARGUMENT_BUFFER_HPP__
+
+#include <functional>
+#include <map>
+#include "CommandLineParameterProvider.hpp"
+
+namespace commandline {
+
+/**
+ * Renders parsed parameters into argv/envp arrays that can be passed directly
+ * to posix_spawn() or execve(). All strings live in one contiguous block which
+ * is rebuilt only when a source provider has processed new arguments, the
+ * buffer configuration changed or invalidate() was called, so repeated
+ * spawns reuse the same memory. The arrays stay valid until the next rebuild.
+ * Writing to the field of a bound parameter does not rebuild; call
+ * invalidate() afterwards to forward the new value.
+ */
+class CommandLineArgumentBuffer {
+ public:
+  typedef std::function<bool(const CommandLineParameter*)> ParameterFilter;
+ private:
+  struct Source {
+    const CommandLineParameterProvider* provider;
+    bool includeRemainder;
+    uint64_t revision;
+  };
+
+  std::string _executable;
+  std::vector<Source> _sources;
+  std::vector<std::string> _passthroughArgs;
+  ParameterFilter _filter;
+  bool _explicitOnly;
+  bool _inheritEnvironment;
+  std::map<std::string, std::string> _environment;
+  bool _dirty;
+
+  std::vector<char> _bytes;
+  std::vector<size_t> _offsets;
+  size_t _argc;
+  std::vector<char*> _pointers;
+
+  bool _isStale() const;
+  void _refresh();
+  void _build();
+  void _appendArg(const char*, size_t);
+  void _appendArg(const std::string&);
+  void _appendEnvironmentVariable(const std::string&, const std::string&);
+  void _appendParameter(const CommandLineParameter*);
+ public:
+  CommandLineArgumentBuffer();
+  CommandLineArgumentBuffer(const std::string& executable);
+
+  CommandLineArgumentBuffer(const CommandLineArgumentBuffer&) = delete;
+  CommandLineArgumentBuffer(CommandLineArgumentBuffer&&) = default;
+  CommandLineArgumentBuffer& operator=(const CommandLineArgumentBuffer&) = delete;
+  CommandLineArgumentBuffer& operator=(CommandLineArgumentBuffer&&) = default;
+
+  /** Sets argv[0]. */
+  void setExecutable(const std::string&);
+  /** Appends the parameters of a parser or action, in definition order. */
+  void addProvider(const CommandLineParameterProvider*, bool includeRemainder = true);
+  /** Extra arguments, such as unrecognized ones, appended after all parameters. */
+  void setPassthroughArgs(const std::vector<std::string>&);
+  void setFilter(const ParameterFilter&);
+  /** When true, only parameters that were given on the command line are rendered. */
+  void setExplicitOnly(bool);
+  /** When true (the default), envp starts from the environment of this process as of the last rebuild. */
+  void setInheritEnvironment(bool);
+  void setEnvironmentVariable(const std::string& name, const std::string& value);
+  /** Forces the next access to rebuild, e.g. after writing a bound field or calling setenv(). */
+  void invalidate();
+
+  size_t argc();
+  char* const* argv();
+  char* const* envp();
+};
+
+}
+
+#endif
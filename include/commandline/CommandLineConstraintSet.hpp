@@ -0,0 +1,68 @@
+#ifndef __COMMAND_LINE_CONSTRAINT_SET_HPP__
+#define __COMMAND_LINE_CONSTRAINT_SET_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "CommandLineParameter.hpp"
+
+namespace commandline {
+
+enum class CommandLineConstraintKind {
+  Required,
+  MutuallyExclusive,
+  Requires,
+  AtLeastOneOf,
+  RequiredWhen
+};
+
+struct CommandLineConstraintViolation {
+  CommandLineConstraintKind kind;
+  /** The parameter that triggered a Requires or RequiredWhen rule. */
+  size_t trigger;
+  /** The offending parameters: the missing ones, or the conflicting ones. */
+  std::vector<size_t> ids;
+};
+
+/**
+ * Cross-parameter rules of a parameter provider. Parameters are addressed by
+ * their dense id (definition order). Rules are compiled into bit masks and
+ * checked against the bitset of parameters given on the command line, so each
+ * rule costs a few word operations regardless of how many parameters it names.
+ */
+class CommandLineConstraintSet {
+ private:
+  struct Rule {
+    CommandLineConstraintKind kind;
+    std::vector<size_t> ids;
+    size_t trigger;
+    size_t alternative;
+  };
+
+  std::vector<Rule> _rules;
+  size_t _parameterCount;
+  size_t _words;
+  bool _compiled;
+  std::vector<uint64_t> _masks;
+  std::vector<uint64_t> _required;
+  std::vector<uint64_t> _given;
+
+  void _compile(const std::vector<CommandLineParameter*>&);
+  void _addRule(CommandLineConstraintKind, const std::vector<size_t>&, size_t trigger, size_t alternative);
+ public:
+  CommandLineConstraintSet();
+
+  void addMutuallyExclusive(const std::vector<size_t>& ids);
+  void addRequires(size_t trigger, const std::vector<size_t>& ids);
+  void addAtLeastOneOf(const std::vector<size_t>& ids);
+  /** The ids are required when the choice parameter trigger has the given alternative index. */
+  void addRequiredWhen(size_t trigger, size_t alternative, const std::vector<size_t>& ids);
+
+  size_t size() const;
+  /** Appends every violated rule, starting with missing required parameters. */
+  void validate(const std::vector<CommandLineParameter*>&, std::vector<CommandLineConstraintViolation>&);
+};
+
+}
+
+#endif
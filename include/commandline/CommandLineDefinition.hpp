@@ -4,12 +4,15 @@
 #include <string>
 #include <vector>
 #include <cstdint>
+#include <chrono>
+#include <limits>
+#include "CommandLineText.hpp"
 
 namespace commandline {
   struct BaseCommandLineDefinition {
     std::string parameterLongName = "";
     std::string parameterShortName = "";
-    std::string description = "";
+    CommandLineText description;
     bool required = false;
     std::string environmentVariable = "";
   };
@@ -31,27 +34,92 @@ namespace commandline {
     int64_t defaultValue = 0;
   };
 
+  struct CommandLineDoubleDefinition : BaseCommandLineDefinitionWithArgument {
+    double defaultValue = 0;
+    double minimum = -std::numeric_limits<double>::infinity();
+    double maximum = std::numeric_limits<double>::infinity();
+  };
+
+  struct CommandLineUnsignedDefinition : BaseCommandLineDefinitionWithArgument {
+    uint64_t defaultValue = 0;
+    uint64_t minimum = 0;
+    uint64_t maximum = UINT64_MAX;
+  };
+
+  /**
+   * Accepts a number of bytes with an optional SI (kB, MB, ...) or IEC (KiB,
+   * MiB, ...) suffix. A fraction has to come to whole bytes, e.g. "1.5KiB".
+   */
+  struct CommandLineByteSizeDefinition : BaseCommandLineDefinitionWithArgument {
+    uint64_t defaultValue = 0;
+    uint64_t minimum = 0;
+    uint64_t maximum = UINT64_MAX;
+  };
+
+  /** Accepts durations such as "1500ms", "1.5s" or "1h30m". */
+  struct CommandLineDurationDefinition : BaseCommandLineDefinitionWithArgument {
+    std::chrono::nanoseconds defaultValue = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds minimum = std::chrono::nanoseconds::zero();
+    std::chrono::nanoseconds maximum = std::chrono::nanoseconds::max();
+  };
+
   struct CommandLineStringDefinition : BaseCommandLineDefinitionWithArgument {
     std::string defaultValue = "";
+    /**
+     * A regular expression the value must match, e.g. "^[a-z0-9-]{1,63}$".
+     * It is compiled when the parameter is defined and supports literals,
+     * ".", [classes], \d \w \s, groups, "|", * + ? and {n,m}. Without ^
+     * and $ it may match anywhere in the value.
+     */
+    std::string pattern = "";
   };
 
   struct CommandLineStringListDefinition : BaseCommandLineDefinitionWithArgument {
+    /** Every value must match it, see CommandLineStringDefinition::pattern. */
+    std::string pattern = "";
   };
 
   struct CommandLineRemainderDefinition {
     std::string argumentName = "...";
-    std::string description = "";
+    CommandLineText description;
   };
 
   struct CommandLineActionOptions {
     std::string actionName = "";
-    std::string summary = "";
-    std::string documentation = "";
+    CommandLineText summary;
+    CommandLineText documentation;
+    /** Deadline for CommandLineParser::executeAsync(), zero means none */
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero();
+  };
+
+  /** Hard limits on the input, applied by CommandLineParser in strict mode. */
+  struct CommandLineLimits {
+    size_t maxArguments = 1024;
+    size_t maxArgumentLength = 4096;
+    /** Values of one string list parameter, and arguments of the remainder */
+    size_t maxListValues = 256;
+    /** All arguments together */
+    size_t maxTotalBytes = 64 * 1024;
   };
 
   struct CommandLineParserOptions {
     std::string toolFilename = "";
-    std::string toolDescription = "";
+    CommandLineText toolDescription;
+    /** Accept a unique prefix of a long option name, e.g. "--verb" for "--verbose". */
+    bool allowAbbreviations = false;
+    /**
+     * For command lines from untrusted sources: input beyond limits is
+     * rejected before it is scanned, and string lists reserve their storage
+     * up front instead of growing with the input.
+     */
+    bool strict = false;
+    CommandLineLimits limits;
+    /**
+     * Adds the wall time, CPU time, peak memory growth and outcome of every
+     * execution to this file (see CommandLineTelemetry). Empty, the default,
+     * records nothing.
+     */
+    std::string telemetryPath = "";
   };
 
   typedef enum CommandLineParameterKind {
@@ -64,8 +132,23 @@ namespace commandline {
     /** Indicates a CommandLineStringParameter */
     String,
     /** Indicates a CommandLineStringListParameter */
-    StringList
+    StringList,
+    /** Indicates a CommandLineDoubleParameter */
+    Double,
+    /** Indicates a CommandLineUnsignedParameter */
+    Unsigned,
+    /** Indicates a CommandLineByteSizeParameter */
+    ByteSize,
+    /** Indicates a CommandLineDurationParameter */
+    Duration
   } CommandLineParameterKind;
+
+  /** Where the current value of a parameter came from. */
+  enum class CommandLineValueSource {
+    Default,
+    Environment,
+    CommandLine
+  };
 }
 
 #endif
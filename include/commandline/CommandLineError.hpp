@@ -3,6 +3,7 @@
 
 #include <string>
 #include <exception>
+#include <vector>
 
 namespace commandline {
   typedef enum CommandLineErrorCode {
@@ -21,17 +22,54 @@ namespace commandline {
     ACTION_UNKNOWN,
     ACTION_UNDEFINED,
     REMAINDER_DEFINED,
-    EXECUTE_AGAIN
+    EXECUTE_AGAIN,
+    PLUGIN_MANIFEST_INVALID,
+    PLUGIN_LOAD_FAILED,
+    SPEC_INVALID,
+    VALUE_OUT_OF_RANGE,
+    EXECUTION_CANCELLED,
+    EXECUTION_TIMEOUT,
+    SERVER_ERROR,
+    EDIT_INVALID,
+    RESULT_INVALID,
+    RESULT_ENCODING_FAILED,
+    PARAMETERS_MUTUALLY_EXCLUSIVE,
+    PARAMETER_DEPENDENCY_MISSING,
+    PARAMETER_GROUP_EMPTY,
+    TOO_MANY_ARGUMENTS,
+    ARGUMENT_TOO_LONG,
+    TOO_MANY_VALUES,
+    INPUT_TOO_LARGE,
+    RESOURCE_INVALID,
+    TELEMETRY_FAILED,
+    PATTERN_INVALID,
+    PARAMETER_NAME_CONFLICT,
+    PARAMETER_SET_ATTACHED
   } CommandLineErrorCode;
   class CommandLineError : public std::exception {
    private:
     CommandLineErrorCode _code;
     std::string _message;
+    size_t _position;
    public:
+    static const size_t noPosition = static_cast<size_t>(-1);
+
     virtual ~CommandLineError();
     CommandLineError(CommandLineErrorCode, const std::string&);
+    CommandLineError(CommandLineErrorCode, const std::string&, size_t position);
     const char* what() const noexcept;
     CommandLineErrorCode code() const;
+    /** Index of the offending argument passed to execute(), or noPosition. */
+    size_t position() const;
+  };
+
+  /** Carries every violated parameter constraint; code() is the code of the first one. */
+  class CommandLineConstraintError : public CommandLineError {
+   private:
+    std::vector<CommandLineError> _violations;
+   public:
+    CommandLineConstraintError(const std::vector<CommandLineError>&);
+    const std::vector<CommandLineError>& violations() const;
   };
 }
 
@@ -0,0 +1,92 @@
+#ifndef __COMMAND_LINE_EXECUTION_HPP__
+#define __COMMAND_LINE_EXECUTION_HPP__
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace commandline {
+
+  typedef enum CommandLineCancellationReason {
+    NotCancelled,
+    /** SIGINT or SIGTERM was received */
+    Signal,
+    /** The action timeout elapsed */
+    Deadline,
+    /** cancel() was called explicitly */
+    Requested
+  } CommandLineCancellationReason;
+
+class CommandLineCancellationToken {
+ private:
+  std::atomic<int> _reason;
+  mutable std::mutex _mutex;
+  mutable std::condition_variable _cv;
+ public:
+  CommandLineCancellationToken();
+
+  CommandLineCancellationToken(const CommandLineCancellationToken&) = delete;
+  CommandLineCancellationToken& operator=(const CommandLineCancellationToken&) = delete;
+
+  bool isCancellationRequested() const;
+  CommandLineCancellationReason reason() const;
+  /** Only the first call has an effect. */
+  void cancel(CommandLineCancellationReason = Requested);
+  /** Sleeps until cancellation or timeout, returns true if cancelled. */
+  bool waitFor(std::chrono::nanoseconds) const;
+  /** Throws a CommandLineError with EXECUTION_CANCELLED or EXECUTION_TIMEOUT. */
+  void throwIfCancellationRequested() const;
+};
+
+class CommandLineExecutor {
+ public:
+  virtual ~CommandLineExecutor();
+  /** Schedules a task; may be called from any thread. */
+  virtual void post(std::function<void()>) = 0;
+};
+
+/**
+ * Single-threaded executor: posted tasks run on the thread that drives the
+ * loop, which is the thread that called CommandLineParser::executeAsync().
+ */
+class CommandLineEventLoop : public CommandLineExecutor {
+ private:
+  std::mutex _mutex;
+  std::condition_variable _cv;
+  std::deque<std::function<void()>> _tasks;
+ public:
+  CommandLineEventLoop();
+  ~CommandLineEventLoop();
+
+  void post(std::function<void()>);
+  /** Runs at most one task, waiting up to the timeout for one. Returns true if a task ran. */
+  bool runOne(std::chrono::nanoseconds);
+  /** Runs tasks until the queue is empty. */
+  void drain();
+};
+
+class CommandLineExecutionContext {
+ private:
+  const CommandLineCancellationToken& _token;
+  CommandLineExecutor& _executor;
+ public:
+  CommandLineExecutionContext(const CommandLineCancellationToken&, CommandLineExecutor&);
+
+  const CommandLineCancellationToken& token() const;
+  CommandLineExecutor& executor() const;
+};
+
+  struct CommandLineAsyncOptions {
+    /** Overrides the timeout of the selected action if not zero */
+    std::chrono::milliseconds timeout = std::chrono::milliseconds::zero();
+    /** Cancel the action on SIGINT and SIGTERM */
+    bool handleSignals = true;
+    /** Runs continuations posted by the action; the built-in event loop is used if null */
+    CommandLineExecutor* executor = nullptr;
+  };
+}
+
+#endif
@@ -0,0 +1,121 @@
+#ifndef __COMMAND_LINE_INCREMENTAL_PARSER_HPP__
+#define __COMMAND_LINE_INCREMENTAL_PARSER_HPP__
+
+#include <unordered_map>
+#include "CommandLineParser.hpp"
+#include "CommandLineError.hpp"
+
+namespace commandline {
+
+enum class CommandLineTokenKind {
+  Action,
+  Option,
+  Value,
+  Help,
+  Remainder,
+  /** Not consumed by the parser; execute() stops processing at such a token. */
+  Ignored
+};
+
+struct CommandLineToken {
+  std::string text;
+  CommandLineTokenKind kind;
+  /** The action whose parameters the token was matched against, nullptr for global ones. */
+  const CommandLineAction* action;
+  /** The parameter named by an Option token, or receiving a Value token. */
+  const CommandLineParameter* parameter;
+  /** Offset of an inline value ("--name=value", "-nvalue"), 0 if there is none. */
+  size_t valueOffset;
+  CommandLineErrorCode errorCode;
+  /** Empty when the token is valid. */
+  std::string errorMessage;
+};
+
+/** Replaces removeCount tokens starting at position with the inserted ones. */
+struct CommandLineEdit {
+  size_t position;
+  size_t removeCount;
+  std::vector<std::string> inserted;
+};
+
+struct CommandLineDiagnostic {
+  /** npos for problems that are not tied to a token, such as a missing required parameter. */
+  size_t tokenIndex;
+  CommandLineErrorCode code;
+  std::string message;
+};
+
+enum class CommandLineCompletionKind {
+  ActionName,
+  ParameterName,
+  ParameterValue,
+  Remainder,
+  None
+};
+
+struct CommandLineCompletionContext {
+  CommandLineCompletionKind kind;
+  const CommandLineAction* action;
+  /** The parameter expecting a value, for ParameterValue completions. */
+  const CommandLineParameter* parameter;
+  std::vector<std::string> candidates;
+};
+
+/** The tokens that were classified again by an edit. */
+struct CommandLineReparseRange {
+  size_t first;
+  size_t count;
+};
+
+/**
+ * Classifies a token list against the action and parameter tables of a parser
+ * without executing it, for live validation and completion while a command
+ * line is being edited. After an edit only the edited tokens and those whose
+ * classification depends on them are classified again, so the cost follows the
+ * size of the edit rather than the length of the line.
+ * The parser's definitions must not change while this object is in use.
+ */
+class CommandLineIncrementalParser {
+ private:
+  enum class _Phase : uint8_t { Options, Remainder, Stopped };
+  struct _State {
+    const CommandLineAction* action;
+    const CommandLineParameter* pending;
+    _Phase phase;
+
+    bool operator==(const _State&) const;
+    bool operator!=(const _State&) const;
+  };
+  const CommandLineParser* _parser;
+  std::unordered_map<std::string, const CommandLineAction*> _actionsByName;
+
+  std::vector<CommandLineToken> _tokens;
+  /** _states[i] is the state before _tokens[i]; the last entry is the final state. */
+  std::vector<_State> _states;
+  std::unordered_map<const CommandLineParameter*, int> _occurrences;
+
+  const CommandLineParameter* _lookup(const CommandLineAction*, const std::string&) const;
+  bool _acceptsValue(const CommandLineParameter*, size_t tokenIndex) const;
+  _State _classify(const _State&, size_t tokenIndex, CommandLineToken&) const;
+  void _count(const CommandLineToken&, int delta);
+ public:
+  CommandLineIncrementalParser(const CommandLineParser&);
+
+  CommandLineIncrementalParser(const CommandLineIncrementalParser&) = delete;
+  CommandLineIncrementalParser& operator=(const CommandLineIncrementalParser&) = delete;
+
+  /** Classifies a whole token list (the arguments after the program name). */
+  void reset(const std::vector<std::string>&);
+  CommandLineReparseRange apply(const CommandLineEdit&);
+
+  const std::vector<CommandLineToken>& tokens() const;
+  /** The action selected by the current tokens, nullptr if there is none. */
+  const CommandLineAction* selectedAction() const;
+  std::vector<CommandLineDiagnostic> diagnostics() const;
+  /** What may be typed at tokenIndex; tokens()[tokenIndex] (if any) is used as the prefix. */
+  CommandLineCompletionContext completion(size_t tokenIndex) const;
+};
+
+}
+
+#endif
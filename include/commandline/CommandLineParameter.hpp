@@ -1,20 +1,66 @@
 #ifndef __COMMAND_LINE_PARAMETER_HPP__
 #define __COMMAND_LINE_PARAMETER_HPP__
 
+#include <functional>
+#include <memory>
 #include <regex>
+#include <unordered_map>
 #include "CommandLineDefinition.hpp"
 
 namespace commandline {
+  namespace dfa {
+    class Pattern;
+  }
+
+  /**
+   * Where a parameter keeps its value: in the parameter itself, or in a field
+   * of the application after bind(), so the parser writes it there directly.
+   */
+  template <typename T>
+  class CommandLineValueSlot {
+   private:
+    T _own;
+    T* _target;
+
+   public:
+    CommandLineValueSlot(): _own(), _target(nullptr) {}
+    CommandLineValueSlot(const T& value): _own(value), _target(nullptr) {}
+
+    T& get() {
+      return this->_target != nullptr ? *this->_target : this->_own;
+    }
+    const T& get() const {
+      return this->_target != nullptr ? *this->_target : this->_own;
+    }
+    void bind(T& target) {
+      this->_target = &target;
+    }
+  };
+
   class CommandLineParameter {
    private:
     bool _hasValue;
+    mutable bool _resolved;
+    bool _converted;
+    std::function<void(const CommandLineParameter&)> _converter;
    protected:
+    // Set by the bind() overloads of the parameter kinds
+    bool _bound;
+
     // std::string _parserKey;
+    CommandLineValueSource _valueSource;
+
+    /**
+     * Applies the environment or default value on first access, unless the
+     * command line set one. Not synchronized: read a parameter once before
+     * sharing it between threads.
+     */
+    void _resolve() const;
 
    public:
     std::string longName;
     std::string shortName;
-    std::string description;
+    CommandLineText description;
     bool required;
     std::string environmentVariable;
 
@@ -34,6 +80,19 @@ namespace commandline {
 
     bool hasValue() const;
     void setHasValue();
+    /** Forgets the command line value; the next read resolves the environment or default value again. */
+    void _reset();
+    CommandLineValueSource valueSource() const;
+
+    /**
+     * Calls converter with this parameter once its final value is known, after
+     * every successful parse, e.g. to store a choice as an enum field.
+     */
+    void bindConverter(const std::function<void(const CommandLineParameter&)>& converter);
+    /** Whether the parser writes the value somewhere after parsing. */
+    bool isBound() const;
+    /** Resolves the value of a bound parameter and calls its converter. */
+    void _applyBinding();
 
     virtual void _getSupplementaryNotes(std::vector<std::string>&) const;
     virtual CommandLineParameterKind kind() const = 0;
@@ -64,7 +123,9 @@ namespace commandline {
 
   class CommandLineChoiceParameter : public CommandLineParameter {
    private:
-    std::string _value;
+    size_t _index;
+    size_t _defaultIndex;
+    std::unordered_map<std::string, size_t> _alternativeIndex;
 
    public:
     std::vector<std::string> alternatives;
@@ -86,12 +147,38 @@ namespace commandline {
 
     std::string formatAlternatives() const;
 
+    /** Returns the position of the alternative in the list, or -1. */
+    int indexOf(const std::string&) const;
+
     const std::string& value() const;
+    /** The position of value() in alternatives. */
+    size_t index() const;
+  };
+
+  /**
+   * Typed view of a choice parameter whose alternatives are listed in the
+   * order of the enumerators of E, starting at 0.
+   */
+  template <typename E>
+  class CommandLineEnumChoiceParameter {
+   private:
+    const CommandLineChoiceParameter* _parameter;
+
+   public:
+    explicit CommandLineEnumChoiceParameter(const CommandLineChoiceParameter* parameter): _parameter(parameter) {}
+
+    const CommandLineChoiceParameter* parameter() const {
+      return this->_parameter;
+    }
+
+    E value() const {
+      return static_cast<E>(this->_parameter->index());
+    }
   };
 
   class CommandLineFlagParameter : public CommandLineParameter {
    private:
-    bool _value;
+    CommandLineValueSlot<bool> _value;
 
    public:
     bool defaultValue;
@@ -109,12 +196,14 @@ namespace commandline {
 
     void appendToArgList(std::vector<std::string>&) const;
 
+    void bind(bool& target);
+
     bool value() const;
   };
 
   class CommandLineIntegerParameter : public CommandLineParameterWithArgument {
    private:
-    int64_t _value;
+    CommandLineValueSlot<int64_t> _value;
 
    public:
     int64_t defaultValue;
@@ -133,15 +222,131 @@ namespace commandline {
 
     void appendToArgList(std::vector<std::string>&) const;
 
+    void bind(int64_t& target);
+
     int64_t value() const;
   };
 
+  class CommandLineDoubleParameter : public CommandLineParameterWithArgument {
+   private:
+    CommandLineValueSlot<double> _value;
+
+   public:
+    double defaultValue;
+    double minimum;
+    double maximum;
+
+    CommandLineDoubleParameter(const CommandLineDoubleDefinition&);
+
+    CommandLineParameterKind kind() const;
+
+    void _setValue();
+    void _setValue(bool);
+    void _setValue(int64_t);
+    void _setValue(const std::string&);
+    void _setValue(const std::vector<std::string>&);
+
+    void _getSupplementaryNotes(std::vector<std::string>&) const;
+
+    void appendToArgList(std::vector<std::string>&) const;
+
+    void bind(double& target);
+
+    double value() const;
+  };
+
+  class CommandLineUnsignedParameter : public CommandLineParameterWithArgument {
+   private:
+    CommandLineValueSlot<uint64_t> _value;
+
+   public:
+    uint64_t defaultValue;
+    uint64_t minimum;
+    uint64_t maximum;
+
+    CommandLineUnsignedParameter(const CommandLineUnsignedDefinition&);
+
+    CommandLineParameterKind kind() const;
+
+    void _setValue();
+    void _setValue(bool);
+    void _setValue(int64_t);
+    void _setValue(const std::string&);
+    void _setValue(const std::vector<std::string>&);
+
+    void _getSupplementaryNotes(std::vector<std::string>&) const;
+
+    void appendToArgList(std::vector<std::string>&) const;
+
+    void bind(uint64_t& target);
+
+    uint64_t value() const;
+  };
+
+  class CommandLineByteSizeParameter : public CommandLineParameterWithArgument {
+   private:
+    CommandLineValueSlot<uint64_t> _value;
+
+   public:
+    uint64_t defaultValue;
+    uint64_t minimum;
+    uint64_t maximum;
+
+    CommandLineByteSizeParameter(const CommandLineByteSizeDefinition&);
+
+    CommandLineParameterKind kind() const;
+
+    void _setValue();
+    void _setValue(bool);
+    void _setValue(int64_t);
+    void _setValue(const std::string&);
+    void _setValue(const std::vector<std::string>&);
+
+    void _getSupplementaryNotes(std::vector<std::string>&) const;
+
+    void appendToArgList(std::vector<std::string>&) const;
+
+    void bind(uint64_t& target);
+
+    uint64_t value() const;
+  };
+
+  class CommandLineDurationParameter : public CommandLineParameterWithArgument {
+   private:
+    CommandLineValueSlot<std::chrono::nanoseconds> _value;
+
+   public:
+    std::chrono::nanoseconds defaultValue;
+    std::chrono::nanoseconds minimum;
+    std::chrono::nanoseconds maximum;
+
+    CommandLineDurationParameter(const CommandLineDurationDefinition&);
+
+    CommandLineParameterKind kind() const;
+
+    void _setValue();
+    void _setValue(bool);
+    void _setValue(int64_t);
+    void _setValue(const std::string&);
+    void _setValue(const std::vector<std::string>&);
+
+    void _getSupplementaryNotes(std::vector<std::string>&) const;
+
+    void appendToArgList(std::vector<std::string>&) const;
+
+    void bind(std::chrono::nanoseconds& target);
+
+    std::chrono::nanoseconds value() const;
+  };
+
   class CommandLineStringParameter : public CommandLineParameterWithArgument {
    private:
-    std::string _value;
+    CommandLineValueSlot<std::string> _value;
+    std::shared_ptr<const dfa::Pattern> _pattern;
 
    public:
     std::string defaultValue;
+    std::string pattern;
 
     CommandLineStringParameter(const CommandLineStringDefinition&);
 
@@ -157,14 +362,23 @@ namespace commandline {
 
     void appendToArgList(std::vector<std::string>&) const;
 
+    void bind(std::string& target);
+
     const std::string& value() const;
+    /** Whether value matches the pattern; true without one. Linear in the length of value. */
+    bool matchesPattern(const std::string& value) const;
   };
 
   class CommandLineStringListParameter : public CommandLineParameterWithArgument {
    private:
-    std::vector<std::string> _values;
+    CommandLineValueSlot<std::vector<std::string>> _values;
+    size_t _maxValues;
+    std::shared_ptr<const dfa::Pattern> _pattern;
+
+    void _checkPattern(const std::string&) const;
 
    public:
+    std::string pattern;
 
     CommandLineStringListParameter(const CommandLineStringListDefinition&);
 
@@ -176,9 +390,17 @@ namespace commandline {
     void _setValue(const std::string&);
     void _setValue(const std::vector<std::string>&);
 
+    void _getSupplementaryNotes(std::vector<std::string>&) const;
+
     void appendToArgList(std::vector<std::string>&) const;
 
+    void bind(std::vector<std::string>& target);
+
     const std::vector<std::string>& values() const;
+    bool matchesPattern(const std::string& value) const;
+
+    /** Rejects more than maxValues values with TOO_MANY_VALUES and reserves room for them. */
+    void _limitValues(size_t maxValues);
   };
 }
 
@@ -2,23 +2,53 @@
 #define __COMMAND_LINE_PARAMETER_PROVIDER_HPP__
 
 #include <map>
+#include <memory>
+#include <unordered_map>
 #include "CommandLineParameter.hpp"
 #include "CommandLineRemainder.hpp"
+#include "CommandLineConstraintSet.hpp"
 
 namespace commandline {
 
+namespace token {
+  struct Classification;
+}
+
+class CommandLineParameterSet;
+
 class CommandLineParameterProvider {
  private:
   std::vector<CommandLineParameter*> _parameters;
   std::map<std::string, CommandLineParameter*> _parametersByLongName;
   std::map<std::string, CommandLineParameter*> _parametersByShortName;
+  std::vector<std::shared_ptr<CommandLineParameterSet>> _parameterSets;
+  // Set on a parameter set once it is attached; its parameters are fixed from then on
+  bool _attached;
+  // Every name the scanner accepts in this scope, the outer scope's included,
+  // built once and rebuilt only when parameters were defined since
+  mutable std::unordered_map<std::string, CommandLineParameter*> _scope;
+  // The same names in definition order, for suggestions
+  mutable std::vector<std::string> _scopeNames;
+  // Sorted long names when abbreviations are allowed, otherwise empty
+  mutable std::vector<std::string> _scopeLongNames;
+  mutable const CommandLineParameterProvider* _scopeOuter;
+  mutable size_t _scopeSize;
 
+  bool _ownsParameter(const CommandLineParameter*) const;
   CommandLineParameter* _getParameter(const std::string&) const;
+  void _checkNames(const CommandLineParameter*, const CommandLineParameterProvider*) const;
   const CommandLineParameter* _getParameter(const std::string&, CommandLineParameterKind) const;
-  CommandLineParameter* _tryGetParameter(const std::string&) const;
   void _defineParameter(CommandLineParameter*);
+  size_t _idOf(const std::string&) const;
+  std::vector<size_t> _idsOf(const std::vector<std::string>&) const;
+  void _validateConstraints();
+  uint64_t _revision;
+  CommandLineConstraintSet _constraints;
  protected:
   CommandLineRemainder* _remainder;
+  /** Accept unique prefixes of long names, "--verb" for "--verbose". Actions follow the parser. */
+  bool _allowAbbreviations;
+  CommandLineParameter* _tryGetParameter(const std::string&) const;
   static std::string _defaultValueToString(const CommandLineParameter*);
   static std::string _kindToString(CommandLineParameterKind);
   static std::string _kindToString(const CommandLineParameter*);
@@ -29,6 +59,29 @@ class CommandLineParameterProvider {
 
   const std::vector<CommandLineParameter*>& parameters() const;
   const CommandLineRemainder* remainder() const;
+  /** Incremented every time arguments are processed by this provider. */
+  uint64_t revision() const;
+
+  /**
+   * The steps of _processArgs(), used by CommandLineParser to scan the global
+   * and the action arguments in one pass over argv. The options of the outer
+   * scope are accepted too, unless this scope defines the same name, and
+   * parameters that the outer scope also has keep the values it gave them.
+   */
+  void _beginArgs(const CommandLineParameterProvider* outer = nullptr);
+  /** Applies the options of args from begin on; returns the first index that is not one of them. */
+  size_t _scanArgs(const std::vector<std::string>& args, const token::Classification&, size_t begin, bool& help);
+  /** Assigns args from remainderBegin on to the remainder, validates the constraints and writes bound values. */
+  void _endArgs(const std::vector<std::string>& args, size_t remainderBegin);
+
+  /**
+   * Builds the table of names accepted in this scope, with those of outer,
+   * unless it is up to date. _beginArgs() does this too; the incremental
+   * parser calls it so that both accept the same names.
+   */
+  void _freezeScope(const CommandLineParameterProvider* outer) const;
+  /** Looks a name or an allowed abbreviation up in the table of _freezeScope(). */
+  CommandLineParameter* _lookupInScope(const std::string&) const;
 
   CommandLineParameterProvider(const CommandLineParameterProvider&) = delete;
   CommandLineParameterProvider(CommandLineParameterProvider&&) = default;
@@ -43,6 +96,18 @@ class CommandLineParameterProvider {
   CommandLineIntegerParameter* defineIntegerParameter(const CommandLineIntegerDefinition&);
   const CommandLineIntegerParameter* getIntegerParameter(const std::string&) const;
 
+  CommandLineDoubleParameter* defineDoubleParameter(const CommandLineDoubleDefinition&);
+  const CommandLineDoubleParameter* getDoubleParameter(const std::string&) const;
+
+  CommandLineUnsignedParameter* defineUnsignedParameter(const CommandLineUnsignedDefinition&);
+  const CommandLineUnsignedParameter* getUnsignedParameter(const std::string&) const;
+
+  CommandLineByteSizeParameter* defineByteSizeParameter(const CommandLineByteSizeDefinition&);
+  const CommandLineByteSizeParameter* getByteSizeParameter(const std::string&) const;
+
+  CommandLineDurationParameter* defineDurationParameter(const CommandLineDurationDefinition&);
+  const CommandLineDurationParameter* getDurationParameter(const std::string&) const;
+
   CommandLineStringParameter* defineStringParameter(const CommandLineStringDefinition&);
   const CommandLineStringParameter* getStringParameter(const std::string&) const;
 
@@ -51,6 +116,22 @@ class CommandLineParameterProvider {
 
   const CommandLineRemainder* defineCommandLineRemainder(const CommandLineRemainderDefinition&);
 
+  /**
+   * Makes the parameters of the set available in this scope, after the ones
+   * defined here. The set takes no further parameters once attached, and
+   * none of its names may be in use in this scope; both throw.
+   */
+  void attachParameterSet(const std::shared_ptr<CommandLineParameterSet>&);
+
+  /** At most one of the parameters may be given. */
+  void defineMutuallyExclusive(const std::vector<std::string>& parameterNames);
+  /** When parameterName is given, all of requiredNames must be given too. */
+  void defineRequires(const std::string& parameterName, const std::vector<std::string>& requiredNames);
+  /** At least one of the parameters must be given. */
+  void defineAtLeastOneOf(const std::vector<std::string>& parameterNames);
+  /** When the choice parameter has the given value, all of requiredNames must be given. */
+  void defineRequiredWhen(const std::string& choiceName, const std::string& alternative, const std::vector<std::string>& requiredNames);
+
   // virtual std::string renderHelpText() const = 0;
 
   // virtual void onDefineParameters() = 0;
@@ -0,0 +1,25 @@
+#ifndef __COMMAND_LINE_PARAMETER_SET_HPP__
+#define __COMMAND_LINE_PARAMETER_SET_HPP__
+
+#include "CommandLineParameterProvider.hpp"
+
+namespace commandline {
+
+/**
+ * Parameters defined once and attached to any number of actions and to the
+ * parser with CommandLineParameterProvider::attachParameterSet(). The
+ * definitions and their lookup tables are shared; the values are those of
+ * the current invocation, which only ever selects one action.
+ */
+class CommandLineParameterSet : public CommandLineParameterProvider {
+ public:
+  CommandLineParameterSet();
+  virtual ~CommandLineParameterSet();
+
+  CommandLineParameterSet(const CommandLineParameterSet&) = delete;
+  CommandLineParameterSet& operator=(const CommandLineParameterSet&) = delete;
+};
+
+}
+
+#endif
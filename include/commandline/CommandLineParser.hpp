@@ -2,27 +2,48 @@
 #define __COMMAND_LINE_PARSER_HPP__
 
 #include "CommandLineAction.hpp"
+#include "CommandLineActionRegistry.hpp"
 #include "CommandLineParameterProvider.hpp"
 #include "CommandLineDefinition.hpp"
+#include "CommandLinePrerenderedHelp.hpp"
 
 namespace commandline {
 
+namespace help {
+  class Index;
+}
+
 class CommandLineParser : public CommandLineParameterProvider {
  private:
-  CommandLineParserOptions _options;
   std::vector<CommandLineAction*> _actions;
   std::map<std::string, CommandLineAction*> _actionsByName;
   bool _executed;
+  // Built by the first search, dropped when an action is added
+  mutable std::shared_ptr<help::Index> _helpIndex;
+  // The registered actions not constructed yet when the index was built;
+  // their documents follow those of _actions
+  mutable std::vector<const CommandLineActionDescriptor*> _helpIndexDescriptors;
+  const CommandLinePrerenderedHelp* _prerenderedHelp;
+  CommandLineActionRegistry _registry;
 
   void _validateDefinitions() const;
+  void _checkLimits(const std::vector<std::string>&) const;
+  const help::Index& _getHelpIndex() const;
+  void _printHelp(const CommandLineAction*) const;
+  void _checkRemainderLimit(const CommandLineParameterProvider*, size_t remainderBegin, size_t length) const;
+  bool _parse(const std::vector<std::string>&);
+  void _runAsync(const CommandLineAsyncOptions&);
+  void _runRecorded(const std::function<void()>& run);
  protected:
+  CommandLineParserOptions _options;
   virtual std::string _getName() const;
   virtual std::string _getDescription() const;
   virtual void onExecute();
+  virtual std::future<void> onExecuteAsync(CommandLineExecutionContext&);
   void _init(const CommandLineParserOptions&);
  public:
   std::string toolFilename;
-  std::string toolDescription;
+  CommandLineText toolDescription;
   CommandLineAction* selectedAction;
 
   CommandLineParser();
@@ -37,14 +58,49 @@ class CommandLineParser : public CommandLineParameterProvider {
   const std::vector<CommandLineAction*>& actions() const;
 
   void addAction(CommandLineAction*);
+  /**
+   * Offers the actions registered with COMMANDLINE_REGISTER_ACTION() in the
+   * calling module. They are listed in the help from their descriptors, and
+   * constructed and added by tryGetAction() when selected.
+   */
+  void addRegisteredActions(const CommandLineActionRegistry& registry = registeredActions());
   CommandLineAction* getAction(const std::string& actionName);
   CommandLineAction* tryGetAction(const std::string& actionName);
 
+  /**
+   * Actions whose name, summary, documentation or parameter descriptions
+   * contain every word of terms, or words starting with them, best match
+   * first. Plugin actions are searched without loading them. Registered
+   * actions that are not constructed yet are matched by name and summary;
+   * there is no action to return for them, so only renderSearchResults()
+   * lists them. That is what "tool help --search <terms>" prints, unless the
+   * tool has a "help" action.
+   */
+  std::vector<const CommandLineAction*> searchActions(const std::string& terms, size_t limit = 20) const;
+  std::string renderSearchResults(const std::string& terms) const;
+
   void execute(int argc, char** argv);
   void execute(int argc, wchar_t** argv);
   void execute(const std::vector<std::string>&);
 
+  /**
+   * Like execute(), but runs the selected action through onExecuteAsync().
+   * Continuations posted to the context executor run on the calling thread.
+   * SIGINT/SIGTERM and the action timeout cancel the context token; once the
+   * action has stopped a CommandLineError with EXECUTION_CANCELLED or
+   * EXECUTION_TIMEOUT is thrown. A deferred future is run on the calling
+   * thread right away; it only sees a cancellation that happened before.
+   */
+  void executeAsync(int argc, char** argv, const CommandLineAsyncOptions& options = CommandLineAsyncOptions());
+  void executeAsync(const std::vector<std::string>&, const CommandLineAsyncOptions& options = CommandLineAsyncOptions());
+
   virtual std::string renderHelpText() const;
+
+  /**
+   * Writes help from build time instead of rendering it. The text has to
+   * come from the same schema; actions it does not list are rendered.
+   */
+  void usePrerenderedHelp(const CommandLinePrerenderedHelp*);
 };
 
 }
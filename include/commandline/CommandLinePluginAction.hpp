@@ -0,0 +1,52 @@
+#ifndef __COMMAND_LINE_PLUGIN_ACTION_HPP__
+#define __COMMAND_LINE_PLUGIN_ACTION_HPP__
+
+#include "DynamicCommandLineAction.hpp"
+
+#ifdef _WIN32
+#define COMMANDLINE_PLUGIN_EXPORT extern "C" __declspec(dllexport)
+#else
+#define COMMANDLINE_PLUGIN_EXPORT extern "C" __attribute__((visibility("default")))
+#endif
+
+namespace commandline {
+
+  /** Filled in by the entry symbol of a plugin shared library. */
+  struct CommandLinePluginDefinition {
+    DynamicCommandLineAction::DefineParametersCallback onDefineParameters = nullptr;
+    DynamicCommandLineAction::ExecuteCallback onExecute = nullptr;
+    const char* documentation = nullptr;
+  };
+
+  typedef void (*CommandLinePluginEntry)(CommandLinePluginDefinition*);
+
+  struct CommandLinePluginManifestEntry {
+    std::string actionName = "";
+    std::string summary = "";
+    std::string libraryPath = "";
+    std::string entrySymbol = "";
+  };
+
+/**
+ * An action whose parameters and behavior live in a shared library which is
+ * only loaded once the action has been selected on the command line.
+ * Loaded libraries are never unloaded because the parameters they define
+ * reference code inside them.
+ */
+class CommandLinePluginAction : public DynamicCommandLineAction {
+ private:
+  std::string _libraryPath;
+  std::string _entrySymbol;
+  bool _loaded;
+ public:
+  CommandLinePluginAction(const CommandLinePluginManifestEntry&);
+
+  const std::string& libraryPath() const;
+  bool loaded() const;
+
+  void _activate();
+};
+
+}
+
+#endif
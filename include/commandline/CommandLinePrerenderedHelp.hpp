@@ -0,0 +1,41 @@
+#ifndef __COMMAND_LINE_PRERENDERED_HELP_HPP__
+#define __COMMAND_LINE_PRERENDERED_HELP_HPP__
+
+#include <cstddef>
+#include <string>
+
+namespace commandline {
+
+class CommandLineParser;
+
+struct CommandLinePrerenderedAction {
+  const char* actionName;
+  /** The output of renderHelpText(), with the final line break */
+  const char* text;
+  size_t size;
+};
+
+/**
+ * Help text rendered at build time by commandline_prerender_help() (see
+ * cmake/prerender.cmake). Pass it to CommandLineParser::usePrerenderedHelp()
+ * and "-h" writes it out instead of rendering the schema.
+ */
+struct CommandLinePrerenderedHelp {
+  const char* text;
+  size_t size;
+  const CommandLinePrerenderedAction* actions;
+  size_t actionCount;
+};
+
+/** C++ source that defines a CommandLinePrerenderedHelp named symbol with the help of parser and of all its actions. */
+std::string renderPrerenderedHelpSource(const CommandLineParser& parser, const std::string& symbol);
+
+/**
+ * Defined by the schema sources given to commandline_prerender_help(): the
+ * tool's parser, with all its actions, for the generator to render.
+ */
+CommandLineParser* createPrerenderParser();
+
+}
+
+#endif
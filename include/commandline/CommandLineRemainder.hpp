@@ -11,16 +11,16 @@ class CommandLineRemainder {
 
  public:
   std::string argumentName;
-  std::string description;
+  CommandLineText description;
 
   CommandLineRemainder();
   CommandLineRemainder(const CommandLineRemainderDefinition& definition);
 
-  std::vector<std::string> values() const;
+  const std::vector<std::string>& values() const;
 
   void _setValue(const std::vector<std::string>& data);
 
-  void appendToArgList(std::vector<std::string>& argList);
+  void appendToArgList(std::vector<std::string>& argList) const;
 };
 
 }
@@ -0,0 +1,118 @@
+#ifndef __COMMAND_LINE_RESULT_HPP__
+#define __COMMAND_LINE_RESULT_HPP__
+
+#include "CommandLineParser.hpp"
+
+namespace commandline {
+
+/** A string inside an encoded result. data is NUL-terminated. */
+struct CommandLineTextView {
+  const char* data;
+  size_t size;
+
+  std::string str() const;
+  bool operator==(const std::string&) const;
+  bool operator!=(const std::string&) const;
+};
+
+class CommandLineTextListView {
+ private:
+  const char* _base;
+  const uint32_t* _refs;
+  size_t _size;
+ public:
+  CommandLineTextListView();
+  CommandLineTextListView(const char* base, const uint32_t* refs, size_t size);
+
+  size_t size() const;
+  CommandLineTextView operator[](size_t) const;
+  std::vector<std::string> str() const;
+};
+
+/**
+ * Encodes the effective values of a parsed CommandLineParser (its own
+ * parameters and those of the selected action) into a compact binary form
+ * that CommandLineResultView reads in place. The encoding uses the native
+ * byte order and is meant for processes on the same machine.
+ */
+class CommandLineResult {
+ public:
+  static const uint16_t version = 1;
+
+  /** The number of bytes encode() needs. */
+  static size_t encodedSize(const CommandLineParser&);
+  /** Encodes into buffer, which must be 8-byte aligned; returns the number of bytes written. */
+  static size_t encode(const CommandLineParser&, void* buffer, size_t capacity);
+  static std::vector<uint64_t> encode(const CommandLineParser&);
+  /**
+   * Encodes into a sealed, read-only memfd that workers can mmap().
+   * Only available on Linux.
+   */
+  static int encodeToMemfd(const CommandLineParser&);
+};
+
+class CommandLineResultView;
+
+/** The parameters of either the parser or the selected action, addressed by long name or id. */
+class CommandLineResultScope {
+ private:
+  const char* _base;
+  const void* _entries;
+  const uint32_t* _sorted;
+  size_t _count;
+
+  friend class CommandLineResultView;
+  CommandLineResultScope(const char* base, const void* entries, const uint32_t* sorted, size_t count);
+  const void* _entry(size_t id) const;
+  const void* _find(const std::string&, CommandLineParameterKind) const;
+ public:
+  CommandLineResultScope();
+
+  /** Parameter ids are the definition order of the parameters. */
+  size_t parameterCount() const;
+  /** Returns the id of a parameter, or -1 if it is not in the result. */
+  int idOf(const std::string& longName) const;
+  CommandLineTextView name(size_t id) const;
+  CommandLineParameterKind kind(size_t id) const;
+  CommandLineValueSource valueSource(size_t id) const;
+
+  CommandLineTextView getChoiceParameter(const std::string&) const;
+  size_t getChoiceIndex(const std::string&) const;
+  bool getFlagParameter(const std::string&) const;
+  int64_t getIntegerParameter(const std::string&) const;
+  double getDoubleParameter(const std::string&) const;
+  uint64_t getUnsignedParameter(const std::string&) const;
+  uint64_t getByteSizeParameter(const std::string&) const;
+  std::chrono::nanoseconds getDurationParameter(const std::string&) const;
+  CommandLineTextView getStringParameter(const std::string&) const;
+  CommandLineTextListView getStringListParameter(const std::string&) const;
+};
+
+/**
+ * Read-only access to a buffer written by CommandLineResult::encode(). The
+ * buffer is validated once on construction; accessors then read it in place
+ * and the buffer must outlive the view.
+ */
+class CommandLineResultView {
+ private:
+  const char* _base;
+  CommandLineResultScope _global;
+  CommandLineResultScope _action;
+  bool _hasAction;
+  CommandLineTextView _actionName;
+  CommandLineTextListView _remainder[2];
+ public:
+  CommandLineResultView(const void* data, size_t size);
+
+  const CommandLineResultScope& global() const;
+  bool hasAction() const;
+  CommandLineTextView actionName() const;
+  /** Throws if no action was selected. */
+  const CommandLineResultScope& action() const;
+  CommandLineTextListView remainder() const;
+  CommandLineTextListView actionRemainder() const;
+};
+
+}
+
+#endif
@@ -0,0 +1,56 @@
+#ifndef __COMMAND_LINE_SERVER_HPP__
+#define __COMMAND_LINE_SERVER_HPP__
+
+#include "CommandLineParser.hpp"
+
+namespace commandline {
+
+/**
+ * Keeps a fully built parser resident and executes it on behalf of clients
+ * connecting over a Unix domain socket. For every request the server forks;
+ * the child adopts the client's arguments, working directory, environment and
+ * stdio file descriptors, executes the parser and reports the exit code back.
+ * Concurrent clients are served by concurrent children, and each request sees
+ * a fresh copy of the parser. Only clients running as the user of the
+ * server are served. Only available on POSIX systems.
+ */
+class CommandLineServer {
+ private:
+  CommandLineParser* _parser;
+  std::string _socketPath;
+  int _listenFd;
+  int _stopPipe[2];
+  // Connection handlers not reaped yet
+  std::vector<int> _children;
+
+  void _handleConnection(int);
+ public:
+  CommandLineServer(CommandLineParser* parser, const std::string& socketPath);
+  ~CommandLineServer();
+
+  CommandLineServer(const CommandLineServer&) = delete;
+  CommandLineServer& operator=(const CommandLineServer&) = delete;
+
+  /**
+   * Binds and listens on the socket path, accessible to its owner only. A
+   * socket file nobody listens on anymore is replaced; throws SERVER_ERROR
+   * if another server is listening on it.
+   */
+  void listen();
+  /** Accepts clients until stop() is called. */
+  void serve();
+  /** Makes serve() return; safe to call from a signal handler. */
+  void stop();
+
+  /**
+   * Runs a command through the server listening on socketPath, with the given
+   * descriptors as the stdin, stdout and stderr of the command.
+   * Returns the exit code of the command (128 + signal number if it crashed).
+   */
+  static int forward(const std::string& socketPath, const std::vector<std::string>& args,
+    int stdinFd = 0, int stdoutFd = 1, int stderrFd = 2);
+};
+
+}
+
+#endif
@@ -0,0 +1,88 @@
+#ifndef __COMMAND_LINE_TELEMETRY_HPP__
+#define __COMMAND_LINE_TELEMETRY_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace commandline {
+
+/**
+ * A histogram with log-linear buckets: values below 16 are counted exactly,
+ * larger ones in eight buckets per power of two, so a percentile is at most
+ * 12.5% above the true value.
+ */
+struct CommandLineHistogram {
+  static const size_t bucketCount = 496;
+
+  uint64_t count;
+  uint64_t sum;
+  uint64_t max;
+  std::vector<uint64_t> buckets;
+
+  CommandLineHistogram();
+
+  static size_t bucketOf(uint64_t value);
+  /** The largest value counted in bucket. */
+  static uint64_t bucketLimit(size_t bucket);
+
+  void add(uint64_t value);
+  /** The value that p (0 to 1) of all values do not exceed; 0 for an empty histogram. */
+  uint64_t percentile(double p) const;
+};
+
+/** One execution of an action. */
+struct CommandLineExecutionSample {
+  uint64_t wallMicros;
+  uint64_t cpuMicros;
+  /** How far the action raised the peak resident set of the process */
+  uint64_t peakRssKiB;
+  bool failed;
+};
+
+struct CommandLineActionTelemetry {
+  std::string actionName;
+  uint64_t runs;
+  /** Executions that ended with an exception */
+  uint64_t failures;
+  CommandLineHistogram wallMicros;
+  CommandLineHistogram cpuMicros;
+  CommandLineHistogram peakRssKiB;
+};
+
+/**
+ * Execution statistics per action in a memory-mapped file that every run of
+ * a tool adds to; set CommandLineParserOptions::telemetryPath to record them.
+ * The file has a fixed size and layout, and samples are added with atomic
+ * operations on the mapping, so concurrent processes need no lock. A file
+ * has room for slotCount action names; samples of further actions are
+ * dropped.
+ */
+class CommandLineTelemetry {
+ private:
+  void* _data;
+
+ public:
+  static const size_t slotCount = 64;
+  /** The longest action name that is stored in full. */
+  static const size_t maxNameLength = 55;
+
+  /** Opens the file at path, creating it if needed; throws TELEMETRY_FAILED. */
+  explicit CommandLineTelemetry(const std::string& path);
+  ~CommandLineTelemetry();
+
+  CommandLineTelemetry(const CommandLineTelemetry&) = delete;
+  CommandLineTelemetry& operator=(const CommandLineTelemetry&) = delete;
+
+  void record(const std::string& actionName, const CommandLineExecutionSample&);
+
+  /** The statistics in the file at path, by action name. */
+  static std::vector<CommandLineActionTelemetry> read(const std::string& path);
+  /** Runs, failures and p50/p90/p99/max of every measurement, per action. */
+  static std::string renderReport(const std::vector<CommandLineActionTelemetry>&);
+};
+
+}
+
+#endif
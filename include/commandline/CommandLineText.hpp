@@ -0,0 +1,67 @@
+#ifndef __COMMAND_LINE_TEXT_HPP__
+#define __COMMAND_LINE_TEXT_HPP__
+
+#include <cstddef>
+#include <ostream>
+#include <string>
+
+namespace commandline {
+
+class CommandLineTextResource;
+
+/**
+ * Schema text such as descriptions and help. Text given as a std::string or
+ * a pointer is copied; text from a "..."_text literal or fromStatic() stays
+ * where it is, so a schema built from literals puts none of it on the heap.
+ * Text from a CommandLineTextResource stays compressed until it is read.
+ */
+class CommandLineText {
+ private:
+  const char* _static;
+  size_t _size;
+  std::string _owned;
+  const CommandLineTextResource* _resource;
+  size_t _offset;
+
+ public:
+  CommandLineText();
+  CommandLineText(const std::string&);
+  CommandLineText(const char*);
+
+  /** Refers to text that lives for the whole program, e.g. a string literal or a static array. */
+  static CommandLineText fromStatic(const char* text);
+  static CommandLineText fromStatic(const char* text, size_t size);
+  /** size bytes at offset of the decompressed resource, which has to outlive the text. */
+  static CommandLineText fromResource(const CommandLineTextResource& resource, size_t offset, size_t size);
+
+  const char* data() const;
+  size_t size() const;
+  bool empty() const;
+  /** Whether the text refers to static storage instead of an owned copy. */
+  bool isStatic() const;
+  /** Whether the text is part of a CommandLineTextResource. */
+  bool isCompressed() const;
+  std::string str() const;
+  operator std::string() const;
+};
+
+bool operator==(const CommandLineText&, const CommandLineText&);
+bool operator==(const CommandLineText&, const std::string&);
+bool operator==(const CommandLineText&, const char*);
+bool operator!=(const CommandLineText&, const CommandLineText&);
+bool operator!=(const CommandLineText&, const std::string&);
+bool operator!=(const CommandLineText&, const char*);
+std::string operator+(const std::string&, const CommandLineText&);
+std::string operator+(const CommandLineText&, const std::string&);
+std::ostream& operator<<(std::ostream&, const CommandLineText&);
+
+namespace literals {
+  /** "..."_text: schema text that is never copied. */
+  inline CommandLineText operator"" _text(const char* text, size_t size) {
+    return CommandLineText::fromStatic(text, size);
+  }
+}
+
+}
+
+#endif
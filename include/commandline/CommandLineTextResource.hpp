@@ -0,0 +1,59 @@
+#ifndef __COMMAND_LINE_TEXT_RESOURCE_HPP__
+#define __COMMAND_LINE_TEXT_RESOURCE_HPP__
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CommandLineText.hpp"
+
+namespace commandline {
+
+/**
+ * Help text that stays compressed until it is read. pack() turns a list of
+ * texts into a blob, e.g. at build time into a static array; text(i) then
+ * refers to the i-th text without decompressing anything. The first read of
+ * any of them decompresses the whole blob once, so a run that never renders
+ * help keeps only the blob and its index in memory.
+ */
+class CommandLineTextResource {
+ private:
+  std::string _ownedBlob;
+  const unsigned char* _blob;
+  size_t _blobSize;
+  uint32_t _count;
+  uint32_t _textSize;
+
+  mutable std::once_flag _once;
+  mutable std::atomic<bool> _loaded;
+  mutable std::string _text;
+
+  void _readHeader();
+  uint32_t _end(size_t index) const;
+
+ public:
+  /** A blob from pack() in static storage; it is not copied. */
+  CommandLineTextResource(const unsigned char* blob, size_t size);
+  explicit CommandLineTextResource(const std::string& blob);
+
+  CommandLineTextResource(const CommandLineTextResource&) = delete;
+  CommandLineTextResource& operator=(const CommandLineTextResource&) = delete;
+
+  static std::string pack(const std::vector<std::string>& texts);
+
+  size_t size() const;
+  /** The index-th text of the blob. The resource has to outlive it. */
+  CommandLineText text(size_t index) const;
+  /** Whether the blob has been decompressed. */
+  bool isLoaded() const;
+
+  /** All texts, decompressed on the first call; throws RESOURCE_INVALID for a damaged blob. */
+  const char* _data() const;
+};
+
+}
+
+#endif
@@ -6,9 +6,17 @@
 namespace commandline {
 
 class DynamicCommandLineAction : public CommandLineAction {
+ public:
+  typedef void (*DefineParametersCallback)(DynamicCommandLineAction*);
+  typedef void (*ExecuteCallback)(DynamicCommandLineAction*);
+ private:
+  DefineParametersCallback _defineParametersCallback;
+  ExecuteCallback _executeCallback;
  public:
   DynamicCommandLineAction();
   DynamicCommandLineAction(const CommandLineActionOptions&);
+
+  void setCallbacks(DefineParametersCallback, ExecuteCallback);
  protected:
   void onDefineParameters();
   void onExecute();
@@ -9,6 +9,30 @@ class DynamicCommandLineParser : public CommandLineParser {
  public:
   DynamicCommandLineParser();
   DynamicCommandLineParser(const CommandLineParserOptions&);
+
+  /**
+   * Adds a CommandLinePluginAction for every entry of a manifest file.
+   * Each non-empty line that does not start with "#" has the tab separated
+   * fields: action name, library path, entry symbol, summary.
+   * Relative library paths are resolved against the manifest directory.
+   */
+  void loadPluginManifest(const std::string& manifestPath);
+
+  /**
+   * Defines global parameters and actions from a JSON spec file, e.g.
+   * { "toolFilename": "tool", "parameters": [...], "actions": [{ "actionName": "build", "parameters": [...] }] }
+   * Parameters use the field names of the matching definition struct plus a
+   * "kind" property ("Choice", "Flag", "Integer", "Double", "Unsigned", "ByteSize",
+   * "Duration", "String" or "StringList"). ByteSize and Duration values are strings with units.
+   * Integer and Unsigned numbers have to be integers within int64_t, and
+   * Unsigned ones must not be negative. The spec is parsed into a JSON
+   * document first and each parameter definition is then filled from it. If
+   * useCache is true, the document is kept in binary form in
+   * "<specPath>.cache" and reused without reading the spec while its
+   * modification time and size are unchanged. The cache is replaced by
+   * renaming a temporary file, so readers never see a partial one.
+   */
+  void loadSpec(const std::string& specPath, bool useCache = false);
 };
 
 }
@@ -3,6 +3,17 @@
 
 #include "DynamicCommandLineParser.hpp"
 #include "DynamicCommandLineAction.hpp"
+#include "CommandLinePluginAction.hpp"
+#include "CommandLineArgumentBuffer.hpp"
+#include "CommandLineParameterSet.hpp"
+#include "CommandLineServer.hpp"
+#include "CommandLineIncrementalParser.hpp"
+#include "CommandLineResult.hpp"
 #include "CommandLineError.hpp"
+#include "CommandLineText.hpp"
+#include "CommandLineTextResource.hpp"
+#include "CommandLinePrerenderedHelp.hpp"
+#include "CommandLineActionRegistry.hpp"
+#include "CommandLineTelemetry.hpp"
 
 #endif
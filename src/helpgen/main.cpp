@@ -0,0 +1,41 @@
+// Renders the help of a tool at build time, for commandline_prerender_help()
+// in cmake/prerender.cmake. Linked with the tool's schema sources, which
+// define commandline::createPrerenderParser().
+// Usage: commandline-helpgen <output.cpp> <symbol>
+
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <memory>
+
+#include "commandline/CommandLineParser.hpp"
+#include "commandline/CommandLinePrerenderedHelp.hpp"
+
+int main(int argc, char** argv) {
+  if (argc != 3) {
+    std::cerr << "usage: commandline-helpgen <output.cpp> <symbol>" << std::endl;
+    return 2;
+  }
+  std::string source;
+  try {
+    std::unique_ptr<commandline::CommandLineParser> parser(commandline::createPrerenderParser());
+    source = commandline::renderPrerenderedHelpSource(*parser, argv[2]);
+  } catch (const std::exception& err) {
+    std::cerr << "commandline-helpgen: " << err.what() << std::endl;
+    return 1;
+  }
+
+  // Leave an unchanged file alone so that nothing is recompiled
+  std::ifstream existing(argv[1], std::ios::binary);
+  if (existing && std::string(std::istreambuf_iterator<char>(existing), std::istreambuf_iterator<char>()) == source) {
+    return 0;
+  }
+  existing.close();
+  std::ofstream out(argv[1], std::ios::binary);
+  out << source;
+  if (!out) {
+    std::cerr << "commandline-helpgen: unable to write " << argv[1] << std::endl;
+    return 1;
+  }
+  return 0;
+}
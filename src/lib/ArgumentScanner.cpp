@@ -0,0 +1,183 @@
+#include "ArgumentScanner.hpp"
+#include "commandline/CommandLineError.hpp"
+
+namespace commandline {
+
+namespace scan {
+
+namespace {
+
+// What the scanner sees in a token. The option inputs are only produced where
+// an option is expected, since that is the only place that needs the lookup.
+enum Input : uint8_t {
+  FlagOption,
+  ValueOption,
+  InlineOption,
+  HelpOption,
+  UnknownOption,
+  Option,
+  Boolean,
+  Number,
+  Word,
+  DashInput,
+  EndOfOptionsInput,
+  End,
+  InputCount
+};
+
+enum State : uint8_t {
+  Options,
+  FlagValue,
+  PendingValue,
+  StateCount
+};
+
+enum Step : uint8_t {
+  // The token starts the next scope
+  Stop,
+  // Remember the option and look at the next token for its value
+  Open,
+  // The value is inside the token: "--name=value", "-nVALUE"
+  Inline,
+  Help,
+  Undefined,
+  // The token is the value of the pending option
+  Take,
+  // The pending flag has no value; set it and look at the token again as an option
+  FlagTrue,
+  Missing
+};
+
+const Step transitions[StateCount][InputCount] = {
+  //                FlagOption ValueOption InlineOption HelpOption UnknownOption Option     Boolean Number     Word     Dash     EndOfOptions End
+  /* Options */     { Open,     Open,       Inline,      Help,      Undefined,    Undefined, Stop,   Undefined, Stop,    Stop,    Stop,        Stop },
+  /* FlagValue */   { FlagTrue, FlagTrue,   FlagTrue,    FlagTrue,  FlagTrue,     FlagTrue,  Take,   FlagTrue,  FlagTrue, FlagTrue, FlagTrue,  FlagTrue },
+  /* PendingValue */{ Missing,  Missing,    Missing,     Missing,   Missing,      Missing,   Take,   Take,      Take,    Take,    Missing,     Missing }
+};
+
+bool isBooleanLiteral(const std::string& text) {
+  return text == "true" || text == "false" || text == "1" || text == "0";
+}
+
+Input tokenInput(token::Kind kind, const std::string& text) {
+  switch (kind) {
+    case token::LongOption:
+    case token::LongOptionWithValue:
+    case token::ShortOption:
+    case token::ShortCluster:
+    case token::ShortWithValue:
+      return Option;
+    case token::NegativeInteger:
+    case token::NegativeNumber:
+      return Number;
+    case token::Dash:
+      return DashInput;
+    case token::EndOfOptions:
+      return EndOfOptionsInput;
+    default:
+      return isBooleanLiteral(text) ? Boolean : Word;
+  }
+}
+
+// The name part of an option token: "--name=value" and "-nVALUE" carry a value
+std::string optionName(const std::string& text, token::Kind kind, uint32_t valueOffset) {
+  if (kind == token::LongOptionWithValue) {
+    return text.substr(0, valueOffset - 1);
+  }
+  if (kind == token::LongOption) {
+    return text;
+  }
+  return text.substr(0, 2);
+}
+
+Input optionInput(const std::string& text, token::Kind kind, uint32_t valueOffset, const Lookup& lookup, CommandLineParameter*& parameter) {
+  if (text == "-h" || text == "--help") {
+    return HelpOption;
+  }
+  parameter = kind == token::LongOption ? lookup(text) : lookup(optionName(text, kind, valueOffset));
+  if (parameter == nullptr) {
+    return UnknownOption;
+  }
+  if (valueOffset != 0) {
+    return InlineOption;
+  }
+  return arityOf(parameter) == Flag ? FlagOption : ValueOption;
+}
+
+}
+
+Arity arityOf(const CommandLineParameter* parameter) {
+  return parameter->kind() == CommandLineParameterKind::Flag ? Flag : Value;
+}
+
+bool takesValue(Arity arity, token::Kind kind, const std::string& next) {
+  return transitions[arity == Flag ? FlagValue : PendingValue][tokenInput(kind, next)] == Take;
+}
+
+Result run(const std::vector<std::string>& args, const token::Classification& tokens, size_t begin, const Lookup& lookup, const Suggest& suggest) {
+  const size_t count = args.size();
+  Result result{ count, false };
+  State state = Options;
+  CommandLineParameter* pending = nullptr;
+  size_t pendingIndex = 0;
+  size_t i = begin;
+  for (;;) {
+    Input input = End;
+    CommandLineParameter* parameter = nullptr;
+    if (i < count) {
+      input = tokenInput(tokens.kinds[i], args[i]);
+      if (input == Option && state == Options) {
+        input = optionInput(args[i], tokens.kinds[i], tokens.valueOffsets[i], lookup, parameter);
+      }
+    }
+    switch (transitions[state][input]) {
+      case Stop:
+        result.stop = i;
+        return result;
+      case Open:
+        pending = parameter;
+        pendingIndex = i;
+        state = input == FlagOption ? FlagValue : PendingValue;
+        i++;
+        break;
+      case Inline:
+        parameter->_setValue(args[i].substr(tokens.valueOffsets[i]));
+        parameter->setHasValue();
+        i++;
+        break;
+      case Help:
+        // Whatever follows is not looked at, so it cannot keep the help from being shown
+        result.help = true;
+        result.stop = i;
+        return result;
+      case Undefined: {
+        std::string name = optionName(args[i], tokens.kinds[i], tokens.valueOffsets[i]);
+        std::string message = "The parameter \"" + name + "\" is not defined";
+        if (input == UnknownOption && suggest) {
+          std::string suggestion = suggest(name);
+          if (!suggestion.empty()) {
+            message += ". Did you mean \"" + suggestion + "\"?";
+          }
+        }
+        throw CommandLineError(PARAMETER_UNDEFINED, message, i);
+      }
+      case Take:
+        pending->_setValue(args[i]);
+        pending->setHasValue();
+        state = Options;
+        i++;
+        break;
+      case FlagTrue:
+        pending->_setValue(true);
+        pending->setHasValue();
+        state = Options;
+        break;
+      case Missing:
+        throw CommandLineError(VALUE_REQUIRED, "Missing value for " + pending->longName, pendingIndex);
+    }
+  }
+}
+
+}
+
+}
@@ -0,0 +1,48 @@
+#ifndef __ARGUMENT_SCANNER_HPP__
+#define __ARGUMENT_SCANNER_HPP__
+
+#include <functional>
+#include <string>
+#include <vector>
+
+#include "commandline/CommandLineParameter.hpp"
+#include "TokenClassifier.hpp"
+
+namespace commandline {
+
+// The state machine that assigns argv tokens to the parameters of one scope,
+// the parser's global parameters or those of the selected action. Both scopes
+// and the incremental parser share its transition table, so they agree on
+// which token is a value and which one starts something else.
+namespace scan {
+  // How an option consumes the token after it
+  enum Arity : uint8_t {
+    // Only a boolean literal: "--flag true"
+    Flag,
+    // Any token that does not look like an option, including "-5" and "-"
+    Value
+  };
+
+  Arity arityOf(const CommandLineParameter*);
+  // Whether an option of the given arity takes next as its value
+  bool takesValue(Arity, token::Kind, const std::string& next);
+
+  struct Result {
+    // The first token that does not belong to the scope, or args.size()
+    size_t stop;
+    // "-h" or "--help" appeared where an option was expected
+    bool help;
+  };
+
+  typedef std::function<CommandLineParameter*(const std::string&)> Lookup;
+  // The name to propose for an unknown option, or ""
+  typedef std::function<std::string(const std::string&)> Suggest;
+
+  // Applies the options of args[begin, stop) to the parameters found by
+  // lookup. Errors carry the index of the offending token in args.
+  Result run(const std::vector<std::string>& args, const token::Classification&, size_t begin, const Lookup&, const Suggest& suggest = Suggest());
+}
+
+}
+
+#endif
@@ -7,7 +7,8 @@ CommandLineAction::CommandLineAction():
   CommandLineParameterProvider(),
   actionName(),
   summary(),
-  documentation() {}
+  documentation(),
+  timeout(std::chrono::milliseconds::zero()) {}
 
 CommandLineAction::CommandLineAction(const CommandLineActionOptions& options):
   CommandLineAction() {
@@ -20,6 +21,7 @@ void CommandLineAction::_init(const CommandLineActionOptions& options) {
   actionName = options.actionName;
   summary = options.summary;
   documentation = options.documentation;
+  timeout = options.timeout;
 
   std::regex _actionNameRegExp("^[a-z][a-z0-9]*([-:][a-z0-9]+)*$");
   std::smatch sm;
@@ -34,6 +36,22 @@ void CommandLineAction::_buildParser() {
 void CommandLineAction::_execute() {
   this->onExecute();
 }
+std::future<void> CommandLineAction::_executeAsync(CommandLineExecutionContext& context) {
+  return this->onExecuteAsync(context);
+}
+
+std::future<void> CommandLineAction::onExecuteAsync(CommandLineExecutionContext&) {
+  std::promise<void> promise;
+  try {
+    this->onExecute();
+    promise.set_value();
+  } catch (...) {
+    promise.set_exception(std::current_exception());
+  }
+  return promise.get_future();
+}
+
+void CommandLineAction::_activate() {}
 
 void CommandLineAction::_processArgs(const std::vector<std::string>& args) {
   CommandLineParameterProvider::_processArgs(args);
@@ -100,6 +118,16 @@ std::string CommandLineAction::renderHelpText(const std::string& toolFilename) c
         }
         break;
       }
+      case CommandLineParameterKind::Double:
+      case CommandLineParameterKind::Unsigned:
+      case CommandLineParameterKind::ByteSize:
+      case CommandLineParameterKind::Duration: {
+        const CommandLineParameterWithArgument* param = static_cast<const CommandLineParameterWithArgument*>(p);
+        if (param->argumentName != "") {
+          optionString += " " + param->argumentName;
+        }
+        break;
+      }
       default:
         break;
     }
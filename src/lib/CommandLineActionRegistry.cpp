@@ -0,0 +1,55 @@
+#include <algorithm>
+#include <cstring>
+
+#include "commandline/CommandLineActionRegistry.hpp"
+
+namespace commandline {
+
+// Constant-initialized, so registrars of other translation units may run first
+static const CommandLineActionDescriptor* registeredActionList = nullptr;
+
+CommandLineActionRegistry::CommandLineActionRegistry(const CommandLineActionDescriptor* const* begin, const CommandLineActionDescriptor* const* end, const CommandLineActionDescriptor* list):
+  _begin(begin),
+  _end(end),
+  _list(list) {}
+
+static bool descriptorNameLess(const CommandLineActionDescriptor* a, const CommandLineActionDescriptor* b) {
+  return std::strcmp(a->actionName, b->actionName) < 0;
+}
+
+const CommandLineActionDescriptor* CommandLineActionRegistry::find(const std::string& actionName) const {
+  if (this->_index.empty()) {
+    this->forEach([this](const CommandLineActionDescriptor& descriptor) {
+      this->_index.push_back(&descriptor);
+    });
+    // Stable, so the first registration of a duplicate name stays in front
+    std::stable_sort(this->_index.begin(), this->_index.end(), descriptorNameLess);
+  }
+  auto it = std::lower_bound(this->_index.begin(), this->_index.end(), actionName.c_str(),
+    [](const CommandLineActionDescriptor* descriptor, const char* name) {
+      return std::strcmp(descriptor->actionName, name) < 0;
+    });
+  if (it != this->_index.end() && std::strcmp((*it)->actionName, actionName.c_str()) == 0) {
+    return *it;
+  }
+  return nullptr;
+}
+
+bool CommandLineActionRegistry::empty() const {
+  bool empty = true;
+  this->forEach([&empty](const CommandLineActionDescriptor&) {
+    empty = false;
+  });
+  return empty;
+}
+
+CommandLineActionRegistrar::CommandLineActionRegistrar(CommandLineActionDescriptor& descriptor) {
+  descriptor.next = registeredActionList;
+  registeredActionList = &descriptor;
+}
+
+const CommandLineActionDescriptor* _registeredActionList() {
+  return registeredActionList;
+}
+
+}
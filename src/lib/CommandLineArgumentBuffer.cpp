@@ -0,0 +1,284 @@
+#include "commandline/CommandLineArgumentBuffer.hpp"
+#include "ValueParser.hpp"
+#include <cstdlib>
+#include <cstring>
+
+#ifdef _WIN32
+#define environ _environ
+#elif defined(__APPLE__)
+#include <crt_externs.h>
+#define environ (*_NSGetEnviron())
+#else
+extern char** environ;
+#endif
+
+namespace commandline {
+
+static size_t formatUnsigned(uint64_t value, char* buf, size_t size) {
+  char* end = buf + size;
+  char* p = end;
+  do {
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  size_t length = static_cast<size_t>(end - p);
+  memmove(buf, p, length);
+  return length;
+}
+
+static size_t formatSigned(int64_t value, char* buf, size_t size) {
+  if (value < 0) {
+    buf[0] = '-';
+    return 1 + formatUnsigned(static_cast<uint64_t>(-(value + 1)) + 1, buf + 1, size - 1);
+  }
+  return formatUnsigned(static_cast<uint64_t>(value), buf, size);
+}
+
+CommandLineArgumentBuffer::CommandLineArgumentBuffer():
+  _executable(),
+  _sources(),
+  _passthroughArgs(),
+  _filter(),
+  _explicitOnly(false),
+  _inheritEnvironment(true),
+  _environment(),
+  _dirty(true),
+  _bytes(),
+  _offsets(),
+  _argc(0),
+  _pointers() {}
+
+CommandLineArgumentBuffer::CommandLineArgumentBuffer(const std::string& executable):
+  CommandLineArgumentBuffer() {
+  _executable = executable;
+}
+
+void CommandLineArgumentBuffer::setExecutable(const std::string& executable) {
+  this->_executable = executable;
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::addProvider(const CommandLineParameterProvider* provider, bool includeRemainder) {
+  Source source;
+  source.provider = provider;
+  source.includeRemainder = includeRemainder;
+  source.revision = 0;
+  this->_sources.push_back(source);
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::setPassthroughArgs(const std::vector<std::string>& args) {
+  this->_passthroughArgs = args;
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::setFilter(const ParameterFilter& filter) {
+  this->_filter = filter;
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::setExplicitOnly(bool explicitOnly) {
+  this->_explicitOnly = explicitOnly;
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::setInheritEnvironment(bool inherit) {
+  this->_inheritEnvironment = inherit;
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::setEnvironmentVariable(const std::string& name, const std::string& value) {
+  this->_environment[name] = value;
+  this->_dirty = true;
+}
+
+void CommandLineArgumentBuffer::invalidate() {
+  this->_dirty = true;
+}
+
+bool CommandLineArgumentBuffer::_isStale() const {
+  if (this->_dirty) {
+    return true;
+  }
+  for (const Source& source : this->_sources) {
+    if (source.provider->revision() != source.revision) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void CommandLineArgumentBuffer::_refresh() {
+  if (this->_isStale()) {
+    this->_build();
+  }
+}
+
+void CommandLineArgumentBuffer::_appendArg(const char* data, size_t length) {
+  this->_offsets.push_back(this->_bytes.size());
+  this->_bytes.insert(this->_bytes.end(), data, data + length);
+  this->_bytes.push_back('\0');
+}
+
+void CommandLineArgumentBuffer::_appendArg(const std::string& arg) {
+  this->_appendArg(arg.data(), arg.length());
+}
+
+void CommandLineArgumentBuffer::_appendEnvironmentVariable(const std::string& name, const std::string& value) {
+  this->_offsets.push_back(this->_bytes.size());
+  this->_bytes.insert(this->_bytes.end(), name.begin(), name.end());
+  this->_bytes.push_back('=');
+  this->_bytes.insert(this->_bytes.end(), value.begin(), value.end());
+  this->_bytes.push_back('\0');
+}
+
+void CommandLineArgumentBuffer::_appendParameter(const CommandLineParameter* p) {
+  char number[32];
+  switch (p->kind()) {
+    case CommandLineParameterKind::Flag: {
+      // The child falls back to the same default, so only a difference is passed
+      const CommandLineFlagParameter* flag = static_cast<const CommandLineFlagParameter*>(p);
+      bool value = flag->value();
+      if (value != flag->defaultValue) {
+        this->_appendArg(p->longName);
+        if (!value) {
+          this->_appendArg("false", 5);
+        }
+      }
+      break;
+    }
+    case CommandLineParameterKind::Choice:
+      this->_appendArg(p->longName);
+      this->_appendArg(static_cast<const CommandLineChoiceParameter*>(p)->value());
+      break;
+    case CommandLineParameterKind::Integer:
+      this->_appendArg(p->longName);
+      this->_appendArg(number, formatSigned(static_cast<const CommandLineIntegerParameter*>(p)->value(), number, sizeof(number)));
+      break;
+    case CommandLineParameterKind::Unsigned:
+      this->_appendArg(p->longName);
+      this->_appendArg(number, formatUnsigned(static_cast<const CommandLineUnsignedParameter*>(p)->value(), number, sizeof(number)));
+      break;
+    case CommandLineParameterKind::ByteSize:
+      this->_appendArg(p->longName);
+      this->_appendArg(number, formatUnsigned(static_cast<const CommandLineByteSizeParameter*>(p)->value(), number, sizeof(number)));
+      break;
+    case CommandLineParameterKind::Duration: {
+      size_t length = formatSigned(static_cast<const CommandLineDurationParameter*>(p)->value().count(), number, sizeof(number) - 2);
+      number[length++] = 'n';
+      number[length++] = 's';
+      this->_appendArg(p->longName);
+      this->_appendArg(number, length);
+      break;
+    }
+    case CommandLineParameterKind::Double: {
+      std::string value = commandline::value::formatDouble(static_cast<const CommandLineDoubleParameter*>(p)->value());
+      this->_appendArg(p->longName);
+      this->_appendArg(value);
+      break;
+    }
+    case CommandLineParameterKind::String: {
+      const std::string& value = static_cast<const CommandLineStringParameter*>(p)->value();
+      if (value != "") {
+        this->_appendArg(p->longName);
+        this->_appendArg(value);
+      }
+      break;
+    }
+    case CommandLineParameterKind::StringList:
+      for (const std::string& value : static_cast<const CommandLineStringListParameter*>(p)->values()) {
+        this->_appendArg(p->longName);
+        this->_appendArg(value);
+      }
+      break;
+    default: {
+      std::vector<std::string> argList;
+      p->appendToArgList(argList);
+      for (const std::string& arg : argList) {
+        this->_appendArg(arg);
+      }
+      break;
+    }
+  }
+}
+
+void CommandLineArgumentBuffer::_build() {
+  size_t previousSize = this->_bytes.size();
+  this->_bytes.clear();
+  this->_bytes.reserve(previousSize);
+  this->_offsets.clear();
+
+  this->_appendArg(this->_executable);
+  for (Source& source : this->_sources) {
+    for (const CommandLineParameter* p : source.provider->parameters()) {
+      if (this->_explicitOnly && !p->hasValue()) {
+        continue;
+      }
+      if (this->_filter && !this->_filter(p)) {
+        continue;
+      }
+      this->_appendParameter(p);
+    }
+    const CommandLineRemainder* remainder = source.provider->remainder();
+    if (source.includeRemainder && remainder != nullptr) {
+      for (const std::string& value : remainder->values()) {
+        this->_appendArg(value);
+      }
+    }
+    source.revision = source.provider->revision();
+  }
+  for (const std::string& arg : this->_passthroughArgs) {
+    this->_appendArg(arg);
+  }
+  this->_argc = this->_offsets.size();
+
+  // Read live on every build, so setenv() calls before invalidate() are seen.
+  // A value may contain "=", only the first one ends the name.
+  if (this->_inheritEnvironment && environ != nullptr) {
+    for (char** e = environ; *e != nullptr; e++) {
+      const char* eq = std::strchr(*e, '=');
+      if (eq == nullptr || eq == *e) {
+        continue;
+      }
+      if (this->_environment.find(std::string(*e, static_cast<size_t>(eq - *e))) == this->_environment.end()) {
+        this->_appendArg(*e, std::strlen(*e));
+      }
+    }
+  }
+  for (const auto& entry : this->_environment) {
+    this->_appendEnvironmentVariable(entry.first, entry.second);
+  }
+
+  // the byte block no longer grows, so pointers into it stay valid
+  this->_pointers.resize(this->_offsets.size() + 2);
+  char* base = this->_bytes.data();
+  size_t slot = 0;
+  for (size_t i = 0; i < this->_offsets.size(); i++) {
+    if (i == this->_argc) {
+      this->_pointers[slot++] = nullptr;
+    }
+    this->_pointers[slot++] = base + this->_offsets[i];
+  }
+  if (this->_argc == this->_offsets.size()) {
+    this->_pointers[slot++] = nullptr;
+  }
+  this->_pointers[slot] = nullptr;
+  this->_dirty = false;
+}
+
+size_t CommandLineArgumentBuffer::argc() {
+  this->_refresh();
+  return this->_argc;
+}
+
+char* const* CommandLineArgumentBuffer::argv() {
+  this->_refresh();
+  return this->_pointers.data();
+}
+
+char* const* CommandLineArgumentBuffer::envp() {
+  this->_refresh();
+  return this->_pointers.data() + this->_argc + 1;
+}
+
+}
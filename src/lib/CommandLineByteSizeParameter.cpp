@@ -0,0 +1,98 @@
+#include "commandline/CommandLineParameter.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "EnvironmentVariable.hpp"
+#include "ValueParser.hpp"
+#include <cstddef>
+
+namespace commandline {
+
+  CommandLineByteSizeParameter::CommandLineByteSizeParameter(const CommandLineByteSizeDefinition& definition):
+    CommandLineParameterWithArgument(definition),
+    _value(0),
+    defaultValue(definition.defaultValue),
+    minimum(definition.minimum),
+    maximum(definition.maximum) {
+    if (this->minimum > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "The minimum of \"" + this->longName + "\" is greater than its maximum");
+    }
+    if (!this->required && (this->defaultValue < this->minimum || this->defaultValue > this->maximum)) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "The default value " + commandline::value::formatByteSize(this->defaultValue) + " of \"" + this->longName + "\" is outside the range [" + commandline::value::formatByteSize(this->minimum) + ", " + commandline::value::formatByteSize(this->maximum) + "]");
+    }
+  }
+
+  CommandLineParameterKind CommandLineByteSizeParameter::kind() const {
+    return CommandLineParameterKind::ByteSize;
+  }
+
+  void CommandLineByteSizeParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
+    if (this->environmentVariable != "") {
+      std::string environmentValue;
+      if (commandline::getEnv(this->environmentVariable, environmentValue) && environmentValue != "") {
+        uint64_t parsed;
+        size_t offset = 0;
+        const char* error = commandline::value::parseByteSize(environmentValue, parsed, offset);
+        if (error != nullptr) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ": " + error + " at offset " + std::to_string(offset));
+        }
+        if (parsed < this->minimum || parsed > this->maximum) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". It must be in the range [" + commandline::value::formatByteSize(this->minimum) + ", " + commandline::value::formatByteSize(this->maximum) + "].");
+        }
+        this->_value.get() = parsed;
+        this->_valueSource = CommandLineValueSource::Environment;
+        return;
+      }
+    }
+
+    this->_value.get() = this->defaultValue;
+  }
+  void CommandLineByteSizeParameter::_setValue(bool data) {
+    reportInvalidData(data);
+  }
+  void CommandLineByteSizeParameter::_setValue(int64_t data) {
+    if (data < 0) {
+      reportInvalidData(data);
+    }
+    uint64_t v = static_cast<uint64_t>(data);
+    if (v < this->minimum || v > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "Invalid value " + std::to_string(data) + " for the parameter " + this->longName + ". It must be in the range [" + commandline::value::formatByteSize(this->minimum) + ", " + commandline::value::formatByteSize(this->maximum) + "].");
+    }
+    this->_value.get() = v;
+  }
+  void CommandLineByteSizeParameter::_setValue(const std::string& data) {
+    uint64_t parsed;
+    size_t offset = 0;
+    const char* error = commandline::value::parseByteSize(data, parsed, offset);
+    if (error != nullptr) {
+      throw CommandLineError(INVALID_VALUE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ": " + error + " at offset " + std::to_string(offset));
+    }
+    if (parsed < this->minimum || parsed > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ". It must be in the range [" + commandline::value::formatByteSize(this->minimum) + ", " + commandline::value::formatByteSize(this->maximum) + "].");
+    }
+    this->_value.get() = parsed;
+  }
+  void CommandLineByteSizeParameter::_setValue(const std::vector<std::string>& data) {
+    reportInvalidData(data);
+  }
+
+  void CommandLineByteSizeParameter::_getSupplementaryNotes(std::vector<std::string>& supplementaryNotes) const {
+    CommandLineParameterWithArgument::_getSupplementaryNotes(supplementaryNotes);
+
+    supplementaryNotes.push_back("The default value is \"" + commandline::value::formatByteSize(this->defaultValue) + "\".");
+  }
+
+  void CommandLineByteSizeParameter::appendToArgList(std::vector<std::string>& argList) const {
+    argList.push_back(this->longName);
+    argList.push_back(commandline::value::formatByteSize(this->value()));
+  }
+
+  uint64_t CommandLineByteSizeParameter::value() const {
+    this->_resolve();
+    return this->_value.get();
+  }
+
+  void CommandLineByteSizeParameter::bind(uint64_t& target) {
+    this->_value.bind(target);
+    this->_bound = true;
+  }
+}
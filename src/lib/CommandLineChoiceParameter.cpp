@@ -1,7 +1,6 @@
 #include "commandline/CommandLineParameter.hpp"
 #include "commandline/CommandLineError.hpp"
 #include "EnvironmentVariable.hpp"
-#include "StringUtil.hpp"
 #include <cstddef>
 
 #include <sstream>
@@ -10,18 +9,27 @@ namespace commandline {
 
   CommandLineChoiceParameter::CommandLineChoiceParameter(const CommandLineChoiceDefinition& definition):
     CommandLineParameter(definition),
-    _value(""),
+    _index(0),
+    _defaultIndex(0),
+    _alternativeIndex(),
     alternatives(definition.alternatives),
     defaultValue("") {
     if (definition.alternatives.size() < 1) {
       throw CommandLineError(EMPTY_ALTERNATIVE_LIST, "When defining a choice parameter, the alternatives list must contain at least one value.)");
     }
 
+    this->_alternativeIndex.reserve(this->alternatives.size());
+    for (size_t i = 0; i < this->alternatives.size(); i++) {
+      this->_alternativeIndex.emplace(this->alternatives[i], i);
+    }
+
     if (definition.defaultValue != "") {
-      if (commandline::string::indexOf(definition.alternatives, definition.defaultValue) == -1) {
+      int index = this->indexOf(definition.defaultValue);
+      if (index == -1) {
         throw CommandLineError(ERROR_ALTERNATIVE_DEFAULT_VALUE, "The specified default value \"" + definition.defaultValue + "\" is not one of the available options: " + formatStringArray(definition.alternatives));
       } else {
         this->defaultValue = definition.defaultValue;
+        this->_defaultIndex = static_cast<size_t>(index);
       }
     } else {
       this->defaultValue = this->alternatives[0];
@@ -34,25 +42,30 @@ namespace commandline {
     return CommandLineParameterKind::Choice;
   }
 
+  int CommandLineChoiceParameter::indexOf(const std::string& alternative) const {
+    auto it = this->_alternativeIndex.find(alternative);
+    if (it == this->_alternativeIndex.end()) {
+      return -1;
+    }
+    return static_cast<int>(it->second);
+  }
+
   void CommandLineChoiceParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
     if (this->environmentVariable != "") {
-      auto env = commandline::env();
       std::string environmentValue;
-      if (env.find(this->environmentVariable) != env.end() && (environmentValue = env.at(this->environmentVariable)) != "") {
-        if (commandline::string::indexOf(this->alternatives, environmentValue) < 0) {
+      if (commandline::getEnv(this->environmentVariable, environmentValue) && environmentValue != "") {
+        int index = this->indexOf(environmentValue);
+        if (index < 0) {
           throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". Valid choices are: " + formatStringArray(this->alternatives));
         }
-        this->_value = environmentValue;
+        this->_index = static_cast<size_t>(index);
+        this->_valueSource = CommandLineValueSource::Environment;
         return;
       }
     }
 
-    if (this->defaultValue != "") {
-      this->_value = this->defaultValue;
-      return;
-    }
-
-    this->_value = this->alternatives[0];
+    this->_index = this->_defaultIndex;
   }
   void CommandLineChoiceParameter::_setValue(bool data) {
     reportInvalidData(data);
@@ -61,10 +74,11 @@ namespace commandline {
     reportInvalidData(data);
   }
   void CommandLineChoiceParameter::_setValue(const std::string& data) {
-    if (commandline::string::indexOf(this->alternatives, data) < 0) {
+    int index = this->indexOf(data);
+    if (index < 0) {
       throw CommandLineError(INVALID_VALUE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ". Valid choices are: " + formatStringArray(this->alternatives));
     }
-    this->_value = data;
+    this->_index = static_cast<size_t>(index);
   }
   void CommandLineChoiceParameter::_setValue(const std::vector<std::string>& data) {
     reportInvalidData(data);
@@ -79,14 +93,18 @@ namespace commandline {
   }
 
   void CommandLineChoiceParameter::appendToArgList(std::vector<std::string>& argList) const {
-    if (this->_value != "") {
-      argList.push_back(this->longName);
-      argList.push_back(this->_value);
-    }
+    argList.push_back(this->longName);
+    argList.push_back(this->value());
   }
 
   const std::string& CommandLineChoiceParameter::value() const {
-    return this->_value;
+    this->_resolve();
+    return this->alternatives[this->_index];
+  }
+
+  size_t CommandLineChoiceParameter::index() const {
+    this->_resolve();
+    return this->_index;
   }
 
   std::string CommandLineChoiceParameter::formatAlternatives() const {
@@ -0,0 +1,148 @@
+#include "commandline/CommandLineConstraintSet.hpp"
+
+namespace commandline {
+
+static inline int popcount(uint64_t word) {
+#if defined(__GNUC__) || defined(__clang__)
+  return __builtin_popcountll(word);
+#else
+  int count = 0;
+  for (; word != 0; word &= word - 1) count++;
+  return count;
+#endif
+}
+
+// Appends the ids of the set bits of words to ids.
+static void collect(const uint64_t* words, size_t count, std::vector<size_t>& ids) {
+  for (size_t w = 0; w < count; w++) {
+    for (uint64_t word = words[w]; word != 0; word &= word - 1) {
+      size_t bit = 0;
+      while (((word >> bit) & 1) == 0) bit++;
+      ids.push_back(w * 64 + bit);
+    }
+  }
+}
+
+CommandLineConstraintSet::CommandLineConstraintSet():
+  _parameterCount(0), _words(0), _compiled(false) {}
+
+void CommandLineConstraintSet::_addRule(CommandLineConstraintKind kind, const std::vector<size_t>& ids, size_t trigger, size_t alternative) {
+  this->_rules.push_back(Rule{ kind, ids, trigger, alternative });
+  this->_compiled = false;
+}
+
+void CommandLineConstraintSet::addMutuallyExclusive(const std::vector<size_t>& ids) {
+  this->_addRule(CommandLineConstraintKind::MutuallyExclusive, ids, 0, 0);
+}
+
+void CommandLineConstraintSet::addRequires(size_t trigger, const std::vector<size_t>& ids) {
+  this->_addRule(CommandLineConstraintKind::Requires, ids, trigger, 0);
+}
+
+void CommandLineConstraintSet::addAtLeastOneOf(const std::vector<size_t>& ids) {
+  this->_addRule(CommandLineConstraintKind::AtLeastOneOf, ids, 0, 0);
+}
+
+void CommandLineConstraintSet::addRequiredWhen(size_t trigger, size_t alternative, const std::vector<size_t>& ids) {
+  this->_addRule(CommandLineConstraintKind::RequiredWhen, ids, trigger, alternative);
+}
+
+size_t CommandLineConstraintSet::size() const {
+  return this->_rules.size();
+}
+
+void CommandLineConstraintSet::_compile(const std::vector<CommandLineParameter*>& parameters) {
+  this->_parameterCount = parameters.size();
+  this->_words = (parameters.size() + 63) / 64;
+  this->_masks.assign(this->_rules.size() * this->_words, 0);
+  for (size_t r = 0; r < this->_rules.size(); r++) {
+    uint64_t* mask = this->_masks.data() + r * this->_words;
+    for (size_t id : this->_rules[r].ids) {
+      mask[id / 64] |= uint64_t(1) << (id % 64);
+    }
+  }
+  this->_required.assign(this->_words, 0);
+  for (size_t id = 0; id < parameters.size(); id++) {
+    if (parameters[id]->required) {
+      this->_required[id / 64] |= uint64_t(1) << (id % 64);
+    }
+  }
+  this->_given.assign(this->_words, 0);
+  this->_compiled = true;
+}
+
+void CommandLineConstraintSet::validate(const std::vector<CommandLineParameter*>& parameters, std::vector<CommandLineConstraintViolation>& violations) {
+  if (!this->_compiled || this->_parameterCount != parameters.size()) {
+    this->_compile(parameters);
+  }
+  const size_t words = this->_words;
+  uint64_t* given = this->_given.data();
+  for (size_t w = 0; w < words; w++) given[w] = 0;
+  for (size_t id = 0; id < parameters.size(); id++) {
+    if (parameters[id]->hasValue()) {
+      given[id / 64] |= uint64_t(1) << (id % 64);
+    }
+  }
+
+  std::vector<uint64_t> scratch(words);
+  uint64_t missing = 0;
+  for (size_t w = 0; w < words; w++) {
+    scratch[w] = this->_required[w] & ~given[w];
+    missing |= scratch[w];
+  }
+  if (missing != 0) {
+    std::vector<size_t> ids;
+    collect(scratch.data(), words, ids);
+    for (size_t id : ids) {
+      violations.push_back(CommandLineConstraintViolation{ CommandLineConstraintKind::Required, id, { id } });
+    }
+  }
+
+  for (size_t r = 0; r < this->_rules.size(); r++) {
+    const Rule& rule = this->_rules[r];
+    const uint64_t* mask = this->_masks.data() + r * words;
+    bool triggered = true;
+    if (rule.kind == CommandLineConstraintKind::Requires) {
+      triggered = (given[rule.trigger / 64] >> (rule.trigger % 64)) & 1;
+    } else if (rule.kind == CommandLineConstraintKind::RequiredWhen) {
+      // The effective value counts, whether it came from the command line, the environment or the default
+      triggered = static_cast<const CommandLineChoiceParameter*>(parameters[rule.trigger])->index() == rule.alternative;
+    }
+    if (!triggered) {
+      continue;
+    }
+
+    int present = 0;
+    uint64_t absent = 0;
+    for (size_t w = 0; w < words; w++) {
+      scratch[w] = mask[w] & given[w];
+      present += popcount(scratch[w]);
+      absent |= mask[w] & ~given[w];
+    }
+    bool violated = false;
+    switch (rule.kind) {
+      case CommandLineConstraintKind::MutuallyExclusive:
+        violated = present > 1;
+        break;
+      case CommandLineConstraintKind::AtLeastOneOf:
+        violated = present == 0;
+        if (violated) {
+          for (size_t w = 0; w < words; w++) scratch[w] = mask[w];
+        }
+        break;
+      default:
+        violated = absent != 0;
+        if (violated) {
+          for (size_t w = 0; w < words; w++) scratch[w] = mask[w] & ~given[w];
+        }
+        break;
+    }
+    if (violated) {
+      CommandLineConstraintViolation violation{ rule.kind, rule.trigger, {} };
+      collect(scratch.data(), words, violation.ids);
+      violations.push_back(violation);
+    }
+  }
+}
+
+}
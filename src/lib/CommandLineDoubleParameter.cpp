@@ -0,0 +1,95 @@
+#include "commandline/CommandLineParameter.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "EnvironmentVariable.hpp"
+#include "ValueParser.hpp"
+#include <cstddef>
+
+namespace commandline {
+
+  CommandLineDoubleParameter::CommandLineDoubleParameter(const CommandLineDoubleDefinition& definition):
+    CommandLineParameterWithArgument(definition),
+    _value(0),
+    defaultValue(definition.defaultValue),
+    minimum(definition.minimum),
+    maximum(definition.maximum) {
+    if (this->minimum > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "The minimum of \"" + this->longName + "\" is greater than its maximum");
+    }
+    if (!this->required && (this->defaultValue < this->minimum || this->defaultValue > this->maximum)) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "The default value " + commandline::value::formatDouble(this->defaultValue) + " of \"" + this->longName + "\" is outside the range [" + commandline::value::formatDouble(this->minimum) + ", " + commandline::value::formatDouble(this->maximum) + "]");
+    }
+  }
+
+  CommandLineParameterKind CommandLineDoubleParameter::kind() const {
+    return CommandLineParameterKind::Double;
+  }
+
+  void CommandLineDoubleParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
+    if (this->environmentVariable != "") {
+      std::string environmentValue;
+      if (commandline::getEnv(this->environmentVariable, environmentValue) && environmentValue != "") {
+        double parsed;
+        size_t offset = 0;
+        const char* error = commandline::value::parseDouble(environmentValue, parsed, offset);
+        if (error != nullptr) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ": " + error + " at offset " + std::to_string(offset));
+        }
+        if (parsed < this->minimum || parsed > this->maximum) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". It must be in the range [" + commandline::value::formatDouble(this->minimum) + ", " + commandline::value::formatDouble(this->maximum) + "].");
+        }
+        this->_value.get() = parsed;
+        this->_valueSource = CommandLineValueSource::Environment;
+        return;
+      }
+    }
+
+    this->_value.get() = this->defaultValue;
+  }
+  void CommandLineDoubleParameter::_setValue(bool data) {
+    reportInvalidData(data);
+  }
+  void CommandLineDoubleParameter::_setValue(int64_t data) {
+    double v = static_cast<double>(data);
+    if (v < this->minimum || v > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "Invalid value " + std::to_string(data) + " for the parameter " + this->longName + ". It must be in the range [" + commandline::value::formatDouble(this->minimum) + ", " + commandline::value::formatDouble(this->maximum) + "].");
+    }
+    this->_value.get() = v;
+  }
+  void CommandLineDoubleParameter::_setValue(const std::string& data) {
+    double parsed;
+    size_t offset = 0;
+    const char* error = commandline::value::parseDouble(data, parsed, offset);
+    if (error != nullptr) {
+      throw CommandLineError(INVALID_VALUE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ": " + error + " at offset " + std::to_string(offset));
+    }
+    if (parsed < this->minimum || parsed > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ". It must be in the range [" + commandline::value::formatDouble(this->minimum) + ", " + commandline::value::formatDouble(this->maximum) + "].");
+    }
+    this->_value.get() = parsed;
+  }
+  void CommandLineDoubleParameter::_setValue(const std::vector<std::string>& data) {
+    reportInvalidData(data);
+  }
+
+  void CommandLineDoubleParameter::_getSupplementaryNotes(std::vector<std::string>& supplementaryNotes) const {
+    CommandLineParameterWithArgument::_getSupplementaryNotes(supplementaryNotes);
+
+    supplementaryNotes.push_back("The default value is \"" + commandline::value::formatDouble(this->defaultValue) + "\".");
+  }
+
+  void CommandLineDoubleParameter::appendToArgList(std::vector<std::string>& argList) const {
+    argList.push_back(this->longName);
+    argList.push_back(commandline::value::formatDouble(this->value()));
+  }
+
+  double CommandLineDoubleParameter::value() const {
+    this->_resolve();
+    return this->_value.get();
+  }
+
+  void CommandLineDoubleParameter::bind(double& target) {
+    this->_value.bind(target);
+    this->_bound = true;
+  }
+}
@@ -0,0 +1,93 @@
+#include "commandline/CommandLineParameter.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "EnvironmentVariable.hpp"
+#include "ValueParser.hpp"
+#include <cstddef>
+
+namespace commandline {
+
+  CommandLineDurationParameter::CommandLineDurationParameter(const CommandLineDurationDefinition& definition):
+    CommandLineParameterWithArgument(definition),
+    _value(std::chrono::nanoseconds::zero()),
+    defaultValue(definition.defaultValue),
+    minimum(definition.minimum),
+    maximum(definition.maximum) {
+    if (this->minimum > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "The minimum of \"" + this->longName + "\" is greater than its maximum");
+    }
+    if (!this->required && (this->defaultValue < this->minimum || this->defaultValue > this->maximum)) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "The default value " + commandline::value::formatDuration(this->defaultValue.count()) + " of \"" + this->longName + "\" is outside the range [" + commandline::value::formatDuration(this->minimum.count()) + ", " + commandline::value::formatDuration(this->maximum.count()) + "]");
+    }
+  }
+
+  CommandLineParameterKind CommandLineDurationParameter::kind() const {
+    return CommandLineParameterKind::Duration;
+  }
+
+  void CommandLineDurationParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
+    if (this->environmentVariable != "") {
+      std::string environmentValue;
+      if (commandline::getEnv(this->environmentVariable, environmentValue) && environmentValue != "") {
+        int64_t parsed;
+        size_t offset = 0;
+        const char* error = commandline::value::parseDuration(environmentValue, parsed, offset);
+        if (error != nullptr) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ": " + error + " at offset " + std::to_string(offset));
+        }
+        std::chrono::nanoseconds duration(parsed);
+        if (duration < this->minimum || duration > this->maximum) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". It must be in the range [" + commandline::value::formatDuration(this->minimum.count()) + ", " + commandline::value::formatDuration(this->maximum.count()) + "].");
+        }
+        this->_value.get() = duration;
+        this->_valueSource = CommandLineValueSource::Environment;
+        return;
+      }
+    }
+
+    this->_value.get() = this->defaultValue;
+  }
+  void CommandLineDurationParameter::_setValue(bool data) {
+    reportInvalidData(data);
+  }
+  void CommandLineDurationParameter::_setValue(int64_t data) {
+    reportInvalidData(data);
+  }
+  void CommandLineDurationParameter::_setValue(const std::string& data) {
+    int64_t parsed;
+    size_t offset = 0;
+    const char* error = commandline::value::parseDuration(data, parsed, offset);
+    if (error != nullptr) {
+      throw CommandLineError(INVALID_VALUE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ": " + error + " at offset " + std::to_string(offset));
+    }
+    std::chrono::nanoseconds duration(parsed);
+    if (duration < this->minimum || duration > this->maximum) {
+      throw CommandLineError(VALUE_OUT_OF_RANGE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ". It must be in the range [" + commandline::value::formatDuration(this->minimum.count()) + ", " + commandline::value::formatDuration(this->maximum.count()) + "].");
+    }
+    this->_value.get() = duration;
+  }
+  void CommandLineDurationParameter::_setValue(const std::vector<std::string>& data) {
+    reportInvalidData(data);
+  }
+
+  void CommandLineDurationParameter::_getSupplementaryNotes(std::vector<std::string>& supplementaryNotes) const {
+    CommandLineParameterWithArgument::_getSupplementaryNotes(supplementaryNotes);
+
+    supplementaryNotes.push_back("The default value is \"" + commandline::value::formatDuration(this->defaultValue.count()) + "\".");
+  }
+
+  void CommandLineDurationParameter::appendToArgList(std::vector<std::string>& argList) const {
+    argList.push_back(this->longName);
+    argList.push_back(commandline::value::formatDuration(this->value().count()));
+  }
+
+  std::chrono::nanoseconds CommandLineDurationParameter::value() const {
+    this->_resolve();
+    return this->_value.get();
+  }
+
+  void CommandLineDurationParameter::bind(std::chrono::nanoseconds& target) {
+    this->_value.bind(target);
+    this->_bound = true;
+  }
+}
@@ -3,10 +3,31 @@
 namespace commandline {
   CommandLineError::~CommandLineError() {}
 
+  const size_t CommandLineError::noPosition;
+
   CommandLineError::CommandLineError(CommandLineErrorCode code, const std::string& message)
-    :_code(code), _message(message) {}
+    :_code(code), _message(message), _position(noPosition) {}
+
+  CommandLineError::CommandLineError(CommandLineErrorCode code, const std::string& message, size_t position)
+    :_code(code), _message(message), _position(position) {}
   
   const char* CommandLineError::what() const noexcept { return _message.c_str(); }
 
   CommandLineErrorCode CommandLineError::code() const { return _code; }
+
+  size_t CommandLineError::position() const { return _position; }
+
+  static std::string joinMessages(const std::vector<CommandLineError>& errors) {
+    std::string message;
+    for (const CommandLineError& error : errors) {
+      if (!message.empty()) message += "\n";
+      message += error.what();
+    }
+    return message;
+  }
+
+  CommandLineConstraintError::CommandLineConstraintError(const std::vector<CommandLineError>& violations)
+    :CommandLineError(violations.empty() ? VALUE_REQUIRED : violations[0].code(), joinMessages(violations)), _violations(violations) {}
+
+  const std::vector<CommandLineError>& CommandLineConstraintError::violations() const { return _violations; }
 }
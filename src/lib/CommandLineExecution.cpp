@@ -0,0 +1,84 @@
+#include "commandline/CommandLineExecution.hpp"
+#include "commandline/CommandLineError.hpp"
+
+namespace commandline {
+
+CommandLineCancellationToken::CommandLineCancellationToken(): _reason(NotCancelled), _mutex(), _cv() {}
+
+bool CommandLineCancellationToken::isCancellationRequested() const {
+  return this->_reason.load() != NotCancelled;
+}
+
+CommandLineCancellationReason CommandLineCancellationToken::reason() const {
+  return static_cast<CommandLineCancellationReason>(this->_reason.load());
+}
+
+void CommandLineCancellationToken::cancel(CommandLineCancellationReason reason) {
+  int expected = NotCancelled;
+  if (reason == NotCancelled || !this->_reason.compare_exchange_strong(expected, reason)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(this->_mutex);
+  this->_cv.notify_all();
+}
+
+bool CommandLineCancellationToken::waitFor(std::chrono::nanoseconds timeout) const {
+  std::unique_lock<std::mutex> lock(this->_mutex);
+  return this->_cv.wait_for(lock, timeout, [this]() { return this->isCancellationRequested(); });
+}
+
+void CommandLineCancellationToken::throwIfCancellationRequested() const {
+  switch (this->reason()) {
+    case NotCancelled:
+      return;
+    case Deadline:
+      throw CommandLineError(EXECUTION_TIMEOUT, "The action did not complete before its timeout");
+    default:
+      throw CommandLineError(EXECUTION_CANCELLED, "The action was cancelled");
+  }
+}
+
+CommandLineExecutor::~CommandLineExecutor() {}
+
+CommandLineEventLoop::CommandLineEventLoop(): _mutex(), _cv(), _tasks() {}
+
+CommandLineEventLoop::~CommandLineEventLoop() {}
+
+void CommandLineEventLoop::post(std::function<void()> task) {
+  {
+    std::lock_guard<std::mutex> lock(this->_mutex);
+    this->_tasks.push_back(std::move(task));
+  }
+  this->_cv.notify_one();
+}
+
+bool CommandLineEventLoop::runOne(std::chrono::nanoseconds timeout) {
+  std::function<void()> task;
+  {
+    std::unique_lock<std::mutex> lock(this->_mutex);
+    if (!this->_cv.wait_for(lock, timeout, [this]() { return !this->_tasks.empty(); })) {
+      return false;
+    }
+    task = std::move(this->_tasks.front());
+    this->_tasks.pop_front();
+  }
+  task();
+  return true;
+}
+
+void CommandLineEventLoop::drain() {
+  while (this->runOne(std::chrono::nanoseconds::zero())) {}
+}
+
+CommandLineExecutionContext::CommandLineExecutionContext(const CommandLineCancellationToken& token, CommandLineExecutor& executor):
+  _token(token), _executor(executor) {}
+
+const CommandLineCancellationToken& CommandLineExecutionContext::token() const {
+  return this->_token;
+}
+
+CommandLineExecutor& CommandLineExecutionContext::executor() const {
+  return this->_executor;
+}
+
+}
@@ -15,32 +15,33 @@ namespace commandline {
   }
 
   void CommandLineFlagParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
     if (this->environmentVariable != "") {
-      auto env = commandline::env();
       std::string environmentValue;
-      if (env.find(this->environmentVariable) != env.end() && (environmentValue = env.at(this->environmentVariable)) != "") {
+      if (commandline::getEnv(this->environmentVariable, environmentValue) && environmentValue != "") {
         if (environmentValue != "0" && environmentValue != "1") {
           throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". Valid choices are: 0 or 1");
         }
-        this->_value = environmentValue == "1";
+        this->_value.get() = environmentValue == "1";
+        this->_valueSource = CommandLineValueSource::Environment;
         return;
       }
     }
 
-    this->_value = this->defaultValue;
+    this->_value.get() = this->defaultValue;
   }
 
   void CommandLineFlagParameter::_setValue(bool data) {
-    this->_value = data;
+    this->_value.get() = data;
   }
   void CommandLineFlagParameter::_setValue(int64_t data) {
     reportInvalidData(data);
   }
   void CommandLineFlagParameter::_setValue(const std::string& data) {
     if (data == "true" || data == "1") {
-      this->_value = true;
+      this->_value.get() = true;
     } else if (data == "false" || data == "0") {
-      this->_value = false;
+      this->_value.get() = false;
     } else {
       reportInvalidData(data);
     }
@@ -56,12 +57,18 @@ namespace commandline {
   }
 
   void CommandLineFlagParameter::appendToArgList(std::vector<std::string>& argList) const {
-    if (this->_value) {
+    if (this->value()) {
       argList.push_back(this->longName);
     }
   }
 
   bool CommandLineFlagParameter::value() const {
-    return this->_value;
+    this->_resolve();
+    return this->_value.get();
+  }
+
+  void CommandLineFlagParameter::bind(bool& target) {
+    this->_value.bind(target);
+    this->_bound = true;
   }
 }
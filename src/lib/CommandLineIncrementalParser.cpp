@@ -0,0 +1,361 @@
+#include <algorithm>
+#include <cstdlib>
+
+#include "commandline/CommandLineIncrementalParser.hpp"
+#include "ValueParser.hpp"
+#include "TokenClassifier.hpp"
+#include "ArgumentScanner.hpp"
+
+namespace commandline {
+
+static bool isBooleanLiteral(const std::string& text) {
+  return text == "true" || text == "false" || text == "1" || text == "0";
+}
+
+static void setError(CommandLineToken& token, CommandLineErrorCode code, const std::string& message) {
+  token.errorCode = code;
+  token.errorMessage = message;
+}
+
+// Mirrors the checks done by the _setValue() overloads, without touching the parameter.
+static void validateValue(const CommandLineParameter* parameter, const std::string& value, CommandLineToken& token) {
+  size_t errorOffset = 0;
+  const char* error = nullptr;
+  bool inRange = true;
+  switch (parameter->kind()) {
+    case CommandLineParameterKind::Flag:
+      if (!isBooleanLiteral(value)) error = "expected true or false";
+      break;
+    case CommandLineParameterKind::Integer: {
+      char* end = nullptr;
+      std::strtoll(value.c_str(), &end, 10);
+      if (value.empty() || *end != '\0') error = "expected an integer";
+      break;
+    }
+    case CommandLineParameterKind::Choice:
+      if (static_cast<const CommandLineChoiceParameter*>(parameter)->indexOf(value) < 0) error = "not one of the alternatives";
+      break;
+    case CommandLineParameterKind::Double: {
+      const CommandLineDoubleParameter* p = static_cast<const CommandLineDoubleParameter*>(parameter);
+      double v = 0;
+      error = value::parseDouble(value, v, errorOffset);
+      inRange = v >= p->minimum && v <= p->maximum;
+      break;
+    }
+    case CommandLineParameterKind::Unsigned: {
+      const CommandLineUnsignedParameter* p = static_cast<const CommandLineUnsignedParameter*>(parameter);
+      uint64_t v = 0;
+      error = value::parseUnsigned(value, v, errorOffset);
+      inRange = v >= p->minimum && v <= p->maximum;
+      break;
+    }
+    case CommandLineParameterKind::ByteSize: {
+      const CommandLineByteSizeParameter* p = static_cast<const CommandLineByteSizeParameter*>(parameter);
+      uint64_t v = 0;
+      error = value::parseByteSize(value, v, errorOffset);
+      inRange = v >= p->minimum && v <= p->maximum;
+      break;
+    }
+    case CommandLineParameterKind::Duration: {
+      const CommandLineDurationParameter* p = static_cast<const CommandLineDurationParameter*>(parameter);
+      int64_t v = 0;
+      error = value::parseDuration(value, v, errorOffset);
+      inRange = v >= p->minimum.count() && v <= p->maximum.count();
+      break;
+    }
+    case CommandLineParameterKind::String:
+      if (!static_cast<const CommandLineStringParameter*>(parameter)->matchesPattern(value)) error = "does not match the pattern";
+      break;
+    case CommandLineParameterKind::StringList:
+      if (!static_cast<const CommandLineStringListParameter*>(parameter)->matchesPattern(value)) error = "does not match the pattern";
+      break;
+    default:
+      break;
+  }
+  if (error != nullptr) {
+    setError(token, INVALID_VALUE, "Invalid value \"" + value + "\" for " + parameter->longName + ": " + error);
+  } else if (!inRange) {
+    setError(token, VALUE_OUT_OF_RANGE, "The value \"" + value + "\" for " + parameter->longName + " is out of range");
+  }
+}
+
+static void addCandidate(std::vector<std::string>& candidates, const std::string& candidate, const std::string& prefix) {
+  if (!candidate.empty() && candidate.compare(0, prefix.size(), prefix) == 0) {
+    candidates.push_back(candidate);
+  }
+}
+
+bool CommandLineIncrementalParser::_State::operator==(const _State& other) const {
+  return action == other.action && pending == other.pending && phase == other.phase;
+}
+
+bool CommandLineIncrementalParser::_State::operator!=(const _State& other) const {
+  return !(*this == other);
+}
+
+CommandLineIncrementalParser::CommandLineIncrementalParser(const CommandLineParser& parser): _parser(&parser) {
+  // The same name tables as execute() uses: global options are accepted after
+  // the action name too, and abbreviations follow the parser's options
+  parser._freezeScope(nullptr);
+  for (const CommandLineAction* action : parser.actions()) {
+    action->_freezeScope(&parser);
+    this->_actionsByName[action->actionName] = action;
+  }
+  this->reset({});
+}
+
+const CommandLineParameter* CommandLineIncrementalParser::_lookup(const CommandLineAction* action, const std::string& name) const {
+  const CommandLineParameterProvider* scope = action != nullptr ? static_cast<const CommandLineParameterProvider*>(action) : this->_parser;
+  return scope->_lookupInScope(name);
+}
+
+bool CommandLineIncrementalParser::_acceptsValue(const CommandLineParameter* parameter, size_t tokenIndex) const {
+  if (tokenIndex >= this->_tokens.size()) {
+    return false;
+  }
+  const std::string& text = this->_tokens[tokenIndex].text;
+  uint32_t valueOffset;
+  return scan::takesValue(scan::arityOf(parameter), token::classify(text, valueOffset), text);
+}
+
+// The result depends only on the incoming state, the token and the token after
+// it, which bounds how far an edit can propagate.
+CommandLineIncrementalParser::_State CommandLineIncrementalParser::_classify(const _State& in, size_t tokenIndex, CommandLineToken& current) const {
+  const std::string& text = current.text;
+  _State out = in;
+  current.kind = CommandLineTokenKind::Ignored;
+  current.action = in.action;
+  current.parameter = nullptr;
+  current.valueOffset = 0;
+  current.errorMessage.clear();
+
+  if (in.phase == _Phase::Remainder) {
+    current.kind = CommandLineTokenKind::Remainder;
+    return out;
+  }
+  if (in.phase == _Phase::Stopped) {
+    return out;
+  }
+  if (in.pending != nullptr) {
+    current.kind = CommandLineTokenKind::Value;
+    current.parameter = in.pending;
+    validateValue(in.pending, text, current);
+    out.pending = nullptr;
+    return out;
+  }
+  if (text == "-h" || text == "--help") {
+    // Like execute(), which shows the help without looking further
+    current.kind = CommandLineTokenKind::Help;
+    out.phase = _Phase::Stopped;
+    return out;
+  }
+
+  uint32_t valueOffset = 0;
+  token::Kind kind = token::classify(text, valueOffset);
+  if (kind == token::LongOption || kind == token::LongOptionWithValue || token::isShort(kind)) {
+    current.kind = CommandLineTokenKind::Option;
+    std::string name;
+    if (kind == token::LongOption) {
+      name = text;
+    } else if (kind == token::LongOptionWithValue) {
+      name = text.substr(0, valueOffset - 1);
+    } else {
+      name = text.substr(0, 2);
+      valueOffset = text.length() > 2 ? 2 : 0;
+    }
+    const CommandLineParameter* parameter = this->_lookup(in.action, name);
+    if (parameter == nullptr) {
+      setError(current, PARAMETER_UNDEFINED, "The parameter \"" + name + "\" is not defined");
+      return out;
+    }
+    current.parameter = parameter;
+    if (valueOffset != 0) {
+      current.valueOffset = valueOffset;
+      validateValue(parameter, text.substr(valueOffset), current);
+    } else if (this->_acceptsValue(parameter, tokenIndex + 1)) {
+      out.pending = parameter;
+    } else if (parameter->kind() != CommandLineParameterKind::Flag) {
+      setError(current, VALUE_REQUIRED, "Missing value for " + parameter->longName);
+    }
+    return out;
+  }
+
+  if (in.action == nullptr && this->_actionsByName.size() > 0) {
+    std::unordered_map<std::string, const CommandLineAction*>::const_iterator it = this->_actionsByName.find(text);
+    if (it == this->_actionsByName.end()) {
+      setError(current, ACTION_UNDEFINED, "Unrecognized action \"" + text + "\"");
+      out.phase = _Phase::Stopped;
+    } else {
+      current.kind = CommandLineTokenKind::Action;
+      out.action = it->second;
+    }
+    return out;
+  }
+
+  const CommandLineRemainder* remainder = in.action == nullptr ? this->_parser->remainder() : in.action->remainder();
+  if (remainder != nullptr) {
+    current.kind = CommandLineTokenKind::Remainder;
+    out.phase = _Phase::Remainder;
+  } else {
+    out.phase = _Phase::Stopped;
+  }
+  return out;
+}
+
+void CommandLineIncrementalParser::_count(const CommandLineToken& token, int delta) {
+  if (token.kind == CommandLineTokenKind::Option && token.parameter != nullptr) {
+    this->_occurrences[token.parameter] += delta;
+  } else if (token.kind == CommandLineTokenKind::Help) {
+    this->_occurrences[nullptr] += delta;
+  }
+}
+
+void CommandLineIncrementalParser::reset(const std::vector<std::string>& tokens) {
+  this->_tokens.clear();
+  this->_states.clear();
+  this->_occurrences.clear();
+  this->_states.push_back(_State{ nullptr, nullptr, _Phase::Options });
+  CommandLineEdit edit;
+  edit.position = 0;
+  edit.removeCount = 0;
+  edit.inserted = tokens;
+  this->apply(edit);
+}
+
+CommandLineReparseRange CommandLineIncrementalParser::apply(const CommandLineEdit& edit) {
+  size_t size = this->_tokens.size();
+  if (edit.position > size || edit.removeCount > size - edit.position) {
+    throw CommandLineError(EDIT_INVALID, "The edit does not fit the " + std::to_string(size) + " current tokens");
+  }
+  size_t position = edit.position;
+  size_t inserted = edit.inserted.size();
+
+  for (size_t i = position; i < position + edit.removeCount; i++) {
+    this->_count(this->_tokens[i], -1);
+  }
+  this->_tokens.erase(this->_tokens.begin() + position, this->_tokens.begin() + position + edit.removeCount);
+  CommandLineToken blank{ "", CommandLineTokenKind::Ignored, nullptr, nullptr, 0, INVALID_VALUE, "" };
+  this->_tokens.insert(this->_tokens.begin() + position, inserted, blank);
+  for (size_t i = 0; i < inserted; i++) {
+    this->_tokens[position + i].text = edit.inserted[i];
+  }
+
+  // Keep the old state in front of the first token after the edit, so that
+  // reclassification can stop as soon as it produces that state again.
+  this->_states.erase(this->_states.begin() + position, this->_states.begin() + position + edit.removeCount);
+  this->_states.insert(this->_states.begin() + position, inserted, _State{ nullptr, nullptr, _Phase::Options });
+
+  // The token in front of the edit may consume the first edited token as its value
+  size_t first = position > 0 ? position - 1 : 0;
+  if (first == 0) {
+    this->_states[0] = _State{ nullptr, nullptr, _Phase::Options };
+  }
+  size_t editEnd = position + inserted;
+  size_t i = first;
+  while (i < this->_tokens.size()) {
+    CommandLineToken& token = this->_tokens[i];
+    this->_count(token, -1);
+    _State next = this->_classify(this->_states[i], i, token);
+    this->_count(token, 1);
+    i++;
+    if (i >= editEnd && this->_states[i] == next) {
+      break;
+    }
+    this->_states[i] = next;
+  }
+  return CommandLineReparseRange{ first, i - first };
+}
+
+const std::vector<CommandLineToken>& CommandLineIncrementalParser::tokens() const {
+  return this->_tokens;
+}
+
+const CommandLineAction* CommandLineIncrementalParser::selectedAction() const {
+  return this->_states.back().action;
+}
+
+std::vector<CommandLineDiagnostic> CommandLineIncrementalParser::diagnostics() const {
+  std::vector<CommandLineDiagnostic> result;
+  for (size_t i = 0; i < this->_tokens.size(); i++) {
+    const CommandLineToken& token = this->_tokens[i];
+    if (!token.errorMessage.empty()) {
+      result.push_back(CommandLineDiagnostic{ i, token.errorCode, token.errorMessage });
+    }
+  }
+
+  // execute() only prints the help when -h or --help is given
+  std::unordered_map<const CommandLineParameter*, int>::const_iterator help = this->_occurrences.find(nullptr);
+  if (help != this->_occurrences.end() && help->second > 0) {
+    return result;
+  }
+  std::vector<const CommandLineParameterProvider*> scopes = { this->_parser };
+  if (this->selectedAction() != nullptr) {
+    scopes.push_back(this->selectedAction());
+  }
+  for (const CommandLineParameterProvider* scope : scopes) {
+    for (const CommandLineParameter* p : scope->parameters()) {
+      if (!p->required) continue;
+      std::unordered_map<const CommandLineParameter*, int>::const_iterator it = this->_occurrences.find(p);
+      if (it == this->_occurrences.end() || it->second == 0) {
+        result.push_back(CommandLineDiagnostic{ std::string::npos, VALUE_REQUIRED, "Required: " + p->longName });
+      }
+    }
+  }
+  return result;
+}
+
+CommandLineCompletionContext CommandLineIncrementalParser::completion(size_t tokenIndex) const {
+  if (tokenIndex > this->_tokens.size()) {
+    throw CommandLineError(EDIT_INVALID, "Token index " + std::to_string(tokenIndex) + " is out of range");
+  }
+  const _State& state = this->_states[tokenIndex];
+  const std::string prefix = tokenIndex < this->_tokens.size() ? this->_tokens[tokenIndex].text : "";
+  CommandLineCompletionContext context{ CommandLineCompletionKind::None, state.action, nullptr, {} };
+
+  const CommandLineParameter* valueOf = state.pending;
+  if (valueOf == nullptr && tokenIndex > 0 && (prefix.empty() || prefix[0] != '-') && state.phase == _Phase::Options) {
+    // "--name" at the end of the line has no pending state yet
+    const CommandLineToken& previous = this->_tokens[tokenIndex - 1];
+    if (previous.kind == CommandLineTokenKind::Option && previous.parameter != nullptr && previous.valueOffset == 0 &&
+      previous.parameter->kind() != CommandLineParameterKind::Flag) {
+      valueOf = previous.parameter;
+    }
+  }
+
+  if (state.phase == _Phase::Remainder) {
+    context.kind = CommandLineCompletionKind::Remainder;
+  } else if (state.phase == _Phase::Stopped) {
+    context.kind = CommandLineCompletionKind::None;
+  } else if (valueOf != nullptr) {
+    context.kind = CommandLineCompletionKind::ParameterValue;
+    context.parameter = valueOf;
+    if (valueOf->kind() == CommandLineParameterKind::Choice) {
+      for (const std::string& alternative : static_cast<const CommandLineChoiceParameter*>(valueOf)->alternatives) {
+        addCandidate(context.candidates, alternative, prefix);
+      }
+    } else if (valueOf->kind() == CommandLineParameterKind::Flag) {
+      addCandidate(context.candidates, "true", prefix);
+      addCandidate(context.candidates, "false", prefix);
+    }
+  } else if (prefix.length() > 0 && prefix[0] == '-') {
+    context.kind = CommandLineCompletionKind::ParameterName;
+    const CommandLineParameterProvider* scope = state.action == nullptr ?
+      static_cast<const CommandLineParameterProvider*>(this->_parser) : state.action;
+    for (const CommandLineParameter* p : scope->parameters()) {
+      addCandidate(context.candidates, p->longName, prefix);
+      addCandidate(context.candidates, p->shortName, prefix);
+    }
+    addCandidate(context.candidates, "--help", prefix);
+  } else if (state.action == nullptr && this->_actionsByName.size() > 0) {
+    context.kind = CommandLineCompletionKind::ActionName;
+    for (const CommandLineAction* action : this->_parser->actions()) {
+      addCandidate(context.candidates, action->actionName, prefix);
+    }
+  } else if ((state.action == nullptr ? this->_parser->remainder() : state.action->remainder()) != nullptr) {
+    context.kind = CommandLineCompletionKind::Remainder;
+  }
+  std::sort(context.candidates.begin(), context.candidates.end());
+  return context;
+}
+
+}
@@ -18,10 +18,10 @@ namespace commandline {
   }
 
   void CommandLineIntegerParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
     if (this->environmentVariable != "") {
-      auto env = commandline::env();
       std::string environmentValue;
-      if (env.find(this->environmentVariable) != env.end() && (environmentValue = env.at(this->environmentVariable)) != "") {
+      if (commandline::getEnv(this->environmentVariable, environmentValue) && environmentValue != "") {
         int64_t parsed;
         if (environmentValue == "0") {
           parsed = 0;
@@ -31,27 +31,28 @@ namespace commandline {
             throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". It must be an integer value.");
           }
         }
-        this->_value = parsed;
+        this->_value.get() = parsed;
+        this->_valueSource = CommandLineValueSource::Environment;
         return;
       }
     }
 
     if (this->defaultValue != 0) {
-      this->_value = this->defaultValue;
+      this->_value.get() = this->defaultValue;
       return;
     }
 
-    this->_value = 0;
+    this->_value.get() = 0;
   }
   void CommandLineIntegerParameter::_setValue(bool data) {
     reportInvalidData(data);
   }
   void CommandLineIntegerParameter::_setValue(int64_t data) {
-    this->_value = data;
+    this->_value.get() = data;
   }
   void CommandLineIntegerParameter::_setValue(const std::string& data) {
     if (data == "0") {
-      this->_value = 0;
+      this->_value.get() = 0;
       return;
     }
     
@@ -59,7 +60,7 @@ namespace commandline {
     if (v == 0) {
       reportInvalidData(data);
     } else {
-      this->_value = v;
+      this->_value.get() = v;
     }
   }
   void CommandLineIntegerParameter::_setValue(const std::vector<std::string>& data) {
@@ -74,10 +75,16 @@ namespace commandline {
 
   void CommandLineIntegerParameter::appendToArgList(std::vector<std::string>& argList) const {
     argList.push_back(this->longName);
-    argList.push_back(std::to_string(this->_value));
+    argList.push_back(std::to_string(this->value()));
   }
 
   int64_t CommandLineIntegerParameter::value() const {
-    return this->_value;
+    this->_resolve();
+    return this->_value.get();
+  }
+
+  void CommandLineIntegerParameter::bind(int64_t& target) {
+    this->_value.bind(target);
+    this->_bound = true;
   }
 }
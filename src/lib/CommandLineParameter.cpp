@@ -6,7 +6,12 @@
 namespace commandline {
   CommandLineParameter::CommandLineParameter(const BaseCommandLineDefinition& definition):
     _hasValue(false),
+    _resolved(false),
+    _converted(false),
+    _converter(),
+    _bound(false),
     // _parserKey(""),
+    _valueSource(CommandLineValueSource::Default),
     longName(definition.parameterLongName),
     shortName(definition.parameterShortName),
     description(definition.description),
@@ -94,5 +99,40 @@ namespace commandline {
   }
   void CommandLineParameter::setHasValue() {
     this->_hasValue = true;
+    this->_resolved = true;
+    this->_valueSource = CommandLineValueSource::CommandLine;
+  }
+  void CommandLineParameter::_reset() {
+    this->_hasValue = false;
+    this->_resolved = false;
+    this->_converted = false;
+  }
+  void CommandLineParameter::_resolve() const {
+    if (this->_resolved) {
+      return;
+    }
+    if (!this->required) {
+      // Parameters are only ever created by a provider, never as const objects
+      const_cast<CommandLineParameter*>(this)->_setValue();
+    }
+    this->_resolved = true;
+  }
+  CommandLineValueSource CommandLineParameter::valueSource() const {
+    this->_resolve();
+    return this->_valueSource;
+  }
+  void CommandLineParameter::bindConverter(const std::function<void(const CommandLineParameter&)>& converter) {
+    this->_converter = converter;
+  }
+  bool CommandLineParameter::isBound() const {
+    return this->_bound || this->_converter;
+  }
+  void CommandLineParameter::_applyBinding() {
+    this->_resolve();
+    // A parameter shared by the parser and the action is applied by whichever scope ends first
+    if (this->_converter && !this->_converted) {
+      this->_converted = true;
+      this->_converter(*this);
+    }
   }
 }
@@ -1,6 +1,13 @@
+#include <algorithm>
+
 #include "commandline/CommandLineParameterProvider.hpp"
+#include "commandline/CommandLineParameterSet.hpp"
 #include "commandline/CommandLineError.hpp"
 #include "StringUtil.hpp"
+#include "ValueParser.hpp"
+#include "TokenClassifier.hpp"
+#include "ArgumentScanner.hpp"
+#include "Suggestion.hpp"
 
 namespace commandline {
 
@@ -8,14 +15,53 @@ CommandLineParameterProvider::CommandLineParameterProvider():
   _parameters(),
   _parametersByLongName(),
   _parametersByShortName(),
-  _remainder(nullptr) {}
+  _parameterSets(),
+  _attached(false),
+  _scope(),
+  _scopeNames(),
+  _scopeLongNames(),
+  _scopeOuter(nullptr),
+  _scopeSize(0),
+  _revision(0),
+  _remainder(nullptr),
+  _allowAbbreviations(false) {}
 
 CommandLineParameterProvider::~CommandLineParameterProvider() {
   if (_remainder != nullptr) {
     delete _remainder;
   }
   for (CommandLineParameter* p : this->_parameters) {
-    delete p;
+    if (this->_ownsParameter(p)) {
+      delete p;
+    }
+  }
+}
+
+bool CommandLineParameterProvider::_ownsParameter(const CommandLineParameter* parameter) const {
+  std::map<std::string, CommandLineParameter*>::const_iterator it = this->_parametersByLongName.find(parameter->longName);
+  return it != this->_parametersByLongName.end() && it->second == parameter;
+}
+
+void CommandLineParameterProvider::attachParameterSet(const std::shared_ptr<CommandLineParameterSet>& parameterSet) {
+  if (this->_remainder) {
+    throw CommandLineError(REMAINDER_DEFINED, "defineCommandLineRemainder() was already called for this provider; no further parameters can be attached");
+  }
+  CommandLineParameterProvider* shared = parameterSet.get();
+  for (const CommandLineParameter* p : shared->_parameters) {
+    this->_checkNames(p, this);
+  }
+  shared->_attached = true;
+  this->_parameterSets.push_back(parameterSet);
+  this->_parameters.insert(this->_parameters.end(), shared->_parameters.begin(), shared->_parameters.end());
+}
+
+// Throws if a name of parameter already resolves in scope
+void CommandLineParameterProvider::_checkNames(const CommandLineParameter* parameter, const CommandLineParameterProvider* scope) const {
+  const std::string* names[] = { &parameter->longName, &parameter->shortName };
+  for (const std::string* name : names) {
+    if (!name->empty() && scope->_tryGetParameter(*name) != nullptr) {
+      throw CommandLineError(PARAMETER_NAME_CONFLICT, "The parameter name \"" + *name + "\" is already in use in this scope");
+    }
   }
 }
 
@@ -27,6 +73,10 @@ const CommandLineRemainder* CommandLineParameterProvider::remainder() const {
   return this->_remainder;
 }
 
+uint64_t CommandLineParameterProvider::revision() const {
+  return this->_revision;
+}
+
 const CommandLineRemainder* CommandLineParameterProvider::defineCommandLineRemainder(const CommandLineRemainderDefinition& definition) {
   if (this->_remainder != nullptr) {
     throw CommandLineError(REMAINDER_DEFINED, "defineRemainingArguments() has already been called for this provider");
@@ -66,6 +116,46 @@ const CommandLineIntegerParameter* CommandLineParameterProvider::getIntegerParam
   return static_cast<const CommandLineIntegerParameter*>(this->_getParameter(parameterName, CommandLineParameterKind::Integer));
 }
 
+CommandLineDoubleParameter* CommandLineParameterProvider::defineDoubleParameter(const CommandLineDoubleDefinition& definition) {
+  CommandLineDoubleParameter* parameter = new CommandLineDoubleParameter(definition);
+  this->_defineParameter(parameter);
+  return parameter;
+}
+
+const CommandLineDoubleParameter* CommandLineParameterProvider::getDoubleParameter(const std::string& parameterName) const {
+  return static_cast<const CommandLineDoubleParameter*>(this->_getParameter(parameterName, CommandLineParameterKind::Double));
+}
+
+CommandLineUnsignedParameter* CommandLineParameterProvider::defineUnsignedParameter(const CommandLineUnsignedDefinition& definition) {
+  CommandLineUnsignedParameter* parameter = new CommandLineUnsignedParameter(definition);
+  this->_defineParameter(parameter);
+  return parameter;
+}
+
+const CommandLineUnsignedParameter* CommandLineParameterProvider::getUnsignedParameter(const std::string& parameterName) const {
+  return static_cast<const CommandLineUnsignedParameter*>(this->_getParameter(parameterName, CommandLineParameterKind::Unsigned));
+}
+
+CommandLineByteSizeParameter* CommandLineParameterProvider::defineByteSizeParameter(const CommandLineByteSizeDefinition& definition) {
+  CommandLineByteSizeParameter* parameter = new CommandLineByteSizeParameter(definition);
+  this->_defineParameter(parameter);
+  return parameter;
+}
+
+const CommandLineByteSizeParameter* CommandLineParameterProvider::getByteSizeParameter(const std::string& parameterName) const {
+  return static_cast<const CommandLineByteSizeParameter*>(this->_getParameter(parameterName, CommandLineParameterKind::ByteSize));
+}
+
+CommandLineDurationParameter* CommandLineParameterProvider::defineDurationParameter(const CommandLineDurationDefinition& definition) {
+  CommandLineDurationParameter* parameter = new CommandLineDurationParameter(definition);
+  this->_defineParameter(parameter);
+  return parameter;
+}
+
+const CommandLineDurationParameter* CommandLineParameterProvider::getDurationParameter(const std::string& parameterName) const {
+  return static_cast<const CommandLineDurationParameter*>(this->_getParameter(parameterName, CommandLineParameterKind::Duration));
+}
+
 CommandLineStringParameter* CommandLineParameterProvider::defineStringParameter(const CommandLineStringDefinition& definition) {
   CommandLineStringParameter* parameter = new CommandLineStringParameter(definition);
   this->_defineParameter(parameter);
@@ -85,15 +175,21 @@ const CommandLineStringListParameter* CommandLineParameterProvider::getStringLis
 }
 
 CommandLineParameter* CommandLineParameterProvider::_tryGetParameter(const std::string& parameterName) const {
-  if (this->_parametersByLongName.find(parameterName) == this->_parametersByLongName.end()) {
-    if (this->_parametersByShortName.find(parameterName) == this->_parametersByShortName.end()) {
-      return nullptr;
-    } else {
-      return this->_parametersByShortName.at(parameterName);
+  std::map<std::string, CommandLineParameter*>::const_iterator it = this->_parametersByLongName.find(parameterName);
+  if (it != this->_parametersByLongName.end()) {
+    return it->second;
+  }
+  it = this->_parametersByShortName.find(parameterName);
+  if (it != this->_parametersByShortName.end()) {
+    return it->second;
+  }
+  for (const std::shared_ptr<CommandLineParameterSet>& parameterSet : this->_parameterSets) {
+    CommandLineParameter* parameter = static_cast<const CommandLineParameterProvider*>(parameterSet.get())->_tryGetParameter(parameterName);
+    if (parameter != nullptr) {
+      return parameter;
     }
-  } else {
-    return this->_parametersByLongName.at(parameterName);
   }
+  return nullptr;
 }
 
 CommandLineParameter* CommandLineParameterProvider::_getParameter(const std::string& parameterName) const {
@@ -119,7 +215,11 @@ std::string CommandLineParameterProvider::_kindToString(CommandLineParameterKind
     "Flag",
     "Integer",
     "String",
-    "StringList"
+    "StringList",
+    "Double",
+    "Unsigned",
+    "ByteSize",
+    "Duration"
   };
   return list[kind];
 }
@@ -137,6 +237,17 @@ void CommandLineParameterProvider::_defineParameter(CommandLineParameter* parame
   if (this->_remainder) {
     throw CommandLineError(REMAINDER_DEFINED, "defineCommandLineRemainder() was already called for this provider; no further parameters can be defined");
   }
+  try {
+    if (this->_attached) {
+      throw CommandLineError(PARAMETER_SET_ATTACHED, "The parameter set was already attached; no further parameters can be defined");
+    }
+    for (const std::shared_ptr<CommandLineParameterSet>& parameterSet : this->_parameterSets) {
+      this->_checkNames(parameter, parameterSet.get());
+    }
+  } catch (...) {
+    delete parameter;
+    throw;
+  }
   this->_parameters.push_back(parameter);
   this->_parametersByLongName[parameter->longName] = parameter;
   if (parameter->shortName != "") {
@@ -144,6 +255,40 @@ void CommandLineParameterProvider::_defineParameter(CommandLineParameter* parame
   }
 }
 
+size_t CommandLineParameterProvider::_idOf(const std::string& parameterName) const {
+  const CommandLineParameter* parameter = this->_getParameter(parameterName);
+  return static_cast<size_t>(std::find(this->_parameters.begin(), this->_parameters.end(), parameter) - this->_parameters.begin());
+}
+
+std::vector<size_t> CommandLineParameterProvider::_idsOf(const std::vector<std::string>& parameterNames) const {
+  std::vector<size_t> ids;
+  for (const std::string& name : parameterNames) {
+    ids.push_back(this->_idOf(name));
+  }
+  return ids;
+}
+
+void CommandLineParameterProvider::defineMutuallyExclusive(const std::vector<std::string>& parameterNames) {
+  this->_constraints.addMutuallyExclusive(this->_idsOf(parameterNames));
+}
+
+void CommandLineParameterProvider::defineRequires(const std::string& parameterName, const std::vector<std::string>& requiredNames) {
+  this->_constraints.addRequires(this->_idOf(parameterName), this->_idsOf(requiredNames));
+}
+
+void CommandLineParameterProvider::defineAtLeastOneOf(const std::vector<std::string>& parameterNames) {
+  this->_constraints.addAtLeastOneOf(this->_idsOf(parameterNames));
+}
+
+void CommandLineParameterProvider::defineRequiredWhen(const std::string& choiceName, const std::string& alternative, const std::vector<std::string>& requiredNames) {
+  const CommandLineChoiceParameter* choice = this->getChoiceParameter(choiceName);
+  int index = choice->indexOf(alternative);
+  if (index < 0) {
+    throw CommandLineError(INVALID_VALUE, "\"" + alternative + "\" is not an alternative of " + choice->longName);
+  }
+  this->_constraints.addRequiredWhen(this->_idOf(choiceName), static_cast<size_t>(index), this->_idsOf(requiredNames));
+}
+
 std::string CommandLineParameterProvider::_defaultValueToString(const CommandLineParameter* parameter) {
   CommandLineParameterKind kind = parameter->kind();
   switch (kind) {
@@ -157,111 +302,162 @@ std::string CommandLineParameterProvider::_defaultValueToString(const CommandLin
       return std::to_string(static_cast<const CommandLineIntegerParameter*>(parameter)->defaultValue);
     case CommandLineParameterKind::StringList:
       return "[]";
+    case CommandLineParameterKind::Double:
+      return commandline::value::formatDouble(static_cast<const CommandLineDoubleParameter*>(parameter)->defaultValue);
+    case CommandLineParameterKind::Unsigned:
+      return commandline::value::formatUnsigned(static_cast<const CommandLineUnsignedParameter*>(parameter)->defaultValue);
+    case CommandLineParameterKind::ByteSize:
+      return commandline::value::formatByteSize(static_cast<const CommandLineByteSizeParameter*>(parameter)->defaultValue);
+    case CommandLineParameterKind::Duration:
+      return commandline::value::formatDuration(static_cast<const CommandLineDurationParameter*>(parameter)->defaultValue.count());
     default:
       throw CommandLineError(PARAMETER_TYPE_UNKNOWN, "Unknown parameter kind");
   }
 }
 
-void CommandLineParameterProvider::_processArgs(const std::vector<std::string>& args) {
-  auto isInteger = [](const std::string& arg) -> bool {
-    std::regex re("^-?[1-9]\\d*$");
-    std::smatch sm;
-    return std::regex_match(arg, sm, re);
-  };
+void CommandLineParameterProvider::_beginArgs(const CommandLineParameterProvider* outer) {
+  this->_revision++;
+  // Environment and default values are resolved when first read
   for (CommandLineParameter* p : this->_parameters) {
-    if (!p->required) {
-      p->_setValue();
+    if (outer == nullptr || outer->_tryGetParameter(p->longName) != p) {
+      p->_reset();
     }
   }
-  size_t i = 0;
-  for (; i < args.size(); i++) {
-    const std::string& arg = args[i];
-    if (arg.length() > 2 && arg[0] == '-' && arg[1] == '-') { // --name
-      if (arg.find("=") != std::string::npos) {
-        std::vector<std::string> arr = commandline::string::split(arg, "=", -1);
-        const std::string& key = arr[0];
-        const std::string& value = arr[1];
-        CommandLineParameter* parameter = this->_getParameter(key);
-        parameter->_setValue(value);
-        parameter->setHasValue();
-      } else {
-        if (args.size() > i + 1 && ((args[i + 1].length() > 0 && args[i + 1][0] != '-') || isInteger(args[i + 1]))) {
-          CommandLineParameter* parameter = this->_getParameter(arg);
-          if (parameter->kind() == CommandLineParameterKind::Flag && this->_remainder != nullptr) {
-            parameter->_setValue(true);
-            parameter->setHasValue();
-          } else {
-            parameter->_setValue(args[i + 1]);
-            parameter->setHasValue();
-            i++;
-          }
-        } else {
-          CommandLineParameter* parameter = this->_getParameter(arg);
-          parameter->_setValue(true);
-          parameter->setHasValue();
-        }
+  this->_freezeScope(outer);
+}
+
+void CommandLineParameterProvider::_freezeScope(const CommandLineParameterProvider* outer) const {
+  // Parameters are never removed, so the counts tell whether the table is stale
+  size_t size = this->_parameters.size() + (outer != nullptr ? outer->_parameters.size() : 0);
+  if (!this->_scope.empty() && this->_scopeOuter == outer && this->_scopeSize == size) {
+    return;
+  }
+  this->_scope.clear();
+  this->_scope.reserve(size * 2);
+  this->_scopeNames.clear();
+  this->_scopeLongNames.clear();
+  bool abbreviations = outer != nullptr ? outer->_allowAbbreviations : this->_allowAbbreviations;
+  const CommandLineParameterProvider* scopes[] = { outer, this };
+  for (const CommandLineParameterProvider* scope : scopes) {
+    if (scope == nullptr) {
+      continue;
+    }
+    // The inner scope comes last and shadows outer names
+    for (CommandLineParameter* p : scope->_parameters) {
+      this->_scope[p->longName] = p;
+      this->_scopeNames.push_back(p->longName);
+      if (!p->shortName.empty()) {
+        this->_scope[p->shortName] = p;
+        this->_scopeNames.push_back(p->shortName);
       }
-    } else if (arg[0] == '-' && arg.length() > 1 && arg[1] != '-') { // -nxxx
-      if (arg.length() == 2) { // -n
-        // -s [nextArg]
-        if (args.size() > i + 1) {
-          const std::string& nextArg = args[i + 1];
-          if (nextArg != "") {
-            if (nextArg[0] != '-') {
-              CommandLineParameter* parameter = this->_getParameter(arg);
-              parameter->_setValue(nextArg);
-              parameter->setHasValue();
-              i++;
-            } else {
-              if (nextArg.length() > 1 && isInteger(nextArg)) {
-                CommandLineParameter* parameter = this->_getParameter(arg);
-                parameter->_setValue((int64_t)std::strtoll(nextArg.c_str(), nullptr, 10));
-                parameter->setHasValue();
-                i++;
-              } else {
-                CommandLineParameter* parameter = this->_getParameter(arg);
-                parameter->_setValue(true);
-                parameter->setHasValue();
-              }
-            }
-          } else {
-            CommandLineParameter* parameter = this->_getParameter(arg);
-            parameter->_setValue(true);
-            parameter->setHasValue();
-          }
-        } else {
-          CommandLineParameter* parameter = this->_getParameter(arg);
-          parameter->_setValue(true);
-          parameter->setHasValue();
-        }
-      } else {
-        // -a9000
-        const std::string shortname = arg.substr(0, 2);
-        const std::string value = arg.substr(2);
-        CommandLineParameter* parameter = this->_getParameter(shortname);
-        parameter->_setValue(value);
-        parameter->setHasValue();
+      if (abbreviations) {
+        this->_scopeLongNames.push_back(p->longName);
       }
-    } else {
-      break;
     }
   }
-  
+  std::sort(this->_scopeLongNames.begin(), this->_scopeLongNames.end());
+  this->_scopeLongNames.erase(std::unique(this->_scopeLongNames.begin(), this->_scopeLongNames.end()), this->_scopeLongNames.end());
+  this->_scopeOuter = outer;
+  this->_scopeSize = size;
+}
+
+CommandLineParameter* CommandLineParameterProvider::_lookupInScope(const std::string& name) const {
+  std::unordered_map<std::string, CommandLineParameter*>::const_iterator it = this->_scope.find(name);
+  if (it != this->_scope.end()) {
+    return it->second;
+  }
+  if (this->_scopeLongNames.empty() || name.size() <= 2 || name.compare(0, 2, "--") != 0) {
+    return nullptr;
+  }
+  // The first long name at or after the prefix; the one after it must not share the prefix
+  std::vector<std::string>::const_iterator match = std::lower_bound(this->_scopeLongNames.begin(), this->_scopeLongNames.end(), name);
+  if (match == this->_scopeLongNames.end() || match->compare(0, name.size(), name) != 0) {
+    return nullptr;
+  }
+  std::vector<std::string>::const_iterator next = match + 1;
+  if (next != this->_scopeLongNames.end() && next->compare(0, name.size(), name) == 0) {
+    return nullptr;
+  }
+  return this->_scope.find(*match)->second;
+}
+
+size_t CommandLineParameterProvider::_scanArgs(const std::vector<std::string>& args, const token::Classification& tokens, size_t begin, bool& help) {
+  scan::Result result = scan::run(args, tokens, begin, [this](const std::string& name) {
+    return this->_lookupInScope(name);
+  }, [this](const std::string& name) {
+    return suggest::nearest(name, this->_scopeNames);
+  });
+  help = result.help;
+  return result.stop;
+}
+
+void CommandLineParameterProvider::_endArgs(const std::vector<std::string>& args, size_t remainderBegin) {
   if (this->_remainder != nullptr) {
     std::vector<std::string> remain;
-    for (; i < args.size(); i++) {
-      remain.push_back(args[i]);
+    if (remainderBegin < args.size()) {
+      remain.assign(args.begin() + remainderBegin, args.end());
     }
     this->_remainder->_setValue(remain);
   }
 
+  this->_validateConstraints();
+
+  // Unbound parameters stay lazy; bound ones have to be written now
   for (CommandLineParameter* p : this->_parameters) {
-    if (p->required) {
-      if (!p->hasValue()) {
-        throw CommandLineError(VALUE_REQUIRED, std::string() + "Required: --" + p->longName + " " + (p->shortName != "" ? ("(-" + p->shortName + ") ") : " ") + "[" + _kindToString(p) + "]");
-      }
+    if (p->isBound()) {
+      p->_applyBinding();
+    }
+  }
+}
+
+void CommandLineParameterProvider::_processArgs(const std::vector<std::string>& args) {
+  token::Classification tokens;
+  token::classify(args, tokens);
+  bool help = false;
+  this->_beginArgs();
+  size_t stop = this->_scanArgs(args, tokens, 0, help);
+  this->_endArgs(args, stop);
+}
+
+static std::string joinNames(const std::vector<CommandLineParameter*>& parameters, const std::vector<size_t>& ids) {
+  std::string names;
+  for (size_t i = 0; i < ids.size(); i++) {
+    if (i > 0) names += i + 1 == ids.size() ? " and " : ", ";
+    names += parameters[ids[i]]->longName;
+  }
+  return names;
+}
+
+void CommandLineParameterProvider::_validateConstraints() {
+  std::vector<CommandLineConstraintViolation> violations;
+  this->_constraints.validate(this->_parameters, violations);
+  if (violations.empty()) {
+    return;
+  }
+
+  std::vector<CommandLineError> errors;
+  for (const CommandLineConstraintViolation& violation : violations) {
+    const CommandLineParameter* trigger = this->_parameters[violation.trigger];
+    std::string names = joinNames(this->_parameters, violation.ids);
+    switch (violation.kind) {
+      case CommandLineConstraintKind::Required:
+        errors.push_back(CommandLineError(VALUE_REQUIRED, std::string() + "Required: --" + trigger->longName + " " + (trigger->shortName != "" ? ("(-" + trigger->shortName + ") ") : " ") + "[" + _kindToString(trigger) + "]"));
+        break;
+      case CommandLineConstraintKind::MutuallyExclusive:
+        errors.push_back(CommandLineError(PARAMETERS_MUTUALLY_EXCLUSIVE, names + " cannot be used together"));
+        break;
+      case CommandLineConstraintKind::Requires:
+        errors.push_back(CommandLineError(PARAMETER_DEPENDENCY_MISSING, trigger->longName + " requires " + names));
+        break;
+      case CommandLineConstraintKind::AtLeastOneOf:
+        errors.push_back(CommandLineError(PARAMETER_GROUP_EMPTY, "One of " + names + " is required"));
+        break;
+      case CommandLineConstraintKind::RequiredWhen:
+        errors.push_back(CommandLineError(VALUE_REQUIRED, names + (violation.ids.size() > 1 ? " are" : " is") + " required when " + trigger->longName + " is " + static_cast<const CommandLineChoiceParameter*>(trigger)->value()));
+        break;
     }
   }
+  throw CommandLineConstraintError(errors);
 }
 
 }
@@ -0,0 +1,9 @@
+#include "commandline/CommandLineParameterSet.hpp"
+
+namespace commandline {
+
+CommandLineParameterSet::CommandLineParameterSet(): CommandLineParameterProvider() {}
+
+CommandLineParameterSet::~CommandLineParameterSet() {}
+
+}
@@ -1,11 +1,50 @@
 #include "commandline/CommandLineParser.hpp"
 #include "commandline/CommandLineError.hpp"
+#include "commandline/CommandLineTelemetry.hpp"
 #include "StringUtil.hpp"
+#include "TokenClassifier.hpp"
+#include "Suggestion.hpp"
+#include "HelpIndex.hpp"
+#include "ProcessUsage.hpp"
+#include <algorithm>
+#include <chrono>
 #include <cstddef>
+#include <csignal>
 #include <iostream>
+#include <memory>
 
 namespace commandline {
 
+static volatile std::sig_atomic_t receivedTerminationSignal = 0;
+
+static void onTerminationSignal(int signum) {
+  receivedTerminationSignal = signum;
+}
+
+class TerminationSignalGuard {
+ private:
+  bool _installed;
+  void (*_previousInt)(int);
+  void (*_previousTerm)(int);
+ public:
+  TerminationSignalGuard(bool install): _installed(install), _previousInt(SIG_DFL), _previousTerm(SIG_DFL) {
+    if (install) {
+      receivedTerminationSignal = 0;
+      _previousInt = std::signal(SIGINT, onTerminationSignal);
+      _previousTerm = std::signal(SIGTERM, onTerminationSignal);
+    }
+  }
+  ~TerminationSignalGuard() {
+    if (_installed) {
+      std::signal(SIGINT, _previousInt);
+      std::signal(SIGTERM, _previousTerm);
+    }
+  }
+  bool received() const {
+    return _installed && receivedTerminationSignal != 0;
+  }
+};
+
 std::string CommandLineParser::_getName() const {
   return this->toolFilename;
 }
@@ -16,12 +55,15 @@ std::string CommandLineParser::_getDescription() const {
 
 CommandLineParser::CommandLineParser():
   CommandLineParameterProvider(),
-  _options(),
   _actions(),
   _actionsByName(),
   _executed(false),
+  _helpIndex(),
+  _prerenderedHelp(nullptr),
+  _registry(nullptr, nullptr, nullptr),
+  _options(),
   toolFilename(""),
-  toolDescription(""),
+  toolDescription(),
   selectedAction(nullptr) {
 
   // this->onDefineParameters();
@@ -43,6 +85,7 @@ void CommandLineParser::_init(const CommandLineParserOptions& options) {
   _options = options;
   toolFilename = options.toolFilename;
   toolDescription = options.toolDescription;
+  _allowAbbreviations = options.allowAbbreviations;
 }
 
 const std::vector<CommandLineAction*>& CommandLineParser::actions() const {
@@ -53,6 +96,7 @@ void CommandLineParser::addAction(CommandLineAction* action) {
   action->_buildParser();
   this->_actions.push_back(action);
   this->_actionsByName[action->actionName] = action;
+  this->_helpIndex.reset();
 }
 
 CommandLineAction* CommandLineParser::getAction(const std::string& actionName) {
@@ -66,9 +110,117 @@ CommandLineAction* CommandLineParser::tryGetAction(const std::string& actionName
   if (this->_actionsByName.find(actionName) != this->_actionsByName.end()) {
     return this->_actionsByName.at(actionName);
   }
+  const CommandLineActionDescriptor* descriptor = this->_registry.find(actionName);
+  if (descriptor != nullptr) {
+    CommandLineAction* action = descriptor->create();
+    this->addAction(action);
+    return action;
+  }
   return nullptr;
 }
 
+void CommandLineParser::addRegisteredActions(const CommandLineActionRegistry& registry) {
+  this->_registry = registry;
+  this->_helpIndex.reset();
+}
+
+const help::Index& CommandLineParser::_getHelpIndex() const {
+  if (this->_helpIndex) {
+    return *this->_helpIndex;
+  }
+  std::shared_ptr<help::Index> index = std::make_shared<help::Index>();
+  for (size_t i = 0; i < this->_actions.size(); i++) {
+    const CommandLineAction* action = this->_actions[i];
+    uint32_t document = static_cast<uint32_t>(i);
+    index->add(document, action->actionName, 8);
+    index->add(document, action->summary, 4);
+    index->add(document, action->documentation, 1);
+    for (const CommandLineParameter* p : action->parameters()) {
+      index->add(document, p->longName, 2);
+      index->add(document, p->description, 1);
+    }
+  }
+  this->_helpIndexDescriptors.clear();
+  this->_registry.forEach([this, &index](const CommandLineActionDescriptor& descriptor) {
+    if (this->_actionsByName.find(descriptor.actionName) == this->_actionsByName.end()) {
+      uint32_t document = static_cast<uint32_t>(this->_actions.size() + this->_helpIndexDescriptors.size());
+      index->add(document, descriptor.actionName, 8);
+      index->add(document, descriptor.summary, 4);
+      this->_helpIndexDescriptors.push_back(&descriptor);
+    }
+  });
+  index->freeze();
+  this->_helpIndex = index;
+  return *index;
+}
+
+std::vector<const CommandLineAction*> CommandLineParser::searchActions(const std::string& terms, size_t limit) const {
+  std::vector<const CommandLineAction*> result;
+  for (uint32_t document : this->_getHelpIndex().search(terms, limit)) {
+    if (document < this->_actions.size()) {
+      result.push_back(this->_actions[document]);
+    }
+  }
+  return result;
+}
+
+std::string CommandLineParser::renderSearchResults(const std::string& terms) const {
+#ifdef _WIN32
+  std::string EOL = "\r\n";
+#else
+  const std::string EOL = "\n";
+#endif
+  std::vector<std::pair<std::string, std::string>> found;
+  for (uint32_t document : this->_getHelpIndex().search(terms, 20)) {
+    if (document < this->_actions.size()) {
+      found.push_back(std::make_pair(this->_actions[document]->actionName, std::string(this->_actions[document]->summary)));
+    } else {
+      const CommandLineActionDescriptor* descriptor = this->_helpIndexDescriptors[document - this->_actions.size()];
+      found.push_back(std::make_pair(std::string(descriptor->actionName), std::string(descriptor->summary)));
+    }
+  }
+  if (found.empty()) {
+    return "No commands match \"" + terms + "\".";
+  }
+  size_t width = 0;
+  for (const std::pair<std::string, std::string>& a : found) {
+    width = std::max(width, a.first.size());
+  }
+  std::string text = "Commands matching \"" + terms + "\":" + EOL;
+  for (const std::pair<std::string, std::string>& a : found) {
+    text += "  " + a.first + std::string(width - a.first.size() + 2, ' ') + a.second + EOL;
+  }
+  return text + EOL + "For detailed help about a specific command, use: " + this->toolFilename + " <command> -h";
+}
+
+void CommandLineParser::usePrerenderedHelp(const CommandLinePrerenderedHelp* help) {
+  this->_prerenderedHelp = help;
+}
+
+void CommandLineParser::_printHelp(const CommandLineAction* action) const {
+  if (this->_prerenderedHelp != nullptr) {
+    const char* text = action == nullptr ? this->_prerenderedHelp->text : nullptr;
+    size_t size = action == nullptr ? this->_prerenderedHelp->size : 0;
+    for (size_t i = 0; action != nullptr && i < this->_prerenderedHelp->actionCount; i++) {
+      if (action->actionName == this->_prerenderedHelp->actions[i].actionName) {
+        text = this->_prerenderedHelp->actions[i].text;
+        size = this->_prerenderedHelp->actions[i].size;
+        break;
+      }
+    }
+    if (text != nullptr) {
+      std::cout.write(text, static_cast<std::streamsize>(size));
+      std::cout.flush();
+      return;
+    }
+  }
+  if (action == nullptr) {
+    std::cout << this->renderHelpText() << std::endl;
+  } else {
+    std::cout << action->renderHelpText(this->toolFilename) << std::endl;
+  }
+}
+
 void CommandLineParser::onExecute() {
   if (this->selectedAction == nullptr) {
     return;
@@ -93,13 +245,87 @@ void CommandLineParser::execute(int argc, wchar_t** argv) {
 }
 
 void CommandLineParser::_validateDefinitions() const {
-  if (this->_remainder != nullptr && this->_actions.size() > 0) {
+  if (this->_remainder != nullptr && (this->_actions.size() > 0 || !this->_registry.empty())) {
     // This is apparently not supported by argparse
     throw CommandLineError(REMAINDER_DEFINED, "defineCommandLineRemainder() cannot be called for a CommandLineParser with actions");
   }
 }
 
+void CommandLineParser::_checkLimits(const std::vector<std::string>& args) const {
+  const CommandLineLimits& limits = this->_options.limits;
+  if (args.size() > limits.maxArguments) {
+    throw CommandLineError(TOO_MANY_ARGUMENTS, "Too many arguments, at most " + std::to_string(limits.maxArguments) + " are accepted", limits.maxArguments);
+  }
+  size_t totalBytes = 0;
+  for (size_t i = 0; i < args.size(); i++) {
+    if (args[i].size() > limits.maxArgumentLength) {
+      throw CommandLineError(ARGUMENT_TOO_LONG, "The argument is longer than " + std::to_string(limits.maxArgumentLength) + " bytes", i);
+    }
+    totalBytes += args[i].size();
+    if (totalBytes > limits.maxTotalBytes) {
+      throw CommandLineError(INPUT_TOO_LARGE, "The arguments are longer than " + std::to_string(limits.maxTotalBytes) + " bytes together", i);
+    }
+  }
+}
+
+static void limitListValues(const std::vector<CommandLineParameter*>& parameters, size_t maxValues) {
+  for (CommandLineParameter* p : parameters) {
+    if (p->kind() == CommandLineParameterKind::StringList) {
+      static_cast<CommandLineStringListParameter*>(p)->_limitValues(maxValues);
+    }
+  }
+}
+
+void CommandLineParser::_checkRemainderLimit(const CommandLineParameterProvider* scope, size_t remainderBegin, size_t length) const {
+  size_t maxValues = this->_options.limits.maxListValues;
+  if (this->_options.strict && scope->remainder() != nullptr && remainderBegin < length && length - remainderBegin > maxValues) {
+    throw CommandLineError(TOO_MANY_VALUES, "Too many remaining arguments, at most " + std::to_string(maxValues) + " are accepted", remainderBegin + maxValues);
+  }
+}
+
 void CommandLineParser::execute(const std::vector<std::string>& args) {
+  if (!this->_parse(args)) {
+    return;
+  }
+  if (this->_options.telemetryPath.empty()) {
+    this->onExecute();
+  } else {
+    this->_runRecorded([this]() { this->onExecute(); });
+  }
+}
+
+void CommandLineParser::_runRecorded(const std::function<void()>& run) {
+  std::unique_ptr<CommandLineTelemetry> telemetry;
+  try {
+    telemetry.reset(new CommandLineTelemetry(this->_options.telemetryPath));
+  } catch (const CommandLineError&) {
+    // Telemetry must not keep the tool from working
+    run();
+    return;
+  }
+
+  const std::string& name = this->selectedAction != nullptr ? this->selectedAction->actionName : this->toolFilename;
+  const auto start = std::chrono::steady_clock::now();
+  const usage::Usage before = usage::current();
+  auto sample = [&](bool failed) {
+    const usage::Usage after = usage::current();
+    CommandLineExecutionSample s;
+    s.wallMicros = static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count());
+    s.cpuMicros = after.cpuMicros - before.cpuMicros;
+    s.peakRssKiB = after.peakRssKiB - before.peakRssKiB;
+    s.failed = failed;
+    return s;
+  };
+  try {
+    run();
+  } catch (...) {
+    telemetry->record(name, sample(true));
+    throw;
+  }
+  telemetry->record(name, sample(false));
+}
+
+bool CommandLineParser::_parse(const std::vector<std::string>& args) {
   if (this->_executed) {
     throw CommandLineError(EXECUTE_AGAIN, "execute() was already called for this parser instance");
   }
@@ -109,84 +335,141 @@ void CommandLineParser::execute(const std::vector<std::string>& args) {
 
   size_t length = args.size();
   if (length == 0) {
-    std::cout << this->renderHelpText() << std::endl;
-    return;
+    this->_printHelp(nullptr);
+    return false;
   }
 
-  std::vector<std::string> mainArgs;
-  std::vector<std::string> actionArgs;
-  size_t i = 0;
-  for (; i < length; i++) {
-    if (args[i][0] == '-') {
-      mainArgs.push_back(args[i]);
-    } else {
-      if (i == 0) {
-        break;
-      }
-      try {
-        this->getFlagParameter(args[i - 1]);
-        if (args[i] == "true" || args[i] == "false" || args[i] == "1" || args[i] == "0") {
-          continue;
-        } else {
-          break;
-        }
-      } catch (const CommandLineError& err) {
-        if (err.code() == PARAMETER_UNDEFINED) {
-          break;
-        } else if (err.code() == PARAMETER_TYPE_ERROR) {
-          continue;
-        } else {
-          throw err;
-        }
-      }
+  // Nothing is classified or allocated for input beyond the limits
+  if (this->_options.strict) {
+    this->_checkLimits(args);
+    limitListValues(this->parameters(), this->_options.limits.maxListValues);
+  }
+
+  if (length >= 2 && args[0] == "help" && args[1] == "--search" && (!this->_actions.empty() || !this->_registry.empty()) && this->tryGetAction("help") == nullptr) {
+    std::string terms;
+    for (size_t k = 2; k < length; k++) {
+      terms += (k > 2 ? " " : "") + args[k];
     }
+    std::cout << this->renderSearchResults(terms) << std::endl;
+    return false;
   }
 
-  if (commandline::string::indexOf(mainArgs, "-h") != -1 || commandline::string::indexOf(mainArgs, "--help") != -1) {
-    std::cout << this->renderHelpText() << std::endl;
-    return;
+  token::Classification tokens;
+  token::classify(args, tokens);
+
+  // The global options end where the scan stops: at the action name, or at
+  // the start of the remainder
+  bool help = false;
+  this->_beginArgs();
+  size_t i = this->_scanArgs(args, tokens, 0, help);
+  if (help) {
+    this->_printHelp(nullptr);
+    return false;
   }
 
-  if (this->_remainder != nullptr) {
-    // std::vector<std::string> remain;
-    // for (size_t x = i; x < length; x++) {
-    //   remain.push_back(args[x]);
-    // }
-    // this->_remainder->_setValue(remain);
+  if (this->_remainder != nullptr || i == length) {
+    this->_checkRemainderLimit(this, i, length);
+    this->_endArgs(args, i);
+    return true;
+  }
 
-    for (size_t x = i; x < length; x++) {
-      mainArgs.push_back(args[x]);
+  this->selectedAction = this->tryGetAction(args[i]);
+  if (this->selectedAction == nullptr) {
+    std::vector<std::string> actionNames;
+    for (const CommandLineAction* action : this->_actions) {
+      actionNames.push_back(action->actionName);
     }
-    this->_processArgs(mainArgs);
-    this->onExecute();
+    this->_registry.forEach([&actionNames](const CommandLineActionDescriptor& descriptor) {
+      actionNames.push_back(descriptor.actionName);
+    });
+    std::string suggestion = suggest::nearest(args[i], actionNames);
+    throw CommandLineError(ACTION_UNDEFINED, suggestion.empty() ? "Unrecognized action" : "Unrecognized action. Did you mean \"" + suggestion + "\"?", i);
+  }
+  i++;
+
+  this->selectedAction->_activate();
+  if (this->_options.strict) {
+    limitListValues(this->selectedAction->parameters(), this->_options.limits.maxListValues);
+  }
+
+  this->selectedAction->_beginArgs(this);
+  size_t stop = this->selectedAction->_scanArgs(args, tokens, i, help);
+  if (help) {
+    this->_printHelp(this->selectedAction);
+    return false;
+  }
+
+  this->_checkRemainderLimit(this->selectedAction, stop, length);
+  this->_endArgs(args, length);
+  this->selectedAction->_endArgs(args, stop);
+  return true;
+}
+
+void CommandLineParser::executeAsync(int argc, char** argv, const CommandLineAsyncOptions& options) {
+  std::vector<std::string> args;
+  for (int i = 1; i < argc; i++) {
+    args.push_back(argv[i]);
+  }
+  this->executeAsync(args, options);
+}
+
+void CommandLineParser::executeAsync(const std::vector<std::string>& args, const CommandLineAsyncOptions& options) {
+  if (!this->_parse(args)) {
+    return;
+  }
+  if (this->_options.telemetryPath.empty()) {
+    this->_runAsync(options);
   } else {
-    if (i == length) {
-      // throw CommandLineError(ACTION_UNKNOWN, "Unrecognized action");
-      this->_processArgs(mainArgs);
-      this->onExecute();
-      return;
-    }
+    this->_runRecorded([this, &options]() { this->_runAsync(options); });
+  }
+}
 
-    try {
-      this->selectedAction = this->getAction(args[i]);
-      i++;
-    } catch (const CommandLineError&) {
-      throw CommandLineError(ACTION_UNDEFINED, "Unrecognized action");
-    }
+void CommandLineParser::_runAsync(const CommandLineAsyncOptions& options) {
 
-    for (; i < length; i++) {
-      actionArgs.push_back(args[i]);
-    }
+  CommandLineCancellationToken token;
+  CommandLineEventLoop loop;
+  CommandLineExecutionContext context(token, options.executor != nullptr ? *options.executor : loop);
 
-    if (commandline::string::indexOf(actionArgs, "-h") != -1 || commandline::string::indexOf(actionArgs, "--help") != -1) {
-      std::cout << this->selectedAction->renderHelpText(this->toolFilename) << std::endl;
-      return;
+  std::chrono::milliseconds timeout = options.timeout;
+  if (timeout == std::chrono::milliseconds::zero() && this->selectedAction != nullptr) {
+    timeout = this->selectedAction->timeout;
+  }
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  const auto slice = std::chrono::milliseconds(5);
+
+  {
+    TerminationSignalGuard signalGuard(options.handleSignals);
+    std::future<void> future = this->onExecuteAsync(context);
+    // A deferred future never becomes ready by waiting; get() below runs it
+    std::future_status status;
+    while (future.valid() && (status = future.wait_for(std::chrono::seconds::zero())) != std::future_status::ready &&
+        status != std::future_status::deferred) {
+      if (options.executor == nullptr) {
+        loop.runOne(slice);
+      } else {
+        future.wait_for(slice);
+      }
+      if (signalGuard.received()) {
+        token.cancel(Signal);
+      }
+      if (timeout != std::chrono::milliseconds::zero() && std::chrono::steady_clock::now() >= deadline) {
+        token.cancel(Deadline);
+      }
+    }
+    if (future.valid()) {
+      future.get();
     }
+  }
+  token.throwIfCancellationRequested();
+}
 
-    this->_processArgs(mainArgs);
-    this->selectedAction->_processArgs(actionArgs);
-    this->onExecute();
+std::future<void> CommandLineParser::onExecuteAsync(CommandLineExecutionContext& context) {
+  if (this->selectedAction == nullptr) {
+    std::promise<void> promise;
+    promise.set_value();
+    return promise.get_future();
   }
+  return this->selectedAction->_executeAsync(context);
 }
 
 std::string CommandLineParser::renderHelpText() const {
@@ -250,6 +533,16 @@ std::string CommandLineParser::renderHelpText() const {
         }
         break;
       }
+      case CommandLineParameterKind::Double:
+      case CommandLineParameterKind::Unsigned:
+      case CommandLineParameterKind::ByteSize:
+      case CommandLineParameterKind::Duration: {
+        const CommandLineParameterWithArgument* param = static_cast<const CommandLineParameterWithArgument*>(p);
+        if (param->argumentName != "") {
+          optionString += " " + param->argumentName;
+        }
+        break;
+      }
       default:
         break;
     }
@@ -267,7 +560,13 @@ std::string CommandLineParser::renderHelpText() const {
   usage += shortOptions + (this->_remainder == nullptr ? (" <command> ...") : (" " + this->_remainder->argumentName)) + EOL + EOL + this->toolDescription + EOL + EOL;
 
   std::string actionPart = "";
-  if (this->_actions.size() > 0) {
+  std::vector<std::pair<std::string, std::string>> registered;
+  this->_registry.forEach([this, &registered](const CommandLineActionDescriptor& descriptor) {
+    if (this->_actionsByName.find(descriptor.actionName) == this->_actionsByName.end()) {
+      registered.push_back(std::make_pair(std::string(descriptor.actionName), std::string(descriptor.summary)));
+    }
+  });
+  if (this->_actions.size() > 0 || registered.size() > 0) {
     actionPart = "Commands:" + EOL;
     const size_t len = indent;
 
@@ -276,6 +575,11 @@ std::string CommandLineParser::renderHelpText() const {
       std::string space = len < front.length() + 1 ? EOL + repeat(" ", len) : repeat(" ", len - front.length());
       actionPart += front + space + a->summary + EOL;
     }
+    for (const std::pair<std::string, std::string>& a : registered) {
+      std::string front = repeat(" ", 2) + a.first;
+      std::string space = len < front.length() + 1 ? EOL + repeat(" ", len) : repeat(" ", len - front.length());
+      actionPart += front + space + a.second + EOL;
+    }
   }
 
   std::string optionPart = "Options:" + EOL;
@@ -292,7 +596,7 @@ std::string CommandLineParser::renderHelpText() const {
   }
 
   std::string foot = "";
-  if (this->_remainder == nullptr && this->_actions.size() > 0) {
+  if (this->_remainder == nullptr && (this->_actions.size() > 0 || registered.size() > 0)) {
     foot = EOL + "For detailed help about a specific command, use: example <command> -h";
   }
 
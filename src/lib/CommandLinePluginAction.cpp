@@ -0,0 +1,55 @@
+#include "commandline/CommandLinePluginAction.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "SharedLibrary.hpp"
+
+namespace commandline {
+
+static CommandLineActionOptions toActionOptions(const CommandLinePluginManifestEntry& entry) {
+  CommandLineActionOptions options;
+  options.actionName = entry.actionName;
+  options.summary = entry.summary;
+  options.documentation = entry.summary;
+  return options;
+}
+
+CommandLinePluginAction::CommandLinePluginAction(const CommandLinePluginManifestEntry& entry):
+  DynamicCommandLineAction(toActionOptions(entry)),
+  _libraryPath(entry.libraryPath),
+  _entrySymbol(entry.entrySymbol),
+  _loaded(false) {}
+
+const std::string& CommandLinePluginAction::libraryPath() const {
+  return this->_libraryPath;
+}
+
+bool CommandLinePluginAction::loaded() const {
+  return this->_loaded;
+}
+
+void CommandLinePluginAction::_activate() {
+  if (this->_loaded) {
+    return;
+  }
+
+  std::string error;
+  void* handle = commandline::dl::open(this->_libraryPath, error);
+  if (handle == nullptr) {
+    throw CommandLineError(PLUGIN_LOAD_FAILED, "Unable to load the plugin \"" + this->_libraryPath + "\" for the action \"" + this->actionName + "\": " + error);
+  }
+  void* entry = commandline::dl::symbol(handle, this->_entrySymbol, error);
+  if (entry == nullptr) {
+    commandline::dl::close(handle);
+    throw CommandLineError(PLUGIN_LOAD_FAILED, "The plugin \"" + this->_libraryPath + "\" does not export \"" + this->_entrySymbol + "\": " + error);
+  }
+
+  CommandLinePluginDefinition definition;
+  reinterpret_cast<CommandLinePluginEntry>(entry)(&definition);
+  if (definition.documentation != nullptr) {
+    this->documentation = definition.documentation;
+  }
+  this->setCallbacks(definition.onDefineParameters, definition.onExecute);
+  this->_loaded = true;
+  this->_buildParser();
+}
+
+}
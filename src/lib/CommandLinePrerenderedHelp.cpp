@@ -0,0 +1,72 @@
+#include "commandline/CommandLinePrerenderedHelp.hpp"
+#include "commandline/CommandLineParser.hpp"
+
+namespace commandline {
+
+// A string literal split after every line break. Other control characters
+// and bytes outside ASCII become three-digit octal escapes, which cannot run
+// into the characters that follow them.
+static std::string literal(const std::string& text) {
+  std::string out = "\"";
+  for (size_t i = 0; i < text.size(); i++) {
+    unsigned char c = static_cast<unsigned char>(text[i]);
+    switch (c) {
+      case '\\': out += "\\\\"; break;
+      case '"': out += "\\\""; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      case '\n':
+        out += "\\n\"";
+        if (i + 1 < text.size()) {
+          out += "\n  \"";
+        } else {
+          return out;
+        }
+        break;
+      default:
+        if (c < 0x20 || c >= 0x7f || c == '?') {
+          // '?' too, so that no trigraph can appear
+          char escaped[5] = { '\\', static_cast<char>('0' + (c >> 6)), static_cast<char>('0' + ((c >> 3) & 7)), static_cast<char>('0' + (c & 7)), 0 };
+          out += escaped;
+        } else {
+          out += static_cast<char>(c);
+        }
+    }
+  }
+  return out + "\"";
+}
+
+std::string renderPrerenderedHelpSource(const CommandLineParser& parser, const std::string& symbol) {
+  // Matches the std::endl the parser writes after rendered help
+  const std::string newline = "\n";
+  std::string source =
+    "// Generated by commandline-helpgen. Do not edit.\n"
+    "#include \"commandline/CommandLinePrerenderedHelp.hpp\"\n\n"
+    "namespace {\n\n"
+    "const char toolHelp[] =\n  " + literal(parser.renderHelpText() + newline) + ";\n\n";
+
+  const std::vector<CommandLineAction*>& actions = parser.actions();
+  for (size_t i = 0; i < actions.size(); i++) {
+    // Plugin actions only know their parameters once loaded
+    actions[i]->_activate();
+    source += "const char actionHelp" + std::to_string(i) + "[] =\n  " + literal(actions[i]->renderHelpText(parser.toolFilename) + newline) + ";\n\n";
+  }
+
+  source += "const commandline::CommandLinePrerenderedAction actions[] = {\n";
+  for (size_t i = 0; i < actions.size(); i++) {
+    std::string name = "actionHelp" + std::to_string(i);
+    source += "  { " + literal(actions[i]->actionName) + ", " + name + ", sizeof(" + name + ") - 1 },\n";
+  }
+  if (actions.empty()) {
+    source += "  { nullptr, nullptr, 0 }\n";
+  }
+  source += "};\n\n}\n\n";
+
+  source += "extern const commandline::CommandLinePrerenderedHelp " + symbol + ";\n";
+  source += "const commandline::CommandLinePrerenderedHelp " + symbol + " = {\n"
+    "  toolHelp, sizeof(toolHelp) - 1, actions, " + std::to_string(actions.size()) + "\n"
+    "};\n";
+  return source;
+}
+
+}
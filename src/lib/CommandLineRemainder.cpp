@@ -7,9 +7,9 @@ CommandLineRemainder::CommandLineRemainder(const CommandLineRemainderDefinition&
   this->description = definition.description;
 }
 
-CommandLineRemainder::CommandLineRemainder(): _values(), argumentName("..."), description("") {}
+CommandLineRemainder::CommandLineRemainder(): _values(), argumentName("..."), description() {}
 
-std::vector<std::string> CommandLineRemainder::values() const {
+const std::vector<std::string>& CommandLineRemainder::values() const {
   return this->_values;
 }
 
@@ -19,7 +19,7 @@ void CommandLineRemainder::_setValue(const std::vector<std::string>& data) {
     }
   }
 
-void CommandLineRemainder::appendToArgList(std::vector<std::string>& argList) {
+void CommandLineRemainder::appendToArgList(std::vector<std::string>& argList) const {
   if (this->_values.size() > 0) {
     for (const auto& value : this->_values) {
       argList.push_back(value);
@@ -0,0 +1,214 @@
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
+#include "commandline/CommandLineResult.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "ResultFormat.hpp"
+
+namespace commandline {
+
+namespace {
+
+// Lays out the result; with a null output it only measures, so both passes
+// share the same code and agree on every offset.
+class ResultWriter {
+ private:
+  char* _out;
+  size_t _size;
+
+  uint32_t _reserve(size_t bytes, size_t alignment) {
+    this->_size = (this->_size + alignment - 1) / alignment * alignment;
+    size_t offset = this->_size;
+    this->_size += bytes;
+    if (this->_size > UINT32_MAX) {
+      throw CommandLineError(RESULT_ENCODING_FAILED, "The parse result is too large to encode");
+    }
+    return static_cast<uint32_t>(offset);
+  }
+
+  void _write(uint32_t offset, const void* data, size_t size) {
+    if (this->_out != nullptr) {
+      std::memcpy(this->_out + offset, data, size);
+    }
+  }
+
+  result::Ref _string(const std::string& value) {
+    result::Ref ref{ this->_reserve(value.size() + 1, 1), static_cast<uint32_t>(value.size()) };
+    this->_write(ref.offset, value.c_str(), value.size() + 1);
+    return ref;
+  }
+
+  result::Ref _list(const std::vector<std::string>& values) {
+    result::Ref ref{ this->_reserve(values.size() * sizeof(result::Ref), 4), static_cast<uint32_t>(values.size()) };
+    for (size_t i = 0; i < values.size(); i++) {
+      result::Ref item = this->_string(values[i]);
+      this->_write(ref.offset + static_cast<uint32_t>(i * sizeof(result::Ref)), &item, sizeof(item));
+    }
+    return ref;
+  }
+
+  result::Entry _entry(const CommandLineParameter* parameter) {
+    result::Entry entry;
+    std::memset(&entry, 0, sizeof(entry));
+    entry.name = this->_string(parameter->longName);
+    entry.kind = static_cast<uint8_t>(parameter->kind());
+    entry.source = static_cast<uint8_t>(parameter->valueSource());
+    switch (parameter->kind()) {
+      case CommandLineParameterKind::Choice: {
+        const CommandLineChoiceParameter* p = static_cast<const CommandLineChoiceParameter*>(parameter);
+        entry.scalar = p->index();
+        entry.data = this->_string(p->value());
+        break;
+      }
+      case CommandLineParameterKind::Flag:
+        entry.scalar = static_cast<const CommandLineFlagParameter*>(parameter)->value() ? 1 : 0;
+        break;
+      case CommandLineParameterKind::Integer:
+        entry.scalar = static_cast<uint64_t>(static_cast<const CommandLineIntegerParameter*>(parameter)->value());
+        break;
+      case CommandLineParameterKind::Double: {
+        double value = static_cast<const CommandLineDoubleParameter*>(parameter)->value();
+        std::memcpy(&entry.scalar, &value, sizeof(value));
+        break;
+      }
+      case CommandLineParameterKind::Unsigned:
+        entry.scalar = static_cast<const CommandLineUnsignedParameter*>(parameter)->value();
+        break;
+      case CommandLineParameterKind::ByteSize:
+        entry.scalar = static_cast<const CommandLineByteSizeParameter*>(parameter)->value();
+        break;
+      case CommandLineParameterKind::Duration:
+        entry.scalar = static_cast<uint64_t>(static_cast<const CommandLineDurationParameter*>(parameter)->value().count());
+        break;
+      case CommandLineParameterKind::String:
+        entry.data = this->_string(static_cast<const CommandLineStringParameter*>(parameter)->value());
+        break;
+      case CommandLineParameterKind::StringList:
+        entry.data = this->_list(static_cast<const CommandLineStringListParameter*>(parameter)->values());
+        break;
+    }
+    return entry;
+  }
+
+ public:
+  ResultWriter(char* out): _out(out), _size(0) {}
+
+  size_t write(const CommandLineParser& parser) {
+    const CommandLineParameterProvider* scopes[2] = { &parser, parser.selectedAction };
+
+    result::Header header;
+    std::memset(&header, 0, sizeof(header));
+    std::memcpy(header.magic, result::magic, sizeof(header.magic));
+    header.version = CommandLineResult::version;
+    this->_reserve(sizeof(header), 8);
+
+    for (int s = 0; s < 2; s++) {
+      if (scopes[s] == nullptr) continue;
+      const std::vector<CommandLineParameter*>& parameters = scopes[s]->parameters();
+      header.entryCount[s] = static_cast<uint32_t>(parameters.size());
+      header.entriesOffset[s] = this->_reserve(parameters.size() * sizeof(result::Entry), 8);
+      header.sortedOffset[s] = this->_reserve(parameters.size() * sizeof(uint32_t), 4);
+    }
+
+    for (int s = 0; s < 2; s++) {
+      if (scopes[s] == nullptr) continue;
+      const std::vector<CommandLineParameter*>& parameters = scopes[s]->parameters();
+      std::vector<uint32_t> sorted;
+      for (size_t id = 0; id < parameters.size(); id++) {
+        result::Entry entry = this->_entry(parameters[id]);
+        this->_write(header.entriesOffset[s] + static_cast<uint32_t>(id * sizeof(entry)), &entry, sizeof(entry));
+        sorted.push_back(static_cast<uint32_t>(id));
+      }
+      std::sort(sorted.begin(), sorted.end(), [&parameters](uint32_t a, uint32_t b) {
+        return parameters[a]->longName < parameters[b]->longName;
+      });
+      this->_write(header.sortedOffset[s], sorted.data(), sorted.size() * sizeof(uint32_t));
+
+      const CommandLineRemainder* remainder = scopes[s]->remainder();
+      if (remainder != nullptr) {
+        header.flags |= s == 0 ? result::HasRemainder : result::HasActionRemainder;
+        header.remainder[s] = this->_list(remainder->values());
+      }
+    }
+
+    if (parser.selectedAction != nullptr) {
+      header.flags |= result::HasAction;
+      header.actionName = this->_string(parser.selectedAction->actionName);
+    }
+
+    header.totalSize = static_cast<uint32_t>(this->_size);
+    this->_write(0, &header, sizeof(header));
+    return this->_size;
+  }
+};
+
+}
+
+size_t CommandLineResult::encodedSize(const CommandLineParser& parser) {
+  return ResultWriter(nullptr).write(parser);
+}
+
+size_t CommandLineResult::encode(const CommandLineParser& parser, void* buffer, size_t capacity) {
+  size_t size = encodedSize(parser);
+  if (capacity < size) {
+    throw CommandLineError(RESULT_ENCODING_FAILED, "The buffer holds " + std::to_string(capacity) + " bytes but the result needs " + std::to_string(size));
+  }
+  if (reinterpret_cast<uintptr_t>(buffer) % 8 != 0) {
+    throw CommandLineError(RESULT_ENCODING_FAILED, "The result buffer must be 8-byte aligned");
+  }
+  std::memset(buffer, 0, size);
+  return ResultWriter(static_cast<char*>(buffer)).write(parser);
+}
+
+std::vector<uint64_t> CommandLineResult::encode(const CommandLineParser& parser) {
+  size_t size = encodedSize(parser);
+  std::vector<uint64_t> buffer((size + 7) / 8);
+  encode(parser, buffer.data(), buffer.size() * 8);
+  return buffer;
+}
+
+int CommandLineResult::encodeToMemfd(const CommandLineParser& parser) {
+#ifdef __linux__
+  size_t size = encodedSize(parser);
+  int fd = ::memfd_create("commandline-result", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+  if (fd < 0) {
+    throw CommandLineError(RESULT_ENCODING_FAILED, std::string("memfd_create() failed: ") + std::strerror(errno));
+  }
+  void* mapping = MAP_FAILED;
+  if (::ftruncate(fd, static_cast<off_t>(size)) == 0) {
+    mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  }
+  if (mapping == MAP_FAILED) {
+    std::string message = std::string("Cannot map the result memfd: ") + std::strerror(errno);
+    ::close(fd);
+    throw CommandLineError(RESULT_ENCODING_FAILED, message);
+  }
+  try {
+    encode(parser, mapping, size);
+  } catch (...) {
+    ::munmap(mapping, size);
+    ::close(fd);
+    throw;
+  }
+  ::munmap(mapping, size);
+  // Workers can map the result but nobody can change it any more
+  if (::fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL) != 0) {
+    std::string message = std::string("Cannot seal the result memfd: ") + std::strerror(errno);
+    ::close(fd);
+    throw CommandLineError(RESULT_ENCODING_FAILED, message);
+  }
+  return fd;
+#else
+  (void)parser;
+  throw CommandLineError(RESULT_ENCODING_FAILED, "memfd is not supported on this platform");
+#endif
+}
+
+}
@@ -0,0 +1,273 @@
+#include <cstring>
+
+#include "commandline/CommandLineResult.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "ResultFormat.hpp"
+
+namespace commandline {
+
+static const CommandLineParameterKind lastKind = CommandLineParameterKind::Duration;
+
+static std::string kindName(CommandLineParameterKind kind) {
+  static const char* names[] = { "Choice", "Flag", "Integer", "String", "StringList", "Double", "Unsigned", "ByteSize", "Duration" };
+  return names[static_cast<size_t>(kind)];
+}
+
+static void invalid(const std::string& message) {
+  throw CommandLineError(RESULT_INVALID, "Invalid parse result: " + message);
+}
+
+static bool inBounds(size_t size, uint64_t offset, uint64_t length) {
+  return offset <= size && length <= size - offset;
+}
+
+static void checkString(const char* base, size_t size, const result::Ref& ref) {
+  if (!inBounds(size, ref.offset, static_cast<uint64_t>(ref.length) + 1) || base[ref.offset + ref.length] != '\0') {
+    invalid("a string is out of bounds");
+  }
+}
+
+static void checkList(const char* base, size_t size, const result::Ref& ref) {
+  if (ref.offset % 4 != 0 || !inBounds(size, ref.offset, static_cast<uint64_t>(ref.length) * sizeof(result::Ref))) {
+    invalid("a list is out of bounds");
+  }
+  const result::Ref* items = reinterpret_cast<const result::Ref*>(base + ref.offset);
+  for (uint32_t i = 0; i < ref.length; i++) {
+    checkString(base, size, items[i]);
+  }
+}
+
+static CommandLineTextListView listView(const char* base, const result::Ref& ref) {
+  return CommandLineTextListView(base, reinterpret_cast<const uint32_t*>(base + ref.offset), ref.length);
+}
+
+std::string CommandLineTextView::str() const {
+  return std::string(this->data, this->size);
+}
+
+bool CommandLineTextView::operator==(const std::string& other) const {
+  return other.size() == this->size && std::memcmp(other.data(), this->data, this->size) == 0;
+}
+
+bool CommandLineTextView::operator!=(const std::string& other) const {
+  return !(*this == other);
+}
+
+CommandLineTextListView::CommandLineTextListView(): _base(nullptr), _refs(nullptr), _size(0) {}
+
+CommandLineTextListView::CommandLineTextListView(const char* base, const uint32_t* refs, size_t size):
+  _base(base), _refs(refs), _size(size) {}
+
+size_t CommandLineTextListView::size() const {
+  return this->_size;
+}
+
+CommandLineTextView CommandLineTextListView::operator[](size_t i) const {
+  return CommandLineTextView{ this->_base + this->_refs[2 * i], this->_refs[2 * i + 1] };
+}
+
+std::vector<std::string> CommandLineTextListView::str() const {
+  std::vector<std::string> values;
+  for (size_t i = 0; i < this->_size; i++) {
+    values.push_back((*this)[i].str());
+  }
+  return values;
+}
+
+CommandLineResultScope::CommandLineResultScope(): _base(nullptr), _entries(nullptr), _sorted(nullptr), _count(0) {}
+
+CommandLineResultScope::CommandLineResultScope(const char* base, const void* entries, const uint32_t* sorted, size_t count):
+  _base(base), _entries(entries), _sorted(sorted), _count(count) {}
+
+const void* CommandLineResultScope::_entry(size_t id) const {
+  if (id >= this->_count) {
+    throw CommandLineError(PARAMETER_UNDEFINED, "There is no parameter with id " + std::to_string(id));
+  }
+  return static_cast<const result::Entry*>(this->_entries) + id;
+}
+
+const void* CommandLineResultScope::_find(const std::string& longName, CommandLineParameterKind expectedKind) const {
+  int id = this->idOf(longName);
+  if (id < 0) {
+    throw CommandLineError(PARAMETER_UNDEFINED, "The parameter \"" + longName + "\" is not defined");
+  }
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_entries) + id;
+  CommandLineParameterKind kind = static_cast<CommandLineParameterKind>(entry->kind);
+  if (kind != expectedKind) {
+    throw CommandLineError(PARAMETER_TYPE_ERROR, "The parameter \"" + longName + "\" is of type \"" + kindName(kind) + "\" whereas the caller was expecting \"" + kindName(expectedKind) + "\".");
+  }
+  return entry;
+}
+
+size_t CommandLineResultScope::parameterCount() const {
+  return this->_count;
+}
+
+int CommandLineResultScope::idOf(const std::string& longName) const {
+  const result::Entry* entries = static_cast<const result::Entry*>(this->_entries);
+  size_t low = 0;
+  size_t high = this->_count;
+  while (low < high) {
+    size_t middle = low + (high - low) / 2;
+    const result::Entry& entry = entries[this->_sorted[middle]];
+    int c = longName.compare(0, std::string::npos, this->_base + entry.name.offset, entry.name.length);
+    if (c == 0) {
+      return static_cast<int>(this->_sorted[middle]);
+    } else if (c < 0) {
+      high = middle;
+    } else {
+      low = middle + 1;
+    }
+  }
+  return -1;
+}
+
+CommandLineTextView CommandLineResultScope::name(size_t id) const {
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_entry(id));
+  return CommandLineTextView{ this->_base + entry->name.offset, entry->name.length };
+}
+
+CommandLineParameterKind CommandLineResultScope::kind(size_t id) const {
+  return static_cast<CommandLineParameterKind>(static_cast<const result::Entry*>(this->_entry(id))->kind);
+}
+
+CommandLineValueSource CommandLineResultScope::valueSource(size_t id) const {
+  return static_cast<CommandLineValueSource>(static_cast<const result::Entry*>(this->_entry(id))->source);
+}
+
+CommandLineTextView CommandLineResultScope::getChoiceParameter(const std::string& longName) const {
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Choice));
+  return CommandLineTextView{ this->_base + entry->data.offset, entry->data.length };
+}
+
+size_t CommandLineResultScope::getChoiceIndex(const std::string& longName) const {
+  return static_cast<size_t>(static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Choice))->scalar);
+}
+
+bool CommandLineResultScope::getFlagParameter(const std::string& longName) const {
+  return static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Flag))->scalar != 0;
+}
+
+int64_t CommandLineResultScope::getIntegerParameter(const std::string& longName) const {
+  return static_cast<int64_t>(static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Integer))->scalar);
+}
+
+double CommandLineResultScope::getDoubleParameter(const std::string& longName) const {
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Double));
+  double value;
+  std::memcpy(&value, &entry->scalar, sizeof(value));
+  return value;
+}
+
+uint64_t CommandLineResultScope::getUnsignedParameter(const std::string& longName) const {
+  return static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Unsigned))->scalar;
+}
+
+uint64_t CommandLineResultScope::getByteSizeParameter(const std::string& longName) const {
+  return static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::ByteSize))->scalar;
+}
+
+std::chrono::nanoseconds CommandLineResultScope::getDurationParameter(const std::string& longName) const {
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::Duration));
+  return std::chrono::nanoseconds(static_cast<int64_t>(entry->scalar));
+}
+
+CommandLineTextView CommandLineResultScope::getStringParameter(const std::string& longName) const {
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::String));
+  return CommandLineTextView{ this->_base + entry->data.offset, entry->data.length };
+}
+
+CommandLineTextListView CommandLineResultScope::getStringListParameter(const std::string& longName) const {
+  const result::Entry* entry = static_cast<const result::Entry*>(this->_find(longName, CommandLineParameterKind::StringList));
+  return listView(this->_base, entry->data);
+}
+
+CommandLineResultView::CommandLineResultView(const void* data, size_t size):
+  _base(static_cast<const char*>(data)), _hasAction(false), _actionName{ "", 0 } {
+  if (reinterpret_cast<uintptr_t>(data) % 8 != 0) {
+    invalid("the buffer is not 8-byte aligned");
+  }
+  if (size < sizeof(result::Header)) {
+    invalid("the buffer is too small");
+  }
+  const result::Header* header = reinterpret_cast<const result::Header*>(data);
+  if (std::memcmp(header->magic, result::magic, sizeof(header->magic)) != 0) {
+    invalid("bad magic");
+  }
+  if (header->version != CommandLineResult::version) {
+    invalid("unsupported version " + std::to_string(header->version));
+  }
+  if (header->totalSize > size) {
+    invalid("the buffer is truncated");
+  }
+  size = header->totalSize;
+
+  CommandLineResultScope* scopes[2] = { &this->_global, &this->_action };
+  for (int s = 0; s < 2; s++) {
+    uint32_t count = header->entryCount[s];
+    if (count == 0) continue;
+    if (header->entriesOffset[s] % 8 != 0 || header->sortedOffset[s] % 4 != 0 ||
+      !inBounds(size, header->entriesOffset[s], static_cast<uint64_t>(count) * sizeof(result::Entry)) ||
+      !inBounds(size, header->sortedOffset[s], static_cast<uint64_t>(count) * sizeof(uint32_t))) {
+      invalid("the parameter table is out of bounds");
+    }
+    const result::Entry* entries = reinterpret_cast<const result::Entry*>(this->_base + header->entriesOffset[s]);
+    const uint32_t* sorted = reinterpret_cast<const uint32_t*>(this->_base + header->sortedOffset[s]);
+    for (uint32_t i = 0; i < count; i++) {
+      const result::Entry& entry = entries[i];
+      if (entry.kind > static_cast<uint8_t>(lastKind) || entry.source > static_cast<uint8_t>(CommandLineValueSource::CommandLine) || sorted[i] >= count) {
+        invalid("bad parameter entry");
+      }
+      checkString(this->_base, size, entry.name);
+      CommandLineParameterKind kind = static_cast<CommandLineParameterKind>(entry.kind);
+      if (kind == CommandLineParameterKind::StringList) {
+        checkList(this->_base, size, entry.data);
+      } else if (kind == CommandLineParameterKind::String || kind == CommandLineParameterKind::Choice) {
+        checkString(this->_base, size, entry.data);
+      }
+    }
+    *scopes[s] = CommandLineResultScope(this->_base, entries, sorted, count);
+  }
+
+  if (header->flags & result::HasAction) {
+    checkString(this->_base, size, header->actionName);
+    this->_hasAction = true;
+    this->_actionName = CommandLineTextView{ this->_base + header->actionName.offset, header->actionName.length };
+  }
+  const uint16_t remainderFlags[2] = { result::HasRemainder, result::HasActionRemainder };
+  for (int s = 0; s < 2; s++) {
+    if (header->flags & remainderFlags[s]) {
+      checkList(this->_base, size, header->remainder[s]);
+      this->_remainder[s] = listView(this->_base, header->remainder[s]);
+    }
+  }
+}
+
+const CommandLineResultScope& CommandLineResultView::global() const {
+  return this->_global;
+}
+
+bool CommandLineResultView::hasAction() const {
+  return this->_hasAction;
+}
+
+CommandLineTextView CommandLineResultView::actionName() const {
+  return this->_actionName;
+}
+
+const CommandLineResultScope& CommandLineResultView::action() const {
+  if (!this->_hasAction) {
+    throw CommandLineError(ACTION_UNDEFINED, "The parse result has no selected action");
+  }
+  return this->_action;
+}
+
+CommandLineTextListView CommandLineResultView::remainder() const {
+  return this->_remainder[0];
+}
+
+CommandLineTextListView CommandLineResultView::actionRemainder() const {
+  return this->_remainder[1];
+}
+
+}
@@ -0,0 +1,454 @@
+#ifndef _WIN32
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#ifdef __APPLE__
+#include <crt_externs.h>
+#define environ (*_NSGetEnviron())
+#else
+extern char** environ;
+#endif
+#endif
+
+#include "commandline/CommandLineServer.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "EnvironmentVariable.hpp"
+
+namespace commandline {
+
+#ifdef _WIN32
+
+CommandLineServer::CommandLineServer(CommandLineParser* parser, const std::string& socketPath):
+  _parser(parser), _socketPath(socketPath), _listenFd(-1), _stopPipe{-1, -1}, _children() {
+  throw CommandLineError(SERVER_ERROR, "CommandLineServer is not supported on this platform");
+}
+
+CommandLineServer::~CommandLineServer() {}
+void CommandLineServer::listen() {}
+void CommandLineServer::serve() {}
+void CommandLineServer::stop() {}
+void CommandLineServer::_handleConnection(int) {}
+
+int CommandLineServer::forward(const std::string&, const std::vector<std::string>&, int, int, int) {
+  throw CommandLineError(SERVER_ERROR, "CommandLineServer is not supported on this platform");
+}
+
+#else
+
+// Request: u32 payload size, then u32 argc + args, cwd, u32 envc + "KEY=VALUE"
+// entries, each string as u32 length + bytes. The client's stdin, stdout and
+// stderr travel as SCM_RIGHTS ancillary data on the first byte.
+// Response: a single i32 exit code.
+static const uint32_t maxRequestSize = 16 * 1024 * 1024;
+
+static std::string systemError(const std::string& what) {
+  return what + ": " + std::strerror(errno);
+}
+
+static bool makeAddress(const std::string& path, sockaddr_un& address) {
+  std::memset(&address, 0, sizeof(address));
+  address.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(address.sun_path)) {
+    return false;
+  }
+  std::memcpy(address.sun_path, path.c_str(), path.size());
+  return true;
+}
+
+static bool writeAll(int fd, const char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::write(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+static bool readAll(int fd, char* data, size_t size) {
+  while (size > 0) {
+    ssize_t n = ::read(fd, data, size);
+    if (n < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (n == 0) {
+      return false;
+    }
+    data += n;
+    size -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+static void putU32(std::string& out, uint32_t value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void putString(std::string& out, const std::string& value) {
+  putU32(out, static_cast<uint32_t>(value.size()));
+  out.append(value);
+}
+
+static bool getU32(const std::string& in, size_t& offset, uint32_t& value) {
+  if (in.size() - offset < sizeof(value)) return false;
+  std::memcpy(&value, in.data() + offset, sizeof(value));
+  offset += sizeof(value);
+  return true;
+}
+
+static bool getString(const std::string& in, size_t& offset, std::string& value) {
+  uint32_t size;
+  if (!getU32(in, offset, size) || in.size() - offset < size) return false;
+  value.assign(in, offset, size);
+  offset += size;
+  return true;
+}
+
+static bool getStrings(const std::string& in, size_t& offset, std::vector<std::string>& values) {
+  uint32_t count;
+  if (!getU32(in, offset, count)) return false;
+  for (uint32_t i = 0; i < count; i++) {
+    std::string value;
+    if (!getString(in, offset, value)) return false;
+    values.push_back(value);
+  }
+  return true;
+}
+
+static void closeFds(int* fds, int count) {
+  for (int i = 0; i < count; i++) {
+    if (fds[i] >= 0) ::close(fds[i]);
+  }
+}
+
+// Replaces the environment of the calling process with the given entries.
+static void applyEnvironment(const std::vector<std::string>& entries) {
+  std::vector<std::string> names;
+  for (char** e = environ; *e != nullptr; e++) {
+    const char* eq = std::strchr(*e, '=');
+    if (eq != nullptr) names.push_back(std::string(*e, static_cast<size_t>(eq - *e)));
+  }
+  for (const std::string& name : names) {
+    ::unsetenv(name.c_str());
+  }
+  for (const std::string& entry : entries) {
+    size_t eq = entry.find('=');
+    if (eq == std::string::npos || eq == 0) continue;
+    ::setenv(entry.substr(0, eq).c_str(), entry.c_str() + eq + 1, 1);
+  }
+  resetEnv();
+}
+
+// Requests run with the rights of the server, so only its own user may send them
+static bool peerIsOwner(int fd) {
+#ifdef SO_PEERCRED
+  ucred credentials;
+  socklen_t length = sizeof(credentials);
+  return ::getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0 && credentials.uid == ::geteuid();
+#else
+  uid_t uid;
+  gid_t gid;
+  return ::getpeereid(fd, &uid, &gid) == 0 && uid == ::geteuid();
+#endif
+}
+
+CommandLineServer::CommandLineServer(CommandLineParser* parser, const std::string& socketPath):
+  _parser(parser), _socketPath(socketPath), _listenFd(-1), _stopPipe{-1, -1}, _children() {
+  if (::pipe(this->_stopPipe) != 0) {
+    throw CommandLineError(SERVER_ERROR, systemError("pipe()"));
+  }
+  ::fcntl(this->_stopPipe[0], F_SETFD, FD_CLOEXEC);
+  ::fcntl(this->_stopPipe[1], F_SETFD, FD_CLOEXEC);
+  ::fcntl(this->_stopPipe[1], F_SETFL, O_NONBLOCK);
+}
+
+CommandLineServer::~CommandLineServer() {
+  if (this->_listenFd >= 0) {
+    ::close(this->_listenFd);
+    ::unlink(this->_socketPath.c_str());
+  }
+  closeFds(this->_stopPipe, 2);
+}
+
+void CommandLineServer::listen() {
+  sockaddr_un address;
+  if (!makeAddress(this->_socketPath, address)) {
+    throw CommandLineError(SERVER_ERROR, "Socket path is too long: \"" + this->_socketPath + "\"");
+  }
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw CommandLineError(SERVER_ERROR, systemError("socket()"));
+  }
+  ::fcntl(fd, F_SETFD, FD_CLOEXEC);
+
+  // A socket file is only stale if nobody accepts connections on it anymore
+  struct stat st;
+  if (::lstat(this->_socketPath.c_str(), &st) == 0 && S_ISSOCK(st.st_mode)) {
+    int probe = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    bool refused = probe >= 0 && ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 && errno == ECONNREFUSED;
+    if (probe >= 0) ::close(probe);
+    if (!refused) {
+      ::close(fd);
+      throw CommandLineError(SERVER_ERROR, "Cannot listen on \"" + this->_socketPath + "\": the socket is in use");
+    }
+    ::unlink(this->_socketPath.c_str());
+  }
+  // Clients cannot connect before listen(), so restricting the mode in between leaves no window
+  if (::bind(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0 ||
+      ::chmod(this->_socketPath.c_str(), S_IRUSR | S_IWUSR) != 0 || ::listen(fd, SOMAXCONN) != 0) {
+    std::string message = systemError("Cannot listen on \"" + this->_socketPath + "\"");
+    ::close(fd);
+    throw CommandLineError(SERVER_ERROR, message);
+  }
+  this->_listenFd = fd;
+}
+
+void CommandLineServer::serve() {
+  if (this->_listenFd < 0) {
+    this->listen();
+  }
+
+  pollfd fds[2];
+  fds[0].fd = this->_listenFd;
+  fds[0].events = POLLIN;
+  fds[1].fd = this->_stopPipe[0];
+  fds[1].events = POLLIN;
+
+  for (;;) {
+    // Reap finished connection handlers, and no other children of the process
+    for (size_t i = 0; i < this->_children.size();) {
+      if (::waitpid(this->_children[i], nullptr, WNOHANG) != 0) {
+        this->_children[i] = this->_children.back();
+        this->_children.pop_back();
+      } else {
+        i++;
+      }
+    }
+
+    fds[0].revents = 0;
+    fds[1].revents = 0;
+    int ready = ::poll(fds, 2, 1000);
+    if (ready < 0) {
+      if (errno == EINTR) continue;
+      throw CommandLineError(SERVER_ERROR, systemError("poll()"));
+    }
+    if (fds[1].revents != 0) {
+      char drain[16];
+      while (::read(this->_stopPipe[0], drain, sizeof(drain)) == static_cast<ssize_t>(sizeof(drain))) {}
+      break;
+    }
+    if (fds[0].revents == 0) {
+      continue;
+    }
+
+    int client = ::accept(this->_listenFd, nullptr, nullptr);
+    if (client < 0) {
+      continue;
+    }
+    if (!peerIsOwner(client)) {
+      ::close(client);
+      continue;
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    pid_t pid = ::fork();
+    if (pid == 0) {
+      ::close(this->_listenFd);
+      closeFds(this->_stopPipe, 2);
+      this->_handleConnection(client);
+      ::_exit(0);
+    }
+    if (pid > 0) {
+      this->_children.push_back(pid);
+    }
+    ::close(client);
+  }
+}
+
+void CommandLineServer::stop() {
+  char c = 0;
+  ssize_t ignored = ::write(this->_stopPipe[1], &c, 1);
+  (void)ignored;
+}
+
+// Runs in the per-connection process. The command itself runs in a further
+// child so that exit() calls and crashes inside actions are reported as exit
+// codes instead of silently dropping the connection.
+void CommandLineServer::_handleConnection(int client) {
+  int received[3] = { -1, -1, -1 };
+  uint32_t size = 0;
+
+  char control[CMSG_SPACE(sizeof(received))];
+  iovec iov;
+  iov.iov_base = &size;
+  iov.iov_len = sizeof(size);
+  msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+
+  ssize_t n;
+  do {
+    n = ::recvmsg(client, &message, 0);
+  } while (n < 0 && errno == EINTR);
+  if (n <= 0) {
+    return;
+  }
+  for (cmsghdr* c = CMSG_FIRSTHDR(&message); c != nullptr; c = CMSG_NXTHDR(&message, c)) {
+    if (c->cmsg_level == SOL_SOCKET && c->cmsg_type == SCM_RIGHTS && c->cmsg_len == CMSG_LEN(sizeof(received))) {
+      std::memcpy(received, CMSG_DATA(c), sizeof(received));
+    }
+  }
+  if (received[0] < 0 || (static_cast<size_t>(n) < sizeof(size) &&
+      !readAll(client, reinterpret_cast<char*>(&size) + n, sizeof(size) - static_cast<size_t>(n)))) {
+    closeFds(received, 3);
+    return;
+  }
+
+  std::string payload(size <= maxRequestSize ? size : 0, '\0');
+  std::vector<std::string> args;
+  std::vector<std::string> environment;
+  std::string cwd;
+  size_t offset = 0;
+  if (size > maxRequestSize || !readAll(client, &payload[0], payload.size()) ||
+      !getStrings(payload, offset, args) || !getString(payload, offset, cwd) ||
+      !getStrings(payload, offset, environment)) {
+    closeFds(received, 3);
+    return;
+  }
+
+  pid_t pid = ::fork();
+  if (pid == 0) {
+    ::close(client);
+    std::signal(SIGINT, SIG_DFL);
+    std::signal(SIGTERM, SIG_DFL);
+    for (int i = 0; i < 3; i++) {
+      ::dup2(received[i], i);
+    }
+    closeFds(received, 3);
+    int code = 0;
+    if (::chdir(cwd.c_str()) != 0) {
+      std::cerr << systemError("Cannot change directory to \"" + cwd + "\"") << std::endl;
+      code = 1;
+    } else {
+      applyEnvironment(environment);
+      try {
+        this->_parser->execute(args);
+      } catch (const std::exception& e) {
+        std::cerr << e.what() << std::endl;
+        code = 1;
+      }
+    }
+    std::cout.flush();
+    std::cerr.flush();
+    std::fflush(nullptr);
+    ::_exit(code);
+  }
+  closeFds(received, 3);
+
+  int32_t code = 1;
+  int status = 0;
+  if (pid > 0) {
+    while (::waitpid(pid, &status, 0) < 0 && errno == EINTR) {}
+    if (WIFEXITED(status)) {
+      code = WEXITSTATUS(status);
+    } else if (WIFSIGNALED(status)) {
+      code = 128 + WTERMSIG(status);
+    }
+  }
+  writeAll(client, reinterpret_cast<const char*>(&code), sizeof(code));
+  ::close(client);
+}
+
+int CommandLineServer::forward(const std::string& socketPath, const std::vector<std::string>& args,
+  int stdinFd, int stdoutFd, int stderrFd) {
+  sockaddr_un address;
+  if (!makeAddress(socketPath, address)) {
+    throw CommandLineError(SERVER_ERROR, "Socket path is too long: \"" + socketPath + "\"");
+  }
+
+  std::string payload;
+  putU32(payload, static_cast<uint32_t>(args.size()));
+  for (const std::string& arg : args) {
+    putString(payload, arg);
+  }
+  std::vector<char> cwd(4096);
+  while (::getcwd(cwd.data(), cwd.size()) == nullptr) {
+    if (errno != ERANGE) {
+      throw CommandLineError(SERVER_ERROR, systemError("getcwd()"));
+    }
+    cwd.resize(cwd.size() * 2);
+  }
+  putString(payload, cwd.data());
+  uint32_t envc = 0;
+  for (char** e = environ; *e != nullptr; e++) envc++;
+  putU32(payload, envc);
+  for (char** e = environ; *e != nullptr; e++) {
+    putString(payload, *e);
+  }
+
+  int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) {
+    throw CommandLineError(SERVER_ERROR, systemError("socket()"));
+  }
+  if (::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+    std::string message = systemError("Cannot connect to \"" + socketPath + "\"");
+    ::close(fd);
+    throw CommandLineError(SERVER_ERROR, message);
+  }
+
+  uint32_t size = static_cast<uint32_t>(payload.size());
+  int fds[3] = { stdinFd, stdoutFd, stderrFd };
+  char control[CMSG_SPACE(sizeof(fds))];
+  std::memset(control, 0, sizeof(control));
+  iovec iov;
+  iov.iov_base = &size;
+  iov.iov_len = sizeof(size);
+  msghdr message;
+  std::memset(&message, 0, sizeof(message));
+  message.msg_iov = &iov;
+  message.msg_iovlen = 1;
+  message.msg_control = control;
+  message.msg_controllen = sizeof(control);
+  cmsghdr* c = CMSG_FIRSTHDR(&message);
+  c->cmsg_level = SOL_SOCKET;
+  c->cmsg_type = SCM_RIGHTS;
+  c->cmsg_len = CMSG_LEN(sizeof(fds));
+  std::memcpy(CMSG_DATA(c), fds, sizeof(fds));
+
+  ssize_t n;
+  do {
+    n = ::sendmsg(fd, &message, 0);
+  } while (n < 0 && errno == EINTR);
+  int32_t code = 0;
+  bool ok = n == static_cast<ssize_t>(sizeof(size)) &&
+    writeAll(fd, payload.data(), payload.size()) &&
+    readAll(fd, reinterpret_cast<char*>(&code), sizeof(code));
+  ::close(fd);
+  if (!ok) {
+    throw CommandLineError(SERVER_ERROR, "Lost connection to \"" + socketPath + "\"");
+  }
+  return code;
+}
+
+#endif
+
+}
@@ -1,29 +1,37 @@
 #include "commandline/CommandLineParameter.hpp"
 #include "commandline/CommandLineError.hpp"
 #include "EnvironmentVariable.hpp"
+#include "Pattern.hpp"
 #include <cstddef>
 
 namespace commandline {
 
   CommandLineStringListParameter::CommandLineStringListParameter(const CommandLineStringListDefinition& definition):
     CommandLineParameterWithArgument(definition),
-    _values() {}
+    _values(),
+    _maxValues(0),
+    _pattern(dfa::compileParameterPattern(definition.pattern, definition.parameterLongName)),
+    pattern(definition.pattern) {}
 
   CommandLineParameterKind CommandLineStringListParameter::kind() const {
     return CommandLineParameterKind::StringList;
   }
 
   void CommandLineStringListParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
     if (this->environmentVariable != "") {
-      auto env = commandline::env();
       std::string environmentValue;
-      if (env.find(this->environmentVariable) != env.end()) {
-        this->_values = { env.at(this->environmentVariable) };
+      if (commandline::getEnv(this->environmentVariable, environmentValue)) {
+        if (!this->matchesPattern(environmentValue)) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". It must match the pattern \"" + this->pattern + "\".");
+        }
+        this->_values.get() = { environmentValue };
+        this->_valueSource = CommandLineValueSource::Environment;
         return;
       }
     }
 
-    this->_values = {};
+    this->_values.get() = {};
   }
   void CommandLineStringListParameter::_setValue(bool data) {
     reportInvalidData(data);
@@ -33,15 +41,40 @@ namespace commandline {
   }
   void CommandLineStringListParameter::_setValue(const std::string& data) {
     // reportInvalidData(data);
-    this->_values.push_back(data);
+    if (!this->hasValue()) {
+      // The first occurrence on the command line replaces the environment value
+      this->_values.get().clear();
+    }
+    if (this->_maxValues != 0 && this->_values.get().size() >= this->_maxValues) {
+      throw CommandLineError(TOO_MANY_VALUES, "Too many values for " + this->longName + ", at most " + std::to_string(this->_maxValues) + " are accepted");
+    }
+    this->_checkPattern(data);
+    this->_values.get().push_back(data);
   }
   void CommandLineStringListParameter::_setValue(const std::vector<std::string>& data) {
-    this->_values = data;
+    for (const std::string& value : data) {
+      this->_checkPattern(value);
+    }
+    this->_values.get() = data;
+  }
+
+  void CommandLineStringListParameter::_checkPattern(const std::string& value) const {
+    if (!this->matchesPattern(value)) {
+      throw CommandLineError(INVALID_VALUE, "Invalid value \"" + value + "\" for the parameter " + this->longName + ". Every value must match the pattern \"" + this->pattern + "\".");
+    }
+  }
+
+  void CommandLineStringListParameter::_getSupplementaryNotes(std::vector<std::string>& supplementaryNotes) const {
+    CommandLineParameterWithArgument::_getSupplementaryNotes(supplementaryNotes);
+
+    if (this->pattern != "") {
+      supplementaryNotes.push_back("Every value must match the pattern \"" + this->pattern + "\".");
+    }
   }
 
   void CommandLineStringListParameter::appendToArgList(std::vector<std::string>& argList) const {
-    if (this->_values.size() > 0) {
-      for (const auto& value : this->_values) {
+    if (this->values().size() > 0) {
+      for (const auto& value : this->values()) {
         argList.push_back(this->longName);
         argList.push_back(value);
       }
@@ -49,6 +82,21 @@ namespace commandline {
   }
 
   const std::vector<std::string>& CommandLineStringListParameter::values() const {
-    return this->_values;
+    this->_resolve();
+    return this->_values.get();
+  }
+
+  bool CommandLineStringListParameter::matchesPattern(const std::string& value) const {
+    return this->_pattern == nullptr || this->_pattern->matches(value);
+  }
+
+  void CommandLineStringListParameter::bind(std::vector<std::string>& target) {
+    this->_values.bind(target);
+    this->_bound = true;
+  }
+
+  void CommandLineStringListParameter::_limitValues(size_t maxValues) {
+    this->_maxValues = maxValues;
+    this->_values.get().reserve(maxValues);
   }
 }
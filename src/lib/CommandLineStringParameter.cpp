@@ -1,6 +1,7 @@
 #include "commandline/CommandLineParameter.hpp"
 #include "commandline/CommandLineError.hpp"
 #include "EnvironmentVariable.hpp"
+#include "Pattern.hpp"
 #include <cstddef>
 
 namespace commandline {
@@ -8,8 +9,13 @@ namespace commandline {
   CommandLineStringParameter::CommandLineStringParameter(const CommandLineStringDefinition& definition):
     CommandLineParameterWithArgument(definition),
     _value(""),
-    defaultValue(definition.defaultValue) {
+    _pattern(dfa::compileParameterPattern(definition.pattern, definition.parameterLongName)),
+    defaultValue(definition.defaultValue),
+    pattern(definition.pattern) {
     // validateDefaultValue(true);
+    if (this->defaultValue != "" && !this->matchesPattern(this->defaultValue)) {
+      throw CommandLineError(INVALID_VALUE, "The default value \"" + this->defaultValue + "\" of \"" + this->longName + "\" does not match the pattern \"" + this->pattern + "\"");
+    }
   }
 
   CommandLineParameterKind CommandLineStringParameter::kind() const {
@@ -17,21 +23,25 @@ namespace commandline {
   }
 
   void CommandLineStringParameter::_setValue() {
+    this->_valueSource = CommandLineValueSource::Default;
     if (this->environmentVariable != "") {
-      auto env = commandline::env();
       std::string environmentValue;
-      if (env.find(this->environmentVariable) != env.end()) {
-        this->_value = env.at(this->environmentVariable);
+      if (commandline::getEnv(this->environmentVariable, environmentValue)) {
+        if (!this->matchesPattern(environmentValue)) {
+          throw CommandLineError(INVALID_ENV_VALUE, "Invalid value \"" + environmentValue + "\" for the environment variable " + this->environmentVariable + ". It must match the pattern \"" + this->pattern + "\".");
+        }
+        this->_value.get() = environmentValue;
+        this->_valueSource = CommandLineValueSource::Environment;
         return;
       }
     }
 
     if (this->defaultValue != "") {
-      this->_value = this->defaultValue;
+      this->_value.get() = this->defaultValue;
       return;
     }
 
-    this->_value = "";
+    this->_value.get() = "";
   }
   void CommandLineStringParameter::_setValue(bool data) {
     reportInvalidData(data);
@@ -40,7 +50,10 @@ namespace commandline {
     reportInvalidData(data);
   }
   void CommandLineStringParameter::_setValue(const std::string& data) {
-    this->_value = data;
+    if (!this->matchesPattern(data)) {
+      throw CommandLineError(INVALID_VALUE, "Invalid value \"" + data + "\" for the parameter " + this->longName + ". It must match the pattern \"" + this->pattern + "\".");
+    }
+    this->_value.get() = data;
   }
   void CommandLineStringParameter::_setValue(const std::vector<std::string>& data) {
     reportInvalidData(data);
@@ -52,16 +65,29 @@ namespace commandline {
     if (this->defaultValue.length() < 160) {
       supplementaryNotes.push_back("The default value is \"" + this->defaultValue + "\".");
     }
+    if (this->pattern != "") {
+      supplementaryNotes.push_back("The value must match the pattern \"" + this->pattern + "\".");
+    }
   }
 
   void CommandLineStringParameter::appendToArgList(std::vector<std::string>& argList) const {
-    if (this->_value != "") {
+    if (this->value() != "") {
       argList.push_back(this->longName);
-      argList.push_back(this->_value);
+      argList.push_back(this->value());
     }
   }
 
   const std::string& CommandLineStringParameter::value() const {
-    return this->_value;
+    this->_resolve();
+    return this->_value.get();
+  }
+
+  bool CommandLineStringParameter::matchesPattern(const std::string& value) const {
+    return this->_pattern == nullptr || this->_pattern->matches(value);
+  }
+
+  void CommandLineStringParameter::bind(std::string& target) {
+    this->_value.bind(target);
+    this->_bound = true;
   }
 }
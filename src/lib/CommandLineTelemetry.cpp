@@ -0,0 +1,276 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <thread>
+
+#include "commandline/CommandLineTelemetry.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "MappedFile.hpp"
+
+namespace commandline {
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2, "Telemetry needs lock-free 64-bit atomics to share them between processes");
+
+namespace {
+
+// "CLTELEM" and the layout version
+const uint64_t tableMagic = 0x014d454c45544c43ull;
+
+enum SlotState : uint32_t {
+  Free = 0,
+  // The name is being written
+  Claimed,
+  Ready
+};
+
+struct HistogramData {
+  std::atomic<uint64_t> count;
+  std::atomic<uint64_t> sum;
+  std::atomic<uint64_t> max;
+  std::atomic<uint64_t> buckets[CommandLineHistogram::bucketCount];
+};
+
+struct Slot {
+  std::atomic<uint32_t> state;
+  uint32_t reserved;
+  uint64_t nameHash;
+  char name[CommandLineTelemetry::maxNameLength + 1];
+  std::atomic<uint64_t> runs;
+  std::atomic<uint64_t> failures;
+  HistogramData wallMicros;
+  HistogramData cpuMicros;
+  HistogramData peakRssKiB;
+};
+
+// Zero bytes are a valid empty table, so a new file needs no initialization
+struct Table {
+  std::atomic<uint64_t> magic;
+  uint64_t reserved;
+  Slot slots[CommandLineTelemetry::slotCount];
+};
+
+uint64_t hashName(const std::string& name) {
+  uint64_t hash = 14695981039346656037ull;
+  for (char c : name) {
+    hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+  }
+  return hash;
+}
+
+void add(HistogramData& histogram, uint64_t value) {
+  histogram.count.fetch_add(1, std::memory_order_relaxed);
+  histogram.sum.fetch_add(value, std::memory_order_relaxed);
+  histogram.buckets[CommandLineHistogram::bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+  uint64_t max = histogram.max.load(std::memory_order_relaxed);
+  while (value > max && !histogram.max.compare_exchange_weak(max, value, std::memory_order_relaxed)) {}
+}
+
+void copy(const HistogramData& from, CommandLineHistogram& to) {
+  to.count = from.count.load(std::memory_order_relaxed);
+  to.sum = from.sum.load(std::memory_order_relaxed);
+  to.max = from.max.load(std::memory_order_relaxed);
+  for (size_t i = 0; i < CommandLineHistogram::bucketCount; i++) {
+    to.buckets[i] = from.buckets[i].load(std::memory_order_relaxed);
+  }
+}
+
+// The slot of name, claiming a free one for a new name. Null if the table is full.
+Slot* findSlot(Table& table, const std::string& name) {
+  uint64_t hash = hashName(name);
+  for (size_t probe = 0; probe < CommandLineTelemetry::slotCount; probe++) {
+    Slot& slot = table.slots[(hash + probe) % CommandLineTelemetry::slotCount];
+    uint32_t state = slot.state.load(std::memory_order_acquire);
+    if (state == Free) {
+      if (slot.state.compare_exchange_strong(state, Claimed, std::memory_order_acquire)) {
+        slot.nameHash = hash;
+        std::memcpy(slot.name, name.data(), name.size());
+        slot.state.store(Ready, std::memory_order_release);
+        return &slot;
+      }
+    }
+    // Another process is writing the name; give up on the slot if it died meanwhile
+    for (int spin = 0; state == Claimed && spin < 1000; spin++) {
+      std::this_thread::yield();
+      state = slot.state.load(std::memory_order_acquire);
+    }
+    if (state == Ready && slot.nameHash == hash && std::strncmp(slot.name, name.c_str(), sizeof(slot.name)) == 0) {
+      return &slot;
+    }
+  }
+  return nullptr;
+}
+
+std::string formatMicros(uint64_t micros) {
+  char text[32];
+  if (micros < 1000) {
+    snprintf(text, sizeof(text), "%uus", static_cast<unsigned>(micros));
+  } else if (micros < 1000000) {
+    snprintf(text, sizeof(text), "%.2fms", micros / 1e3);
+  } else {
+    snprintf(text, sizeof(text), "%.2fs", micros / 1e6);
+  }
+  return text;
+}
+
+std::string formatKiB(uint64_t kib) {
+  char text[32];
+  if (kib < 1024) {
+    snprintf(text, sizeof(text), "%uKiB", static_cast<unsigned>(kib));
+  } else if (kib < 1024 * 1024) {
+    snprintf(text, sizeof(text), "%.1fMiB", kib / 1024.0);
+  } else {
+    snprintf(text, sizeof(text), "%.1fGiB", kib / (1024.0 * 1024.0));
+  }
+  return text;
+}
+
+std::string column(const std::string& text, size_t width) {
+  return text.size() < width ? std::string(width - text.size(), ' ') + text : " " + text;
+}
+
+std::string renderRow(const std::string& label, const CommandLineHistogram& histogram, std::string (*format)(uint64_t)) {
+  std::string row = "  " + label + std::string(12 - label.size(), ' ');
+  row += column(format(histogram.percentile(0.5)), 10);
+  row += column(format(histogram.percentile(0.9)), 10);
+  row += column(format(histogram.percentile(0.99)), 10);
+  row += column(format(histogram.max), 10);
+  return row + "\n";
+}
+
+}
+
+CommandLineHistogram::CommandLineHistogram():
+  count(0),
+  sum(0),
+  max(0),
+  buckets(bucketCount, 0) {}
+
+size_t CommandLineHistogram::bucketOf(uint64_t value) {
+  if (value < 16) {
+    return static_cast<size_t>(value);
+  }
+  size_t exponent = 0;
+  for (uint64_t v = value; v > 1; v >>= 1) {
+    exponent++;
+  }
+  // The three bits below the leading one pick the sub-bucket
+  return 16 + (exponent - 4) * 8 + static_cast<size_t>((value >> (exponent - 3)) & 7);
+}
+
+uint64_t CommandLineHistogram::bucketLimit(size_t bucket) {
+  if (bucket < 16) {
+    return bucket;
+  }
+  size_t exponent = (bucket - 16) / 8 + 4;
+  uint64_t width = 1ull << (exponent - 3);
+  return (8 + (bucket - 16) % 8) * width + (width - 1);
+}
+
+void CommandLineHistogram::add(uint64_t value) {
+  this->count++;
+  this->sum += value;
+  this->max = std::max(this->max, value);
+  this->buckets[bucketOf(value)]++;
+}
+
+uint64_t CommandLineHistogram::percentile(double p) const {
+  if (this->count == 0) {
+    return 0;
+  }
+  uint64_t rank = static_cast<uint64_t>(std::ceil(p * static_cast<double>(this->count)));
+  rank = std::min(std::max<uint64_t>(rank, 1), this->count);
+  uint64_t seen = 0;
+  for (size_t i = 0; i < this->buckets.size(); i++) {
+    seen += this->buckets[i];
+    if (seen >= rank) {
+      return std::min(bucketLimit(i), this->max);
+    }
+  }
+  return this->max;
+}
+
+CommandLineTelemetry::CommandLineTelemetry(const std::string& path): _data(nullptr) {
+  std::string error;
+  this->_data = mapped::map(path, sizeof(Table), true, error);
+  if (this->_data == nullptr) {
+    throw CommandLineError(TELEMETRY_FAILED, "Unable to open the telemetry file \"" + path + "\": " + error);
+  }
+  uint64_t magic = 0;
+  Table* table = static_cast<Table*>(this->_data);
+  if (!table->magic.compare_exchange_strong(magic, tableMagic) && magic != tableMagic) {
+    mapped::unmap(this->_data, sizeof(Table));
+    throw CommandLineError(TELEMETRY_FAILED, "\"" + path + "\" is not a telemetry file of this version");
+  }
+}
+
+CommandLineTelemetry::~CommandLineTelemetry() {
+  mapped::unmap(this->_data, sizeof(Table));
+}
+
+void CommandLineTelemetry::record(const std::string& actionName, const CommandLineExecutionSample& sample) {
+  Slot* slot = findSlot(*static_cast<Table*>(this->_data), actionName.substr(0, maxNameLength));
+  if (slot == nullptr) {
+    return;
+  }
+  add(slot->wallMicros, sample.wallMicros);
+  add(slot->cpuMicros, sample.cpuMicros);
+  add(slot->peakRssKiB, sample.peakRssKiB);
+  if (sample.failed) {
+    slot->failures.fetch_add(1, std::memory_order_relaxed);
+  }
+  slot->runs.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::vector<CommandLineActionTelemetry> CommandLineTelemetry::read(const std::string& path) {
+  std::string error;
+  void* data = mapped::map(path, sizeof(Table), false, error);
+  if (data == nullptr) {
+    throw CommandLineError(TELEMETRY_FAILED, "Unable to read the telemetry file \"" + path + "\": " + error);
+  }
+  const Table* table = static_cast<const Table*>(data);
+  if (table->magic.load() != tableMagic) {
+    mapped::unmap(data, sizeof(Table));
+    throw CommandLineError(TELEMETRY_FAILED, "\"" + path + "\" is not a telemetry file of this version");
+  }
+
+  std::vector<CommandLineActionTelemetry> actions;
+  for (const Slot& slot : table->slots) {
+    if (slot.state.load(std::memory_order_acquire) != Ready) {
+      continue;
+    }
+    CommandLineActionTelemetry action;
+    action.actionName.assign(slot.name, strnlen(slot.name, sizeof(slot.name)));
+    action.runs = slot.runs.load(std::memory_order_relaxed);
+    action.failures = slot.failures.load(std::memory_order_relaxed);
+    copy(slot.wallMicros, action.wallMicros);
+    copy(slot.cpuMicros, action.cpuMicros);
+    copy(slot.peakRssKiB, action.peakRssKiB);
+    actions.push_back(std::move(action));
+  }
+  mapped::unmap(data, sizeof(Table));
+
+  std::sort(actions.begin(), actions.end(), [](const CommandLineActionTelemetry& a, const CommandLineActionTelemetry& b) {
+    return a.actionName < b.actionName;
+  });
+  return actions;
+}
+
+std::string CommandLineTelemetry::renderReport(const std::vector<CommandLineActionTelemetry>& actions) {
+  std::string report;
+  for (const CommandLineActionTelemetry& action : actions) {
+    if (!report.empty()) {
+      report += "\n";
+    }
+    report += action.actionName + ": " + std::to_string(action.runs) + (action.runs == 1 ? " run, " : " runs, ") +
+      std::to_string(action.failures) + " failed\n";
+    report += std::string(14, ' ') + column("p50", 10) + column("p90", 10) + column("p99", 10) + column("max", 10) + "\n";
+    report += renderRow("wall time", action.wallMicros, formatMicros);
+    report += renderRow("cpu time", action.cpuMicros, formatMicros);
+    report += renderRow("peak rss +", action.peakRssKiB, formatKiB);
+  }
+  return report;
+}
+
+}
@@ -0,0 +1,109 @@
+#include <cstring>
+
+#include "commandline/CommandLineText.hpp"
+#include "commandline/CommandLineTextResource.hpp"
+
+namespace commandline {
+
+CommandLineText::CommandLineText(): _static(""), _size(0), _owned(), _resource(nullptr), _offset(0) {}
+
+CommandLineText::CommandLineText(const std::string& text): _static(nullptr), _size(text.size()), _owned(text), _resource(nullptr), _offset(0) {}
+
+CommandLineText::CommandLineText(const char* text): _static(nullptr), _size(0), _owned(text), _resource(nullptr), _offset(0) {
+  this->_size = this->_owned.size();
+}
+
+CommandLineText CommandLineText::fromStatic(const char* text) {
+  return fromStatic(text, std::strlen(text));
+}
+
+CommandLineText CommandLineText::fromStatic(const char* text, size_t size) {
+  CommandLineText result;
+  result._static = text;
+  result._size = size;
+  return result;
+}
+
+CommandLineText CommandLineText::fromResource(const CommandLineTextResource& resource, size_t offset, size_t size) {
+  CommandLineText result;
+  result._static = nullptr;
+  result._size = size;
+  result._resource = &resource;
+  result._offset = offset;
+  return result;
+}
+
+const char* CommandLineText::data() const {
+  if (this->_resource != nullptr) {
+    return this->_resource->_data() + this->_offset;
+  }
+  return this->_static != nullptr ? this->_static : this->_owned.c_str();
+}
+
+size_t CommandLineText::size() const {
+  return this->_size;
+}
+
+bool CommandLineText::empty() const {
+  return this->_size == 0;
+}
+
+bool CommandLineText::isStatic() const {
+  return this->_static != nullptr;
+}
+
+bool CommandLineText::isCompressed() const {
+  return this->_resource != nullptr;
+}
+
+std::string CommandLineText::str() const {
+  return std::string(this->data(), this->_size);
+}
+
+CommandLineText::operator std::string() const {
+  return this->str();
+}
+
+bool operator==(const CommandLineText& a, const CommandLineText& b) {
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool operator==(const CommandLineText& a, const std::string& b) {
+  return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+bool operator==(const CommandLineText& a, const char* b) {
+  return a.size() == std::strlen(b) && std::memcmp(a.data(), b, a.size()) == 0;
+}
+
+bool operator!=(const CommandLineText& a, const CommandLineText& b) {
+  return !(a == b);
+}
+
+bool operator!=(const CommandLineText& a, const std::string& b) {
+  return !(a == b);
+}
+
+bool operator!=(const CommandLineText& a, const char* b) {
+  return !(a == b);
+}
+
+std::string operator+(const std::string& a, const CommandLineText& b) {
+  std::string result;
+  result.reserve(a.size() + b.size());
+  result.append(a).append(b.data(), b.size());
+  return result;
+}
+
+std::string operator+(const CommandLineText& a, const std::string& b) {
+  std::string result;
+  result.reserve(a.size() + b.size());
+  result.append(a.data(), a.size()).append(b);
+  return result;
+}
+
+std::ostream& operator<<(std::ostream& out, const CommandLineText& text) {
+  return out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+}
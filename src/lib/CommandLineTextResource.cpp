@@ -0,0 +1,113 @@
+#include "commandline/CommandLineTextResource.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "Lz.hpp"
+
+namespace commandline {
+
+// Blob layout, little-endian: text count, decompressed size, the end offset
+// of every text in the decompressed data, then the compressed data.
+static const size_t headerFields = 2;
+
+static uint32_t readU32(const unsigned char* p) {
+  return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+static void writeU32(std::string& out, uint32_t v) {
+  for (int shift = 0; shift < 32; shift += 8) {
+    out += static_cast<char>((v >> shift) & 0xff);
+  }
+}
+
+CommandLineTextResource::CommandLineTextResource(const unsigned char* blob, size_t size):
+  _ownedBlob(),
+  _blob(blob),
+  _blobSize(size),
+  _count(0),
+  _textSize(0),
+  _once(),
+  _loaded(false),
+  _text() {
+  this->_readHeader();
+}
+
+CommandLineTextResource::CommandLineTextResource(const std::string& blob):
+  _ownedBlob(blob),
+  _blob(nullptr),
+  _blobSize(blob.size()),
+  _count(0),
+  _textSize(0),
+  _once(),
+  _loaded(false),
+  _text() {
+  this->_blob = reinterpret_cast<const unsigned char*>(this->_ownedBlob.data());
+  this->_readHeader();
+}
+
+void CommandLineTextResource::_readHeader() {
+  if (this->_blobSize < headerFields * 4) {
+    throw CommandLineError(RESOURCE_INVALID, "The text resource is truncated");
+  }
+  this->_count = readU32(this->_blob);
+  this->_textSize = readU32(this->_blob + 4);
+  if ((this->_blobSize - headerFields * 4) / 4 < this->_count) {
+    throw CommandLineError(RESOURCE_INVALID, "The text resource is truncated");
+  }
+  uint32_t previous = 0;
+  for (size_t i = 0; i < this->_count; i++) {
+    uint32_t end = this->_end(i);
+    if (end < previous || end > this->_textSize) {
+      throw CommandLineError(RESOURCE_INVALID, "The index of the text resource is invalid");
+    }
+    previous = end;
+  }
+}
+
+uint32_t CommandLineTextResource::_end(size_t index) const {
+  return readU32(this->_blob + (headerFields + index) * 4);
+}
+
+std::string CommandLineTextResource::pack(const std::vector<std::string>& texts) {
+  std::string text;
+  std::string blob;
+  writeU32(blob, static_cast<uint32_t>(texts.size()));
+  size_t total = 0;
+  for (const std::string& t : texts) {
+    total += t.size();
+  }
+  writeU32(blob, static_cast<uint32_t>(total));
+  text.reserve(total);
+  for (const std::string& t : texts) {
+    text += t;
+    writeU32(blob, static_cast<uint32_t>(text.size()));
+  }
+  return blob + lz::compress(text);
+}
+
+size_t CommandLineTextResource::size() const {
+  return this->_count;
+}
+
+CommandLineText CommandLineTextResource::text(size_t index) const {
+  if (index >= this->_count) {
+    throw CommandLineError(RESOURCE_INVALID, "The text resource has no text " + std::to_string(index));
+  }
+  uint32_t begin = index == 0 ? 0 : this->_end(index - 1);
+  return CommandLineText::fromResource(*this, begin, this->_end(index) - begin);
+}
+
+bool CommandLineTextResource::isLoaded() const {
+  return this->_loaded.load(std::memory_order_acquire);
+}
+
+const char* CommandLineTextResource::_data() const {
+  std::call_once(this->_once, [this]() {
+    size_t dataOffset = (headerFields + this->_count) * 4;
+    if (!lz::decompress(this->_blob + dataOffset, this->_blobSize - dataOffset, this->_textSize, this->_text)) {
+      throw CommandLineError(RESOURCE_INVALID, "The text resource is damaged");
+    }
+    this->_loaded.store(true, std::memory_order_release);
+  });
+  return this->_text.c_str();
+}
+
+}
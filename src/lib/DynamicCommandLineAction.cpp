@@ -2,10 +2,31 @@
 
 namespace commandline {
 
-DynamicCommandLineAction::DynamicCommandLineAction(): CommandLineAction() {}
-DynamicCommandLineAction::DynamicCommandLineAction(const CommandLineActionOptions& options): CommandLineAction(options) {}
+DynamicCommandLineAction::DynamicCommandLineAction():
+  CommandLineAction(),
+  _defineParametersCallback(nullptr),
+  _executeCallback(nullptr) {}
 
-void DynamicCommandLineAction::onDefineParameters() {}
-void DynamicCommandLineAction::onExecute() {}
+DynamicCommandLineAction::DynamicCommandLineAction(const CommandLineActionOptions& options):
+  CommandLineAction(options),
+  _defineParametersCallback(nullptr),
+  _executeCallback(nullptr) {}
+
+void DynamicCommandLineAction::setCallbacks(DefineParametersCallback onDefineParameters, ExecuteCallback onExecute) {
+  this->_defineParametersCallback = onDefineParameters;
+  this->_executeCallback = onExecute;
+}
+
+void DynamicCommandLineAction::onDefineParameters() {
+  if (this->_defineParametersCallback != nullptr) {
+    this->_defineParametersCallback(this);
+  }
+}
+
+void DynamicCommandLineAction::onExecute() {
+  if (this->_executeCallback != nullptr) {
+    this->_executeCallback(this);
+  }
+}
 
 }
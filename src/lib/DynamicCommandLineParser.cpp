@@ -1,8 +1,365 @@
 #include "commandline/DynamicCommandLineParser.hpp"
+#include "commandline/CommandLinePluginAction.hpp"
+#include "commandline/CommandLineError.hpp"
+#include "Json.hpp"
+#include "ValueParser.hpp"
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <cstring>
+#include <sys/stat.h>
+#ifdef _WIN32
+#include <process.h>
+#define getpid _getpid
+#else
+#include <unistd.h>
+#endif
 
 namespace commandline {
 
 DynamicCommandLineParser::DynamicCommandLineParser(): CommandLineParser() {}
 DynamicCommandLineParser::DynamicCommandLineParser(const CommandLineParserOptions& options): CommandLineParser(options) {}
 
+static bool isAbsolutePath(const std::string& path) {
+  if (path.length() > 0 && (path[0] == '/' || path[0] == '\\')) {
+    return true;
+  }
+  return path.length() > 1 && path[1] == ':';
+}
+
+void DynamicCommandLineParser::loadPluginManifest(const std::string& manifestPath) {
+  std::ifstream file(manifestPath);
+  if (!file.is_open()) {
+    throw CommandLineError(PLUGIN_MANIFEST_INVALID, "Unable to open the plugin manifest \"" + manifestPath + "\"");
+  }
+
+  std::string directory = "";
+  size_t slash = manifestPath.find_last_of("/\\");
+  if (slash != std::string::npos) {
+    directory = manifestPath.substr(0, slash + 1);
+  }
+
+  std::string line;
+  size_t lineNumber = 0;
+  while (std::getline(file, line)) {
+    lineNumber++;
+    if (line.length() > 0 && line[line.length() - 1] == '\r') {
+      line.pop_back();
+    }
+    if (line == "" || line[0] == '#') {
+      continue;
+    }
+
+    std::string fields[3];
+    size_t start = 0;
+    for (size_t f = 0; f < 3; f++) {
+      size_t tab = line.find('\t', start);
+      if (tab == std::string::npos) {
+        throw CommandLineError(PLUGIN_MANIFEST_INVALID, "Invalid plugin manifest entry at " + manifestPath + ":" + std::to_string(lineNumber) + ". Expected: <name>\\t<library>\\t<symbol>\\t<summary>");
+      }
+      fields[f] = line.substr(start, tab - start);
+      start = tab + 1;
+    }
+
+    CommandLinePluginManifestEntry entry;
+    entry.actionName = fields[0];
+    entry.libraryPath = isAbsolutePath(fields[1]) ? fields[1] : directory + fields[1];
+    entry.entrySymbol = fields[2];
+    entry.summary = line.substr(start);
+    this->addAction(new CommandLinePluginAction(entry));
+  }
+}
+
+static const char specCacheMagic[8] = { 'C', 'L', 'S', 'P', 'E', 'C', '0', '3' };
+
+struct SpecCacheHeader {
+  char magic[8];
+  int64_t mtime;
+  uint64_t size;
+};
+
+static int64_t modificationTime(const struct stat& st) {
+#if defined(__APPLE__)
+  return static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1000000000 + st.st_mtimespec.tv_nsec;
+#elif defined(_WIN32)
+  return static_cast<int64_t>(st.st_mtime) * 1000000000;
+#else
+  return static_cast<int64_t>(st.st_mtim.tv_sec) * 1000000000 + st.st_mtim.tv_nsec;
+#endif
+}
+
+static bool readFile(const std::string& path, std::string& content) {
+  std::ifstream file(path, std::ios::binary);
+  if (!file.is_open()) {
+    return false;
+  }
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  content = oss.str();
+  return true;
+}
+
+static bool readCache(const std::string& path, const SpecCacheHeader& header, json::Value& root) {
+  std::ifstream file(path, std::ios::binary);
+  SpecCacheHeader cachedHeader;
+  if (!file.is_open() || !file.read(reinterpret_cast<char*>(&cachedHeader), sizeof(SpecCacheHeader)) ||
+    memcmp(cachedHeader.magic, header.magic, sizeof(header.magic)) != 0 ||
+    cachedHeader.mtime != header.mtime || cachedHeader.size != header.size) {
+    return false;
+  }
+  std::ostringstream oss;
+  oss << file.rdbuf();
+  std::string data = oss.str();
+  size_t offset = 0;
+  if (json::decode(data, offset, root) && offset == data.length()) {
+    return true;
+  }
+  root = json::Value();
+  return false;
+}
+
+static void writeCache(const std::string& path, const SpecCacheHeader& header, const json::Value& root) {
+  std::string out(reinterpret_cast<const char*>(&header), sizeof(SpecCacheHeader));
+  json::encode(root, out);
+  const std::string temporaryPath = path + "." + std::to_string(getpid()) + ".tmp";
+  {
+    std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+      return;
+    }
+    if (!file.write(out.data(), out.length()) || !file.flush()) {
+      file.close();
+      std::remove(temporaryPath.c_str());
+      return;
+    }
+  }
+  if (std::rename(temporaryPath.c_str(), path.c_str()) != 0) {
+#ifdef _WIN32
+    // rename() does not replace an existing file on Windows
+    std::remove(path.c_str());
+    if (std::rename(temporaryPath.c_str(), path.c_str()) == 0) {
+      return;
+    }
+#endif
+    std::remove(temporaryPath.c_str());
+  }
+}
+
+static const json::Value* specField(const json::Value& object, const char* key, json::Type type, const std::string& where) {
+  const json::Value* value = object.get(key);
+  if (value == nullptr || value->type == json::Null) {
+    return nullptr;
+  }
+  if (value->type != type) {
+    throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + "." + key + "\" has an unexpected type");
+  }
+  return value;
+}
+
+static std::string specString(const json::Value& object, const char* key, const std::string& where, const std::string& fallback = "") {
+  const json::Value* value = specField(object, key, json::String, where);
+  return value != nullptr ? value->string : fallback;
+}
+
+static const json::Value* specNumber(const json::Value& object, const char* key, const std::string& where) {
+  return specField(object, key, json::Number, where);
+}
+
+// Numbers with a fraction or exponent, and integers beyond int64_t, are rejected rather than truncated
+static const json::Value* specInteger(const json::Value& object, const char* key, const std::string& where, int64_t minimum) {
+  const json::Value* value = specNumber(object, key, where);
+  if (value != nullptr && (!value->integral || value->number < minimum)) {
+    throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + "." + key + "\" must be an integer from " + std::to_string(minimum) + " to " + std::to_string(INT64_MAX));
+  }
+  return value;
+}
+
+// ByteSize and Duration values are written with their units, e.g. "64MiB" or "1500ms".
+template <typename T>
+static bool specUnitValue(const json::Value& object, const char* key, const std::string& where,
+  const char* (*parse)(const std::string&, T&, size_t&), T& out) {
+  const json::Value* value = specField(object, key, json::String, where);
+  if (value == nullptr) {
+    return false;
+  }
+  size_t offset = 0;
+  const char* error = parse(value->string, out, offset);
+  if (error != nullptr) {
+    throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + "." + key + "\": " + error + " at offset " + std::to_string(offset));
+  }
+  return true;
+}
+
+static void specParameterBase(const json::Value& object, const std::string& where, BaseCommandLineDefinition& definition) {
+  definition.parameterLongName = specString(object, "parameterLongName", where);
+  definition.parameterShortName = specString(object, "parameterShortName", where);
+  definition.description = specString(object, "description", where);
+  definition.environmentVariable = specString(object, "environmentVariable", where);
+  const json::Value* required = specField(object, "required", json::Boolean, where);
+  definition.required = required != nullptr && required->boolean;
+}
+
+static void specParameters(CommandLineParameterProvider* provider, const json::Value& scope, const std::string& scopeName) {
+  const json::Value* parameters = specField(scope, "parameters", json::Array, scopeName);
+  if (parameters != nullptr) {
+    for (size_t i = 0; i < parameters->array.size(); i++) {
+      const json::Value& p = parameters->array[i];
+      std::string where = scopeName + ".parameters[" + std::to_string(i) + "]";
+      if (p.type != json::Object) {
+        throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + "\" must be an object");
+      }
+      std::string kind = specString(p, "kind", where);
+      if (kind == "Choice") {
+        CommandLineChoiceDefinition definition;
+        specParameterBase(p, where, definition);
+        const json::Value* alternatives = specField(p, "alternatives", json::Array, where);
+        if (alternatives != nullptr) {
+          for (const json::Value& alternative : alternatives->array) {
+            if (alternative.type != json::String) {
+              throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + ".alternatives\" must only contain strings");
+            }
+            definition.alternatives.push_back(alternative.string);
+          }
+        }
+        definition.defaultValue = specString(p, "defaultValue", where);
+        provider->defineChoiceParameter(definition);
+      } else if (kind == "Flag") {
+        CommandLineFlagDefinition definition;
+        specParameterBase(p, where, definition);
+        const json::Value* defaultValue = specField(p, "defaultValue", json::Boolean, where);
+        definition.defaultValue = defaultValue != nullptr && defaultValue->boolean;
+        provider->defineFlagParameter(definition);
+      } else if (kind == "Integer") {
+        CommandLineIntegerDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        const json::Value* defaultValue = specInteger(p, "defaultValue", where, INT64_MIN);
+        definition.defaultValue = defaultValue != nullptr ? defaultValue->number : 0;
+        provider->defineIntegerParameter(definition);
+      } else if (kind == "Double") {
+        CommandLineDoubleDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        const json::Value* number;
+        if ((number = specNumber(p, "defaultValue", where)) != nullptr) definition.defaultValue = number->real;
+        if ((number = specNumber(p, "minimum", where)) != nullptr) definition.minimum = number->real;
+        if ((number = specNumber(p, "maximum", where)) != nullptr) definition.maximum = number->real;
+        provider->defineDoubleParameter(definition);
+      } else if (kind == "Unsigned") {
+        CommandLineUnsignedDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        const json::Value* number;
+        if ((number = specInteger(p, "defaultValue", where, 0)) != nullptr) definition.defaultValue = static_cast<uint64_t>(number->number);
+        if ((number = specInteger(p, "minimum", where, 0)) != nullptr) definition.minimum = static_cast<uint64_t>(number->number);
+        if ((number = specInteger(p, "maximum", where, 0)) != nullptr) definition.maximum = static_cast<uint64_t>(number->number);
+        provider->defineUnsignedParameter(definition);
+      } else if (kind == "ByteSize") {
+        CommandLineByteSizeDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        specUnitValue(p, "defaultValue", where, commandline::value::parseByteSize, definition.defaultValue);
+        specUnitValue(p, "minimum", where, commandline::value::parseByteSize, definition.minimum);
+        specUnitValue(p, "maximum", where, commandline::value::parseByteSize, definition.maximum);
+        provider->defineByteSizeParameter(definition);
+      } else if (kind == "Duration") {
+        CommandLineDurationDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        int64_t nanoseconds;
+        if (specUnitValue(p, "defaultValue", where, commandline::value::parseDuration, nanoseconds)) definition.defaultValue = std::chrono::nanoseconds(nanoseconds);
+        if (specUnitValue(p, "minimum", where, commandline::value::parseDuration, nanoseconds)) definition.minimum = std::chrono::nanoseconds(nanoseconds);
+        if (specUnitValue(p, "maximum", where, commandline::value::parseDuration, nanoseconds)) definition.maximum = std::chrono::nanoseconds(nanoseconds);
+        provider->defineDurationParameter(definition);
+      } else if (kind == "String") {
+        CommandLineStringDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        definition.defaultValue = specString(p, "defaultValue", where);
+        definition.pattern = specString(p, "pattern", where);
+        provider->defineStringParameter(definition);
+      } else if (kind == "StringList") {
+        CommandLineStringListDefinition definition;
+        specParameterBase(p, where, definition);
+        definition.argumentName = specString(p, "argumentName", where);
+        definition.pattern = specString(p, "pattern", where);
+        provider->defineStringListParameter(definition);
+      } else {
+        throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + ".kind\" has the unknown value \"" + kind + "\"");
+      }
+    }
+  }
+
+  const json::Value* remainder = specField(scope, "remainder", json::Object, scopeName);
+  if (remainder != nullptr) {
+    CommandLineRemainderDefinition definition;
+    definition.argumentName = specString(*remainder, "argumentName", scopeName + ".remainder", definition.argumentName);
+    definition.description = specString(*remainder, "description", scopeName + ".remainder");
+    provider->defineCommandLineRemainder(definition);
+  }
+}
+
+void DynamicCommandLineParser::loadSpec(const std::string& specPath, bool useCache) {
+  struct stat st;
+  if (stat(specPath.c_str(), &st) != 0) {
+    throw CommandLineError(SPEC_INVALID, "Unable to open the spec \"" + specPath + "\"");
+  }
+  SpecCacheHeader header;
+  memcpy(header.magic, specCacheMagic, sizeof(header.magic));
+  header.mtime = modificationTime(st);
+  header.size = static_cast<uint64_t>(st.st_size);
+
+  const std::string cachePath = specPath + ".cache";
+  json::Value root;
+  bool cached = useCache && readCache(cachePath, header, root);
+  if (!cached) {
+    std::string text;
+    if (!readFile(specPath, text)) {
+      throw CommandLineError(SPEC_INVALID, "Unable to open the spec \"" + specPath + "\"");
+    }
+    std::string error;
+    if (!json::parse(text, root, error)) {
+      throw CommandLineError(SPEC_INVALID, "Invalid spec \"" + specPath + "\": " + error);
+    }
+  }
+  if (root.type != json::Object) {
+    throw CommandLineError(SPEC_INVALID, "Invalid spec \"" + specPath + "\": the root must be an object");
+  }
+
+  if (root.get("toolFilename") != nullptr || root.get("toolDescription") != nullptr) {
+    CommandLineParserOptions options = this->_options;
+    options.toolFilename = specString(root, "toolFilename", "spec", this->toolFilename);
+    options.toolDescription = specString(root, "toolDescription", "spec", this->toolDescription);
+    this->_init(options);
+  }
+
+  specParameters(this, root, "spec");
+
+  const json::Value* actions = specField(root, "actions", json::Array, "spec");
+  if (actions != nullptr) {
+    for (size_t i = 0; i < actions->array.size(); i++) {
+      const json::Value& a = actions->array[i];
+      std::string where = "spec.actions[" + std::to_string(i) + "]";
+      if (a.type != json::Object) {
+        throw CommandLineError(SPEC_INVALID, "Invalid spec: \"" + where + "\" must be an object");
+      }
+      CommandLineActionOptions options;
+      options.actionName = specString(a, "actionName", where);
+      options.summary = specString(a, "summary", where);
+      options.documentation = specString(a, "documentation", where, options.summary);
+      int64_t timeout;
+      if (specUnitValue(a, "timeout", where, commandline::value::parseDuration, timeout)) {
+        options.timeout = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::nanoseconds(timeout));
+      }
+      DynamicCommandLineAction* action = new DynamicCommandLineAction(options);
+      this->addAction(action);
+      specParameters(action, a, where);
+    }
+  }
+
+  if (useCache && !cached) {
+    writeCache(cachePath, header, root);
+  }
+}
+
 }
@@ -5,6 +5,8 @@
 #include <Windows.h>
 #endif
 
+#include <cstdlib>
+
 #include "EnvironmentVariable.hpp"
 #include "StringUtil.hpp"
 
@@ -22,8 +24,13 @@ extern char** environ;
 
 namespace commandline {
 
+static std::map<std::string, std::string> _env;
+
+void resetEnv() {
+  _env.clear();
+}
+
 const std::map<std::string, std::string>& env() {
-  static std::map<std::string, std::string> _env;
   if (_env.size() == 0) {
 #ifdef _WIN32
     wchar_t* environment = GetEnvironmentStringsW();
@@ -54,4 +61,27 @@ const std::map<std::string, std::string>& env() {
   return _env;
 }
 
+bool getEnv(const std::string& name, std::string& value) {
+#ifdef _WIN32
+  // Variable names are restricted to ASCII by the parameter definition
+  std::wstring wname(name.begin(), name.end());
+  DWORD size = GetEnvironmentVariableW(wname.c_str(), nullptr, 0);
+  if (size == 0) {
+    return false;
+  }
+  std::wstring wvalue(size, L'\0');
+  size = GetEnvironmentVariableW(wname.c_str(), &wvalue[0], size);
+  wvalue.resize(size);
+  value = commandline::string::w2a(wvalue);
+  return true;
+#else
+  const char* found = std::getenv(name.c_str());
+  if (found == nullptr) {
+    return false;
+  }
+  value = found;
+  return true;
+#endif
+}
+
 }
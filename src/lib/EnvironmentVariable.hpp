@@ -6,6 +6,10 @@
 
 namespace commandline {
   const std::map<std::string, std::string>& env();
+  // Drops the cached copy so that env() reflects later setenv() calls.
+  void resetEnv();
+  // Reads a single variable from the live environment, without building the env() map.
+  bool getEnv(const std::string& name, std::string& value);
 }
 
 #endif
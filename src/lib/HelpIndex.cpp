@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "HelpIndex.hpp"
+
+namespace commandline {
+
+namespace help {
+
+std::vector<std::string> words(const std::string& text) {
+  std::vector<std::string> result;
+  std::string word;
+  for (char c : text) {
+    unsigned char u = static_cast<unsigned char>(c);
+    if ((u >= 'a' && u <= 'z') || (u >= '0' && u <= '9')) {
+      word += c;
+    } else if (u >= 'A' && u <= 'Z') {
+      word += static_cast<char>(u | 0x20);
+    } else if (!word.empty()) {
+      result.push_back(word);
+      word.clear();
+    }
+  }
+  if (!word.empty()) {
+    result.push_back(word);
+  }
+  return result;
+}
+
+void Index::add(uint32_t document, const std::string& text, uint32_t weight) {
+  for (std::string& word : words(text)) {
+    this->_pending.push_back(std::make_pair(std::move(word), Posting{ document, weight }));
+  }
+}
+
+void Index::freeze() {
+  std::sort(this->_pending.begin(), this->_pending.end(), [](const std::pair<std::string, Posting>& a, const std::pair<std::string, Posting>& b) {
+    return a.first != b.first ? a.first < b.first : a.second.document < b.second.document;
+  });
+  // One posting per term and document, with the weights of all occurrences summed
+  for (const std::pair<std::string, Posting>& entry : this->_pending) {
+    if (this->_terms.empty() || this->_terms.back().first != entry.first) {
+      this->_terms.push_back(std::make_pair(entry.first, std::vector<Posting>()));
+    }
+    std::vector<Posting>& postings = this->_terms.back().second;
+    if (!postings.empty() && postings.back().document == entry.second.document) {
+      postings.back().weight += entry.second.weight;
+    } else {
+      postings.push_back(entry.second);
+    }
+  }
+  std::vector<std::pair<std::string, Posting>>().swap(this->_pending);
+}
+
+std::vector<uint32_t> Index::search(const std::string& query, size_t limit) const {
+  std::vector<std::string> queryWords = words(query);
+  std::unordered_map<uint32_t, uint32_t> scores;
+  for (size_t q = 0; q < queryWords.size(); q++) {
+    const std::string& word = queryWords[q];
+    std::unordered_map<uint32_t, uint32_t> matches;
+    std::vector<std::pair<std::string, std::vector<Posting>>>::const_iterator it = std::lower_bound(this->_terms.begin(), this->_terms.end(), word,
+      [](const std::pair<std::string, std::vector<Posting>>& term, const std::string& w) {
+        return term.first < w;
+      });
+    for (; it != this->_terms.end() && it->first.compare(0, word.size(), word) == 0; ++it) {
+      // A whole word counts more than a prefix
+      uint32_t factor = it->first.size() == word.size() ? 2 : 1;
+      for (const Posting& posting : it->second) {
+        matches[posting.document] += posting.weight * factor;
+      }
+    }
+    // Documents have to match every word of the query
+    if (q == 0) {
+      scores.swap(matches);
+    } else {
+      std::unordered_map<uint32_t, uint32_t> kept;
+      for (const std::pair<const uint32_t, uint32_t>& score : scores) {
+        std::unordered_map<uint32_t, uint32_t>::const_iterator match = matches.find(score.first);
+        if (match != matches.end()) {
+          kept[score.first] = score.second + match->second;
+        }
+      }
+      scores.swap(kept);
+    }
+    if (scores.empty()) {
+      break;
+    }
+  }
+
+  std::vector<std::pair<uint32_t, uint32_t>> ranked(scores.begin(), scores.end());
+  std::sort(ranked.begin(), ranked.end(), [](const std::pair<uint32_t, uint32_t>& a, const std::pair<uint32_t, uint32_t>& b) {
+    return a.second != b.second ? a.second > b.second : a.first < b.first;
+  });
+  std::vector<uint32_t> result;
+  for (size_t i = 0; i < ranked.size() && i < limit; i++) {
+    result.push_back(ranked[i].first);
+  }
+  return result;
+}
+
+}
+
+}
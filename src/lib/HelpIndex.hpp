@@ -0,0 +1,44 @@
+#ifndef __HELP_INDEX_HPP__
+#define __HELP_INDEX_HPP__
+
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace commandline {
+
+// Inverted index behind "help --search": maps the lower-case words of the
+// action names, summaries, documentation and parameter descriptions to the
+// actions they appear in. Built once on the first search.
+namespace help {
+  struct Posting {
+    uint32_t document;
+    uint32_t weight;
+  };
+
+  class Index {
+   private:
+    // Sorted by term after freeze(), so a query word can match by prefix
+    std::vector<std::pair<std::string, std::vector<Posting>>> _terms;
+    std::vector<std::pair<std::string, Posting>> _pending;
+
+   public:
+    /** Adds every word of text to document with the given weight. */
+    void add(uint32_t document, const std::string& text, uint32_t weight);
+    void freeze();
+
+    /**
+     * Documents containing every word of query, or a word starting with it,
+     * best first, at most limit of them.
+     */
+    std::vector<uint32_t> search(const std::string& query, size_t limit) const;
+  };
+
+  /** The lower-case words of text; letters and digits, everything else separates. */
+  std::vector<std::string> words(const std::string& text);
+}
+
+}
+
+#endif
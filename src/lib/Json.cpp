@@ -0,0 +1,409 @@
+#include "Json.hpp"
+#include "ValueParser.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+
+namespace commandline {
+
+namespace json {
+
+const Value* Value::get(const std::string& key) const {
+  for (const auto& member : this->object) {
+    if (member.first == key) {
+      return &member.second;
+    }
+  }
+  return nullptr;
+}
+
+namespace {
+
+// Every array and object level costs a recursion of parseValue()
+const size_t maxDepth = 256;
+
+class Parser {
+ private:
+  const std::string& _text;
+  size_t _pos;
+  size_t _depth;
+  std::string& _error;
+
+  void skipWhitespace() {
+    while (_pos < _text.length() && (_text[_pos] == ' ' || _text[_pos] == '\t' || _text[_pos] == '\n' || _text[_pos] == '\r')) {
+      _pos++;
+    }
+  }
+
+  bool fail(const std::string& message) {
+    if (_error == "") {
+      size_t line = 1;
+      size_t column = 1;
+      for (size_t i = 0; i < _pos && i < _text.length(); i++) {
+        if (_text[i] == '\n') {
+          line++;
+          column = 1;
+        } else {
+          column++;
+        }
+      }
+      _error = message + " at line " + std::to_string(line) + ", column " + std::to_string(column);
+    }
+    return false;
+  }
+
+  bool literal(const char* word) {
+    size_t len = strlen(word);
+    if (_text.compare(_pos, len, word) != 0) {
+      return fail("Unexpected token");
+    }
+    _pos += len;
+    return true;
+  }
+
+  static void appendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+      out += static_cast<char>(cp);
+    } else if (cp < 0x800) {
+      out += static_cast<char>(0xC0 | (cp >> 6));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+      out += static_cast<char>(0xE0 | (cp >> 12));
+      out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    } else {
+      out += static_cast<char>(0xF0 | (cp >> 18));
+      out += static_cast<char>(0x80 | ((cp >> 12) & 0x3F));
+      out += static_cast<char>(0x80 | ((cp >> 6) & 0x3F));
+      out += static_cast<char>(0x80 | (cp & 0x3F));
+    }
+  }
+
+  bool hex4(uint32_t& cp) {
+    if (_pos + 4 > _text.length()) {
+      return fail("Unterminated escape sequence");
+    }
+    cp = 0;
+    for (size_t i = 0; i < 4; i++) {
+      char c = _text[_pos++];
+      cp <<= 4;
+      if (c >= '0' && c <= '9') cp |= c - '0';
+      else if (c >= 'a' && c <= 'f') cp |= c - 'a' + 10;
+      else if (c >= 'A' && c <= 'F') cp |= c - 'A' + 10;
+      else return fail("Invalid unicode escape");
+    }
+    return true;
+  }
+
+  bool parseString(std::string& out) {
+    _pos++;
+    while (_pos < _text.length()) {
+      char c = _text[_pos++];
+      if (c == '"') {
+        return true;
+      }
+      if (c != '\\') {
+        out += c;
+        continue;
+      }
+      if (_pos >= _text.length()) {
+        break;
+      }
+      char e = _text[_pos++];
+      switch (e) {
+        case '"': out += '"'; break;
+        case '\\': out += '\\'; break;
+        case '/': out += '/'; break;
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+          uint32_t cp;
+          if (!hex4(cp)) return false;
+          if (cp >= 0xD800 && cp <= 0xDBFF && _text.compare(_pos, 2, "\\u") == 0) {
+            _pos += 2;
+            uint32_t low;
+            if (!hex4(low)) return false;
+            cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+          }
+          appendUtf8(out, cp);
+          break;
+        }
+        default:
+          return fail("Invalid escape sequence");
+      }
+    }
+    return fail("Unterminated string");
+  }
+
+  bool parseNumber(Value& out) {
+    size_t start = _pos;
+    if (_text[_pos] == '-') _pos++;
+    bool integral = true;
+    while (_pos < _text.length()) {
+      char c = _text[_pos];
+      if (c >= '0' && c <= '9') {
+        _pos++;
+      } else if (c == '.' || c == 'e' || c == 'E' || c == '+' || c == '-') {
+        integral = false;
+        _pos++;
+      } else {
+        break;
+      }
+    }
+    std::string token = _text.substr(start, _pos - start);
+    out.type = Number;
+    // Unlike strtod(), independent of the decimal point of the C locale
+    size_t offset = 0;
+    const char* error = commandline::value::parseDouble(token, out.real, offset);
+    if (error != nullptr) {
+      _pos = start + offset;
+      return fail(std::string("Invalid number, ") + error);
+    }
+    if (integral) {
+      errno = 0;
+      long long number = std::strtoll(token.c_str(), nullptr, 10);
+      out.integral = errno != ERANGE;
+      out.number = out.integral ? static_cast<int64_t>(number) : 0;
+    }
+    return true;
+  }
+
+ public:
+  Parser(const std::string& text, std::string& error): _text(text), _pos(0), _depth(0), _error(error) {}
+
+  bool parseValue(Value& out) {
+    skipWhitespace();
+    if (_pos >= _text.length()) {
+      return fail("Unexpected end of input");
+    }
+    char c = _text[_pos];
+    if ((c == '{' || c == '[') && _depth == maxDepth) {
+      return fail("Nested too deeply");
+    }
+    if (c == '{') {
+      out.type = Object;
+      _pos++;
+      skipWhitespace();
+      if (_pos < _text.length() && _text[_pos] == '}') {
+        _pos++;
+        return true;
+      }
+      while (true) {
+        skipWhitespace();
+        if (_pos >= _text.length() || _text[_pos] != '"') {
+          return fail("Expected a property name");
+        }
+        std::pair<std::string, Value> member;
+        if (!parseString(member.first)) return false;
+        skipWhitespace();
+        if (_pos >= _text.length() || _text[_pos] != ':') {
+          return fail("Expected ':'");
+        }
+        _pos++;
+        _depth++;
+        bool parsed = parseValue(member.second);
+        _depth--;
+        if (!parsed) return false;
+        out.object.push_back(std::move(member));
+        skipWhitespace();
+        if (_pos < _text.length() && _text[_pos] == ',') {
+          _pos++;
+        } else if (_pos < _text.length() && _text[_pos] == '}') {
+          _pos++;
+          return true;
+        } else {
+          return fail("Expected ',' or '}'");
+        }
+      }
+    }
+    if (c == '[') {
+      out.type = Array;
+      _pos++;
+      skipWhitespace();
+      if (_pos < _text.length() && _text[_pos] == ']') {
+        _pos++;
+        return true;
+      }
+      while (true) {
+        Value element;
+        _depth++;
+        bool parsed = parseValue(element);
+        _depth--;
+        if (!parsed) return false;
+        out.array.push_back(std::move(element));
+        skipWhitespace();
+        if (_pos < _text.length() && _text[_pos] == ',') {
+          _pos++;
+        } else if (_pos < _text.length() && _text[_pos] == ']') {
+          _pos++;
+          return true;
+        } else {
+          return fail("Expected ',' or ']'");
+        }
+      }
+    }
+    if (c == '"') {
+      out.type = String;
+      return parseString(out.string);
+    }
+    if (c == 't') {
+      out.type = Boolean;
+      out.boolean = true;
+      return literal("true");
+    }
+    if (c == 'f') {
+      out.type = Boolean;
+      out.boolean = false;
+      return literal("false");
+    }
+    if (c == 'n') {
+      out.type = Null;
+      return literal("null");
+    }
+    if (c == '-' || (c >= '0' && c <= '9')) {
+      return parseNumber(out);
+    }
+    return fail("Unexpected token");
+  }
+
+  bool parseDocument(Value& out) {
+    if (!parseValue(out)) return false;
+    skipWhitespace();
+    if (_pos != _text.length()) {
+      return fail("Unexpected data after the document");
+    }
+    return true;
+  }
+};
+
+void encodeSize(uint64_t size, std::string& out) {
+  while (size >= 0x80) {
+    out += static_cast<char>((size & 0x7F) | 0x80);
+    size >>= 7;
+  }
+  out += static_cast<char>(size);
+}
+
+bool decodeSize(const std::string& data, size_t& offset, uint64_t& size) {
+  size = 0;
+  for (unsigned shift = 0; shift < 64 && offset < data.length(); shift += 7) {
+    uint8_t byte = static_cast<uint8_t>(data[offset++]);
+    size |= static_cast<uint64_t>(byte & 0x7F) << shift;
+    if ((byte & 0x80) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+void encodeString(const std::string& str, std::string& out) {
+  encodeSize(str.length(), out);
+  out += str;
+}
+
+bool decodeString(const std::string& data, size_t& offset, std::string& str) {
+  uint64_t length;
+  if (!decodeSize(data, offset, length) || length > data.length() - offset) {
+    return false;
+  }
+  str.assign(data, offset, static_cast<size_t>(length));
+  offset += static_cast<size_t>(length);
+  return true;
+}
+
+}
+
+bool parse(const std::string& text, Value& out, std::string& error) {
+  Parser parser(text, error);
+  return parser.parseDocument(out);
+}
+
+void encode(const Value& value, std::string& out) {
+  out += static_cast<char>(value.type);
+  switch (value.type) {
+    case Boolean:
+      out += static_cast<char>(value.boolean ? 1 : 0);
+      break;
+    case Number: {
+      char buf[sizeof(int64_t) + sizeof(double)];
+      memcpy(buf, &value.number, sizeof(int64_t));
+      memcpy(buf + sizeof(int64_t), &value.real, sizeof(double));
+      out += static_cast<char>(value.integral ? 1 : 0);
+      out.append(buf, sizeof(buf));
+      break;
+    }
+    case String:
+      encodeString(value.string, out);
+      break;
+    case Array:
+      encodeSize(value.array.size(), out);
+      for (const Value& element : value.array) {
+        encode(element, out);
+      }
+      break;
+    case Object:
+      encodeSize(value.object.size(), out);
+      for (const auto& member : value.object) {
+        encodeString(member.first, out);
+        encode(member.second, out);
+      }
+      break;
+    default:
+      break;
+  }
+}
+
+static bool decodeValue(const std::string& data, size_t& offset, Value& out, size_t depth) {
+  if (offset >= data.length() || depth > maxDepth) {
+    return false;
+  }
+  out.type = static_cast<Type>(data[offset++]);
+  switch (out.type) {
+    case Null:
+      return true;
+    case Boolean:
+      if (offset >= data.length()) return false;
+      out.boolean = data[offset++] != 0;
+      return true;
+    case Number:
+      if (data.length() - offset < 1 + sizeof(int64_t) + sizeof(double)) return false;
+      out.integral = data[offset++] != 0;
+      memcpy(&out.number, data.data() + offset, sizeof(int64_t));
+      memcpy(&out.real, data.data() + offset + sizeof(int64_t), sizeof(double));
+      offset += sizeof(int64_t) + sizeof(double);
+      return true;
+    case String:
+      return decodeString(data, offset, out.string);
+    case Array: {
+      uint64_t size;
+      if (!decodeSize(data, offset, size) || size > data.length() - offset) return false;
+      out.array.resize(static_cast<size_t>(size));
+      for (Value& element : out.array) {
+        if (!decodeValue(data, offset, element, depth + 1)) return false;
+      }
+      return true;
+    }
+    case Object: {
+      uint64_t size;
+      if (!decodeSize(data, offset, size) || size > data.length() - offset) return false;
+      out.object.resize(static_cast<size_t>(size));
+      for (auto& member : out.object) {
+        if (!decodeString(data, offset, member.first) || !decodeValue(data, offset, member.second, depth + 1)) return false;
+      }
+      return true;
+    }
+    default:
+      return false;
+  }
+}
+
+bool decode(const std::string& data, size_t& offset, Value& out) {
+  return decodeValue(data, offset, out, 0);
+}
+
+}
+
+}
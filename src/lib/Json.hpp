@@ -0,0 +1,45 @@
+#ifndef __JSON_HPP__
+#define __JSON_HPP__
+
+#include <string>
+#include <vector>
+#include <utility>
+#include <cstdint>
+
+namespace commandline {
+
+namespace json {
+  typedef enum Type {
+    Null,
+    Boolean,
+    Number,
+    String,
+    Array,
+    Object
+  } Type;
+
+  struct Value {
+    Type type = Null;
+    bool boolean = false;
+    // Only set when the number is written as an integer that fits
+    bool integral = false;
+    int64_t number = 0;
+    double real = 0;
+    std::string string = "";
+    std::vector<Value> array = {};
+    std::vector<std::pair<std::string, Value>> object = {};
+
+    const Value* get(const std::string& key) const;
+  };
+
+  /** Fails on documents with arrays and objects nested more than 256 levels deep. */
+  bool parse(const std::string& text, Value& out, std::string& error);
+
+  // Compact binary form of a parsed document, used as a parse cache.
+  void encode(const Value& value, std::string& out);
+  bool decode(const std::string& data, size_t& offset, Value& out);
+}
+
+}
+
+#endif
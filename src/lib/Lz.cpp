@@ -0,0 +1,122 @@
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "Lz.hpp"
+
+namespace commandline {
+
+namespace lz {
+
+namespace {
+
+const size_t minMatch = 3;
+const size_t maxMatch = 0x7f + minMatch;
+const size_t maxLiterals = 0x80;
+const size_t window = 0xffff;
+const size_t hashBits = 14;
+// Candidates looked at per position; enough for prose, bounded for anything else
+const size_t maxChain = 32;
+
+inline uint32_t hash3(const unsigned char* p) {
+  uint32_t v = static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) | (static_cast<uint32_t>(p[2]) << 16);
+  return (v * 2654435761u) >> (32 - hashBits);
+}
+
+void flushLiterals(const unsigned char* begin, const unsigned char* end, std::string& output) {
+  while (begin < end) {
+    size_t run = static_cast<size_t>(end - begin);
+    if (run > maxLiterals) run = maxLiterals;
+    output += static_cast<char>(run - 1);
+    output.append(reinterpret_cast<const char*>(begin), run);
+    begin += run;
+  }
+}
+
+}
+
+std::string compress(const std::string& input) {
+  const unsigned char* data = reinterpret_cast<const unsigned char*>(input.data());
+  const size_t size = input.size();
+  std::string output;
+  output.reserve(size / 2 + 16);
+
+  // Most recent position per hash, and the previous position with the same hash
+  std::vector<int64_t> head(size_t(1) << hashBits, -1);
+  std::vector<int64_t> previous(size, -1);
+  auto insert = [&](size_t position) {
+    if (position + minMatch <= size) {
+      uint32_t h = hash3(data + position);
+      previous[position] = head[h];
+      head[h] = static_cast<int64_t>(position);
+    }
+  };
+
+  size_t literalStart = 0;
+  size_t i = 0;
+  while (i + minMatch <= size) {
+    size_t bestLength = 0;
+    size_t bestDistance = 0;
+    int64_t candidate = head[hash3(data + i)];
+    for (size_t chain = 0; candidate >= 0 && chain < maxChain; chain++) {
+      size_t distance = i - static_cast<size_t>(candidate);
+      if (distance > window) break;
+      size_t limit = size - i < maxMatch ? size - i : maxMatch;
+      size_t length = 0;
+      while (length < limit && data[candidate + length] == data[i + length]) length++;
+      if (length > bestLength) {
+        bestLength = length;
+        bestDistance = distance;
+        if (length == limit) break;
+      }
+      candidate = previous[static_cast<size_t>(candidate)];
+    }
+
+    if (bestLength < minMatch) {
+      insert(i);
+      i++;
+      continue;
+    }
+    flushLiterals(data + literalStart, data + i, output);
+    output += static_cast<char>(0x80 | (bestLength - minMatch));
+    output += static_cast<char>(bestDistance & 0xff);
+    output += static_cast<char>(bestDistance >> 8);
+    for (size_t end = i + bestLength; i < end; i++) {
+      insert(i);
+    }
+    literalStart = i;
+  }
+  flushLiterals(data + literalStart, data + size, output);
+  return output;
+}
+
+bool decompress(const unsigned char* input, size_t inputSize, size_t size, std::string& output) {
+  output.clear();
+  output.reserve(size);
+  size_t i = 0;
+  while (i < inputSize) {
+    unsigned char control = input[i++];
+    if (control < 0x80) {
+      size_t run = static_cast<size_t>(control) + 1;
+      if (run > inputSize - i || output.size() + run > size) return false;
+      output.append(reinterpret_cast<const char*>(input + i), run);
+      i += run;
+    } else {
+      if (inputSize - i < 2) return false;
+      size_t length = static_cast<size_t>(control & 0x7f) + minMatch;
+      size_t distance = static_cast<size_t>(input[i]) | (static_cast<size_t>(input[i + 1]) << 8);
+      i += 2;
+      if (distance == 0 || distance > output.size() || output.size() + length > size) return false;
+      // Byte by byte: the source may overlap what is being written
+      size_t from = output.size() - distance;
+      for (size_t k = 0; k < length; k++) {
+        output += output[from + k];
+      }
+    }
+  }
+  return output.size() == size;
+}
+
+}
+
+}
@@ -0,0 +1,21 @@
+#ifndef __LZ_HPP__
+#define __LZ_HPP__
+
+#include <cstddef>
+#include <string>
+
+namespace commandline {
+
+// A small LZ77 byte codec for help text. A control byte below 0x80 is
+// followed by that many plus one literal bytes; from 0x80 on it copies
+// (byte & 0x7f) + 3 bytes from a distance given by the next two bytes,
+// little-endian. Decoding is a single pass without any tables.
+namespace lz {
+  std::string compress(const std::string& input);
+  /** Returns false if the input is malformed or does not decode to exactly size bytes. */
+  bool decompress(const unsigned char* input, size_t inputSize, size_t size, std::string& output);
+}
+
+}
+
+#endif
@@ -0,0 +1,100 @@
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#endif
+
+#include "MappedFile.hpp"
+
+namespace commandline {
+
+namespace mapped {
+
+#ifdef _WIN32
+static std::string lastError() {
+  return "error code " + std::to_string(GetLastError());
+}
+
+void* map(const std::string& path, size_t size, bool writable, std::string& error) {
+  HANDLE file = CreateFileA(path.c_str(), writable ? GENERIC_READ | GENERIC_WRITE : GENERIC_READ,
+    FILE_SHARE_READ | FILE_SHARE_WRITE, nullptr, writable ? OPEN_ALWAYS : OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file == INVALID_HANDLE_VALUE) {
+    error = lastError();
+    return nullptr;
+  }
+  LARGE_INTEGER fileSize;
+  if (!GetFileSizeEx(file, &fileSize) || static_cast<unsigned long long>(fileSize.QuadPart) < size) {
+    if (!writable) {
+      error = "the file is too short";
+      CloseHandle(file);
+      return nullptr;
+    }
+  }
+  // A writable mapping larger than the file extends it with zeros
+  uint64_t mappingSize = static_cast<uint64_t>(size);
+  HANDLE mapping = CreateFileMappingA(file, nullptr, writable ? PAGE_READWRITE : PAGE_READONLY,
+    static_cast<DWORD>(mappingSize >> 32), static_cast<DWORD>(mappingSize), nullptr);
+  if (mapping == nullptr) {
+    error = lastError();
+    CloseHandle(file);
+    return nullptr;
+  }
+  void* data = MapViewOfFile(mapping, writable ? FILE_MAP_WRITE : FILE_MAP_READ, 0, 0, size);
+  if (data == nullptr) {
+    error = lastError();
+  }
+  // The view keeps the mapping and the file open
+  CloseHandle(mapping);
+  CloseHandle(file);
+  return data;
+}
+
+void unmap(void* data, size_t) {
+  UnmapViewOfFile(data);
+}
+#else
+void* map(const std::string& path, size_t size, bool writable, std::string& error) {
+  int fd = ::open(path.c_str(), writable ? O_RDWR | O_CREAT | O_CLOEXEC : O_RDONLY | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    error = std::strerror(errno);
+    return nullptr;
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    error = std::strerror(errno);
+    ::close(fd);
+    return nullptr;
+  }
+  if (static_cast<size_t>(info.st_size) < size) {
+    // Growing to the same size from several processes is harmless
+    if (!writable || ::ftruncate(fd, static_cast<off_t>(size)) != 0) {
+      error = writable ? std::strerror(errno) : "the file is too short";
+      ::close(fd);
+      return nullptr;
+    }
+  }
+  void* data = ::mmap(nullptr, size, writable ? PROT_READ | PROT_WRITE : PROT_READ, MAP_SHARED, fd, 0);
+  if (data == MAP_FAILED) {
+    error = std::strerror(errno);
+    data = nullptr;
+  }
+  ::close(fd);
+  return data;
+}
+
+void unmap(void* data, size_t size) {
+  ::munmap(data, size);
+}
+#endif
+
+}
+
+}
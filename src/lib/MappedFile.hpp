@@ -0,0 +1,22 @@
+#ifndef __MAPPED_FILE_HPP__
+#define __MAPPED_FILE_HPP__
+
+#include <cstddef>
+#include <string>
+
+namespace commandline {
+
+namespace mapped {
+  /**
+   * Maps size bytes of the file at path, shared with every other process that
+   * maps it. A writable mapping creates the file and grows it with zeros to
+   * size; a read-only one fails if the file is shorter. Returns null and sets
+   * error on failure.
+   */
+  void* map(const std::string& path, size_t size, bool writable, std::string& error);
+  void unmap(void* data, size_t size);
+}
+
+}
+
+#endif
@@ -0,0 +1,654 @@
+#include <algorithm>
+#include <bitset>
+#include <climits>
+#include <cstring>
+#include <map>
+#include <utility>
+
+#include "Pattern.hpp"
+#include "commandline/CommandLineError.hpp"
+
+namespace commandline {
+
+namespace dfa {
+
+namespace {
+
+const unsigned unbounded = UINT_MAX;
+const unsigned maxRepeat = 1000;
+const size_t maxDepth = 100;
+const size_t maxNfaStates = 20000;
+const size_t maxDfaStates = 4096;
+
+typedef std::bitset<256> ByteSet;
+
+struct Node {
+  enum Type { Set, Concat, Alternation, Repeat } type;
+  size_t set;
+  unsigned min;
+  unsigned max;
+  std::vector<Node> children;
+
+  explicit Node(Type t = Concat): type(t), set(0), min(0), max(0), children() {}
+};
+
+Node setNode(size_t set) {
+  Node node(Node::Set);
+  node.set = set;
+  return node;
+}
+
+Node repeatNode(Node child, unsigned min, unsigned max) {
+  Node node(Node::Repeat);
+  node.min = min;
+  node.max = max;
+  node.children.push_back(std::move(child));
+  return node;
+}
+
+class Parser {
+ private:
+  const std::string& _source;
+  size_t _pos;
+  size_t _depth;
+  std::vector<ByteSet>& _sets;
+
+  bool _fail(const char* message, size_t offset) {
+    this->error = message;
+    this->errorOffset = offset;
+    return false;
+  }
+
+  bool _consume(char c) {
+    if (this->_pos < this->_source.size() && this->_source[this->_pos] == c) {
+      this->_pos++;
+      return true;
+    }
+    return false;
+  }
+
+  size_t _addSet(const ByteSet& set) {
+    for (size_t i = 0; i < this->_sets.size(); i++) {
+      if (this->_sets[i] == set) {
+        return i;
+      }
+    }
+    this->_sets.push_back(set);
+    return this->_sets.size() - 1;
+  }
+
+  // After a backslash: a single byte in literal, or a class in set with literal -1
+  bool _parseEscape(ByteSet& set, int& literal) {
+    size_t start = this->_pos - 1;
+    if (this->_pos >= this->_source.size()) {
+      return this->_fail("the pattern ends with a backslash", start);
+    }
+    unsigned char c = static_cast<unsigned char>(this->_source[this->_pos++]);
+    literal = -1;
+    switch (c) {
+      case 'd': case 'D':
+        for (int b = '0'; b <= '9'; b++) set.set(b);
+        break;
+      case 'w': case 'W':
+        for (int b = '0'; b <= '9'; b++) set.set(b);
+        for (int b = 'a'; b <= 'z'; b++) set.set(b);
+        for (int b = 'A'; b <= 'Z'; b++) set.set(b);
+        set.set('_');
+        break;
+      case 's': case 'S':
+        for (const char* s = " \t\n\r\f\v"; *s != 0; s++) set.set(static_cast<unsigned char>(*s));
+        break;
+      case 'n': literal = '\n'; break;
+      case 'r': literal = '\r'; break;
+      case 't': literal = '\t'; break;
+      case 'f': literal = '\f'; break;
+      case 'v': literal = '\v'; break;
+      default:
+        if ((c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+          return this->_fail("unsupported escape", start);
+        }
+        literal = c;
+    }
+    if (c == 'D' || c == 'W' || c == 'S') {
+      set.flip();
+    }
+    return true;
+  }
+
+  bool _parseClassItem(int& literal, ByteSet& set) {
+    unsigned char c = static_cast<unsigned char>(this->_source[this->_pos++]);
+    if (c == '\\') {
+      return this->_parseEscape(set, literal);
+    }
+    literal = c;
+    return true;
+  }
+
+  bool _parseClass(Node& out, size_t start) {
+    bool negate = this->_consume('^');
+    ByteSet set;
+    // A "]" right after the opening bracket is a literal
+    bool first = true;
+    for (;;) {
+      if (this->_pos >= this->_source.size()) {
+        return this->_fail("the class is not closed", start);
+      }
+      if (this->_source[this->_pos] == ']' && !first) {
+        this->_pos++;
+        break;
+      }
+      first = false;
+      int low;
+      ByteSet item;
+      if (!this->_parseClassItem(low, item)) {
+        return false;
+      }
+      if (low >= 0 && this->_pos + 1 < this->_source.size() && this->_source[this->_pos] == '-' && this->_source[this->_pos + 1] != ']') {
+        size_t rangeStart = this->_pos++;
+        int high;
+        ByteSet ignored;
+        if (!this->_parseClassItem(high, ignored)) {
+          return false;
+        }
+        if (high < 0) {
+          return this->_fail("a range cannot end with a class escape", rangeStart);
+        }
+        if (high < low) {
+          return this->_fail("the range is out of order", rangeStart);
+        }
+        for (int b = low; b <= high; b++) {
+          set.set(b);
+        }
+      } else if (low >= 0) {
+        set.set(low);
+      } else {
+        set |= item;
+      }
+    }
+    if (negate) {
+      set.flip();
+    }
+    out = setNode(this->_addSet(set));
+    return true;
+  }
+
+  bool _parseAtom(Node& out) {
+    size_t start = this->_pos;
+    char c = this->_source[this->_pos++];
+    switch (c) {
+      case '(':
+        if (this->_consume('?') && !this->_consume(':')) {
+          return this->_fail("only (?: groups are supported", start);
+        }
+        if (++this->_depth > maxDepth) {
+          return this->_fail("the groups are nested too deeply", start);
+        }
+        if (!this->_parseAlternation(out)) {
+          return false;
+        }
+        this->_depth--;
+        if (!this->_consume(')')) {
+          return this->_fail("the group is not closed", start);
+        }
+        return true;
+      case '[':
+        return this->_parseClass(out, start);
+      case '.': {
+        ByteSet set;
+        set.set();
+        set.reset('\n');
+        out = setNode(this->_addSet(set));
+        return true;
+      }
+      case '\\': {
+        ByteSet set;
+        int literal;
+        if (!this->_parseEscape(set, literal)) {
+          return false;
+        }
+        if (literal >= 0) {
+          set.set(literal);
+        }
+        out = setNode(this->_addSet(set));
+        return true;
+      }
+      case '*': case '+': case '?': case '{':
+        return this->_fail("nothing to repeat", start);
+      default: {
+        ByteSet set;
+        set.set(static_cast<unsigned char>(c));
+        out = setNode(this->_addSet(set));
+        return true;
+      }
+    }
+  }
+
+  bool _parseCount(unsigned& count, size_t start) {
+    size_t digits = 0;
+    count = 0;
+    while (this->_pos < this->_source.size() && this->_source[this->_pos] >= '0' && this->_source[this->_pos] <= '9') {
+      count = count * 10 + static_cast<unsigned>(this->_source[this->_pos++] - '0');
+      if (count > maxRepeat) {
+        return this->_fail("the repetition count is too large", start);
+      }
+      digits++;
+    }
+    return digits > 0 || this->_fail("invalid repetition", start);
+  }
+
+  bool _parseQuantifier(Node& atom) {
+    if (this->_pos >= this->_source.size()) {
+      return true;
+    }
+    size_t start = this->_pos;
+    unsigned min;
+    unsigned max;
+    switch (this->_source[this->_pos]) {
+      case '*': min = 0; max = unbounded; this->_pos++; break;
+      case '+': min = 1; max = unbounded; this->_pos++; break;
+      case '?': min = 0; max = 1; this->_pos++; break;
+      case '{':
+        this->_pos++;
+        if (!this->_parseCount(min, start)) {
+          return false;
+        }
+        max = min;
+        if (this->_consume(',')) {
+          max = unbounded;
+          if (this->_pos < this->_source.size() && this->_source[this->_pos] != '}' && !this->_parseCount(max, start)) {
+            return false;
+          }
+        }
+        if (!this->_consume('}')) {
+          return this->_fail("invalid repetition", start);
+        }
+        if (max < min) {
+          return this->_fail("the repetition is out of order", start);
+        }
+        break;
+      default:
+        return true;
+    }
+    // A lazy quantifier accepts the same values
+    this->_consume('?');
+    atom = repeatNode(std::move(atom), min, max);
+    return true;
+  }
+
+  bool _parseConcat(Node& out, bool topLevel) {
+    out = Node(Node::Concat);
+    while (this->_pos < this->_source.size()) {
+      char c = this->_source[this->_pos];
+      if (c == '|' || c == ')' || (c == '$' && topLevel)) {
+        break;
+      }
+      if (c == '^' || c == '$') {
+        return this->_fail("anchors are only supported at the start and the end of the pattern or of its top-level alternatives", this->_pos);
+      }
+      Node atom;
+      if (!this->_parseAtom(atom) || !this->_parseQuantifier(atom)) {
+        return false;
+      }
+      out.children.push_back(std::move(atom));
+    }
+    return true;
+  }
+
+  bool _parseAlternation(Node& out) {
+    out = Node(Node::Alternation);
+    do {
+      Node branch;
+      if (!this->_parseConcat(branch, false)) {
+        return false;
+      }
+      out.children.push_back(std::move(branch));
+    } while (this->_consume('|'));
+    return true;
+  }
+
+ public:
+  const char* error;
+  size_t errorOffset;
+
+  Parser(const std::string& source, std::vector<ByteSet>& sets):
+    _source(source),
+    _pos(0),
+    _depth(0),
+    _sets(sets),
+    error(nullptr),
+    errorOffset(0) {}
+
+  // Unanchored alternatives may be surrounded by anything
+  bool parse(Node& out) {
+    ByteSet any;
+    any.set();
+    const size_t anySet = this->_addSet(any);
+    out = Node(Node::Alternation);
+    do {
+      bool anchoredStart = this->_consume('^');
+      Node body;
+      if (!this->_parseConcat(body, true)) {
+        return false;
+      }
+      size_t end = this->_pos;
+      bool anchoredEnd = this->_consume('$');
+      if (anchoredEnd && this->_pos < this->_source.size() && this->_source[this->_pos] != '|') {
+        return this->_fail("anchors are only supported at the start and the end of the pattern or of its top-level alternatives", end);
+      }
+      Node branch(Node::Concat);
+      if (!anchoredStart) {
+        branch.children.push_back(repeatNode(setNode(anySet), 0, unbounded));
+      }
+      branch.children.push_back(std::move(body));
+      if (!anchoredEnd) {
+        branch.children.push_back(repeatNode(setNode(anySet), 0, unbounded));
+      }
+      out.children.push_back(std::move(branch));
+    } while (this->_consume('|'));
+    if (this->_pos < this->_source.size()) {
+      return this->_fail("unmatched )", this->_pos);
+    }
+    return true;
+  }
+};
+
+// Thompson construction. A state with a set moves to out on a byte of the
+// set; a state without one has up to two epsilon edges.
+struct NfaState {
+  int set;
+  int out;
+  int out2;
+};
+
+struct Fragment {
+  int start;
+  // An epsilon state whose out is still open
+  int end;
+};
+
+class NfaBuilder {
+ private:
+  int _add(int set, int out, int out2) {
+    if (this->states.size() >= maxNfaStates) {
+      this->overflow = true;
+    }
+    NfaState state = { set, out, out2 };
+    this->states.push_back(state);
+    return static_cast<int>(this->states.size() - 1);
+  }
+
+  void _append(Fragment& fragment, const Fragment& next) {
+    this->states[fragment.end].out = next.start;
+    fragment.end = next.end;
+  }
+
+ public:
+  std::vector<NfaState> states;
+  bool overflow;
+
+  NfaBuilder(): states(), overflow(false) {}
+
+  Fragment build(const Node& node) {
+    Fragment empty = { 0, 0 };
+    if (this->overflow) {
+      return empty;
+    }
+    switch (node.type) {
+      case Node::Set: {
+        int end = this->_add(-1, -1, -1);
+        Fragment fragment = { this->_add(static_cast<int>(node.set), end, -1), end };
+        return fragment;
+      }
+      case Node::Concat: {
+        int start = this->_add(-1, -1, -1);
+        Fragment fragment = { start, start };
+        for (const Node& child : node.children) {
+          this->_append(fragment, this->build(child));
+        }
+        return fragment;
+      }
+      case Node::Alternation: {
+        int end = this->_add(-1, -1, -1);
+        int start = -1;
+        for (size_t i = node.children.size(); i-- > 0;) {
+          Fragment branch = this->build(node.children[i]);
+          this->states[branch.end].out = end;
+          start = start < 0 ? branch.start : this->_add(-1, branch.start, start);
+        }
+        Fragment fragment = { start, end };
+        return fragment;
+      }
+      case Node::Repeat: {
+        const Node& child = node.children[0];
+        int start = this->_add(-1, -1, -1);
+        Fragment fragment = { start, start };
+        for (unsigned i = 0; i < node.min && !this->overflow; i++) {
+          this->_append(fragment, this->build(child));
+        }
+        if (node.max == unbounded) {
+          Fragment body = this->build(child);
+          int end = this->_add(-1, -1, -1);
+          int loop = this->_add(-1, body.start, end);
+          this->states[body.end].out = loop;
+          Fragment star = { loop, end };
+          this->_append(fragment, star);
+        } else if (node.max > node.min) {
+          // x(x(x)?)? rather than x?x?x?, which keeps the DFA state sets small
+          int end = this->_add(-1, -1, -1);
+          int next = end;
+          for (unsigned i = node.max - node.min; i-- > 0 && !this->overflow;) {
+            Fragment body = this->build(child);
+            this->states[body.end].out = next;
+            next = this->_add(-1, body.start, end);
+          }
+          Fragment optional = { next, end };
+          this->_append(fragment, optional);
+        }
+        return fragment;
+      }
+    }
+    return empty;
+  }
+};
+
+// The byte states and the accept state reachable from seeds, sorted
+class Closure {
+ private:
+  const std::vector<NfaState>& _nfa;
+  int _accept;
+  std::vector<unsigned> _marks;
+  unsigned _generation;
+  std::vector<int> _stack;
+
+ public:
+  Closure(const std::vector<NfaState>& nfa, int accept):
+    _nfa(nfa),
+    _accept(accept),
+    _marks(nfa.size(), 0),
+    _generation(0),
+    _stack() {}
+
+  void compute(const std::vector<int>& seeds, std::vector<int>& out) {
+    this->_generation++;
+    out.clear();
+    this->_stack.assign(seeds.begin(), seeds.end());
+    while (!this->_stack.empty()) {
+      int s = this->_stack.back();
+      this->_stack.pop_back();
+      if (s < 0 || this->_marks[s] == this->_generation) {
+        continue;
+      }
+      this->_marks[s] = this->_generation;
+      const NfaState& state = this->_nfa[s];
+      if (state.set >= 0 || s == this->_accept) {
+        out.push_back(s);
+      } else {
+        this->_stack.push_back(state.out);
+        this->_stack.push_back(state.out2);
+      }
+    }
+    std::sort(out.begin(), out.end());
+  }
+};
+
+}
+
+Pattern::Pattern():
+  _classCount(1),
+  _start(1),
+  _next(2, 0),
+  _accepting(2, 0) {
+  std::memset(this->_classes, 0, sizeof(this->_classes));
+  // Matches everything until compiled
+  this->_next[1] = 1;
+  this->_accepting[1] = 1;
+}
+
+const char* Pattern::compile(const std::string& source, size_t& errorOffset) {
+  std::vector<ByteSet> sets;
+  Parser parser(source, sets);
+  Node root;
+  if (!parser.parse(root)) {
+    errorOffset = parser.errorOffset;
+    return parser.error;
+  }
+  NfaBuilder nfa;
+  Fragment fragment = nfa.build(root);
+  if (nfa.overflow) {
+    errorOffset = 0;
+    return "the pattern is too large";
+  }
+
+  // Bytes that are in the same sets are interchangeable
+  uint8_t classes[256];
+  std::vector<uint8_t> representatives;
+  std::map<std::string, uint8_t> classBySignature;
+  for (int b = 0; b < 256; b++) {
+    std::string signature(sets.size(), '0');
+    for (size_t i = 0; i < sets.size(); i++) {
+      if (sets[i][b]) signature[i] = '1';
+    }
+    auto found = classBySignature.find(signature);
+    if (found == classBySignature.end()) {
+      found = classBySignature.emplace(signature, static_cast<uint8_t>(representatives.size())).first;
+      representatives.push_back(static_cast<uint8_t>(b));
+    }
+    classes[b] = found->second;
+  }
+  const size_t classCount = representatives.size();
+
+  // Subset construction; state 0 is the empty set
+  Closure closure(nfa.states, fragment.end);
+  std::map<std::vector<int>, uint16_t> ids;
+  std::vector<std::vector<int>> dfaStates(1);
+  ids.emplace(std::vector<int>(), 0);
+  std::vector<int> key;
+  closure.compute(std::vector<int>(1, fragment.start), key);
+  ids.emplace(key, 1);
+  dfaStates.push_back(key);
+
+  std::vector<uint16_t> next(classCount, 0);
+  std::vector<int> seeds;
+  for (size_t d = 1; d < dfaStates.size(); d++) {
+    const std::vector<int> current = dfaStates[d];
+    next.resize((d + 1) * classCount);
+    for (size_t c = 0; c < classCount; c++) {
+      seeds.clear();
+      for (int s : current) {
+        const NfaState& state = nfa.states[s];
+        if (state.set >= 0 && sets[state.set][representatives[c]]) {
+          seeds.push_back(state.out);
+        }
+      }
+      closure.compute(seeds, key);
+      auto found = ids.find(key);
+      if (found == ids.end()) {
+        if (dfaStates.size() >= maxDfaStates) {
+          errorOffset = 0;
+          return "the pattern needs too many states";
+        }
+        found = ids.emplace(key, static_cast<uint16_t>(dfaStates.size())).first;
+        dfaStates.push_back(key);
+      }
+      next[d * classCount + c] = found->second;
+    }
+  }
+
+  // 2 once every continuation is accepted too
+  std::vector<uint8_t> accepts(dfaStates.size(), 0);
+  for (size_t d = 1; d < dfaStates.size(); d++) {
+    if (std::binary_search(dfaStates[d].begin(), dfaStates[d].end(), fragment.end)) {
+      accepts[d] = 2;
+    }
+  }
+  for (bool changed = true; changed;) {
+    changed = false;
+    for (size_t d = 1; d < dfaStates.size(); d++) {
+      for (size_t c = 0; c < classCount && accepts[d] == 2; c++) {
+        if (accepts[next[d * classCount + c]] != 2) {
+          accepts[d] = 1;
+          changed = true;
+        }
+      }
+    }
+  }
+
+  // Those states all become state 1, so that matching stops at states 0
+  // and 1; transitions hold the row offset of their target
+  std::vector<uint32_t> numbers(dfaStates.size(), 0);
+  uint32_t count = 2;
+  for (size_t d = 1; d < dfaStates.size(); d++) {
+    numbers[d] = accepts[d] == 2 ? 1 : count++;
+  }
+  std::vector<uint32_t> rows(count * classCount, 0);
+  std::vector<uint8_t> accepting(count, 0);
+  accepting[1] = 1;
+  for (size_t c = 0; c < classCount; c++) {
+    rows[classCount + c] = static_cast<uint32_t>(classCount);
+  }
+  for (size_t d = 1; d < dfaStates.size(); d++) {
+    if (accepts[d] == 2) {
+      continue;
+    }
+    accepting[numbers[d]] = accepts[d];
+    for (size_t c = 0; c < classCount; c++) {
+      rows[numbers[d] * classCount + c] = static_cast<uint32_t>(numbers[next[d * classCount + c]] * classCount);
+    }
+  }
+
+  std::memcpy(this->_classes, classes, sizeof(classes));
+  this->_classCount = classCount;
+  this->_start = static_cast<uint32_t>(numbers[1] * classCount);
+  this->_next.swap(rows);
+  this->_accepting.swap(accepting);
+  return nullptr;
+}
+
+bool Pattern::matches(const std::string& value) const {
+  const uint32_t stop = static_cast<uint32_t>(2 * this->_classCount);
+  uint32_t row = this->_start;
+  for (unsigned char c : value) {
+    if (row < stop) {
+      break;
+    }
+    row = this->_next[row + this->_classes[c]];
+  }
+  return this->_accepting[row / this->_classCount] != 0;
+}
+
+std::shared_ptr<const Pattern> compileParameterPattern(const std::string& source, const std::string& longName) {
+  if (source.empty()) {
+    return nullptr;
+  }
+  std::shared_ptr<Pattern> pattern = std::make_shared<Pattern>();
+  size_t offset = 0;
+  const char* error = pattern->compile(source, offset);
+  if (error != nullptr) {
+    throw CommandLineError(PATTERN_INVALID, "Invalid pattern \"" + source + "\" for the parameter " + longName + ": " + error + " at offset " + std::to_string(offset));
+  }
+  return pattern;
+}
+
+}
+
+}
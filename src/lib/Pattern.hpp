@@ -0,0 +1,49 @@
+#ifndef __PATTERN_HPP__
+#define __PATTERN_HPP__
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace commandline {
+
+// Value patterns of string parameters. A pattern is compiled once into a
+// DFA over byte classes, so matching reads every byte of a value once, with
+// no backtracking and no allocation. The subset: literals, ".", classes
+// with ranges and negation, \d \w \s and their complements, groups,
+// alternation, * + ? and {n}, {n,}, {n,m}. Like a regex search, a pattern
+// matches anywhere in the value unless it is anchored with ^ and $, which
+// may only appear at the edges of the top-level alternatives. Matching is
+// bytewise, so "." and classes see the bytes of UTF-8 sequences.
+namespace dfa {
+  class Pattern {
+   private:
+    uint8_t _classes[256];
+    size_t _classCount;
+    // Rows of _classCount transitions, addressed by their offset. State 0
+    // rejects whatever follows and state 1 accepts it.
+    uint32_t _start;
+    std::vector<uint32_t> _next;
+    std::vector<uint8_t> _accepting;
+
+   public:
+    Pattern();
+
+    /**
+     * Returns null on success. Otherwise returns a static message and sets
+     * errorOffset to the offset in source where the problem was found.
+     */
+    const char* compile(const std::string& source, size_t& errorOffset);
+
+    bool matches(const std::string& value) const;
+  };
+
+  /** The pattern of the parameter longName, or null if source is empty; throws PATTERN_INVALID. */
+  std::shared_ptr<const Pattern> compileParameterPattern(const std::string& source, const std::string& longName);
+}
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#include <Psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+#include "ProcessUsage.hpp"
+
+namespace commandline {
+
+namespace usage {
+
+#ifdef _WIN32
+static uint64_t micros(const FILETIME& time) {
+  // FILETIME counts 100 ns ticks
+  return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) / 10;
+}
+
+Usage current() {
+  Usage usage = { 0, 0 };
+  FILETIME creation, exit, kernel, user;
+  if (GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user)) {
+    usage.cpuMicros = micros(kernel) + micros(user);
+  }
+  PROCESS_MEMORY_COUNTERS counters;
+  if (K32GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+    usage.peakRssKiB = counters.PeakWorkingSetSize / 1024;
+  }
+  return usage;
+}
+#else
+Usage current() {
+  Usage usage = { 0, 0 };
+  struct rusage self;
+  if (::getrusage(RUSAGE_SELF, &self) == 0) {
+    usage.cpuMicros = static_cast<uint64_t>(self.ru_utime.tv_sec + self.ru_stime.tv_sec) * 1000000 +
+      static_cast<uint64_t>(self.ru_utime.tv_usec + self.ru_stime.tv_usec);
+#ifdef __APPLE__
+    // Bytes on macOS, KiB elsewhere
+    usage.peakRssKiB = static_cast<uint64_t>(self.ru_maxrss) / 1024;
+#else
+    usage.peakRssKiB = static_cast<uint64_t>(self.ru_maxrss);
+#endif
+  }
+  return usage;
+}
+#endif
+
+}
+
+}
@@ -0,0 +1,21 @@
+#ifndef __PROCESS_USAGE_HPP__
+#define __PROCESS_USAGE_HPP__
+
+#include <cstdint>
+
+namespace commandline {
+
+namespace usage {
+  struct Usage {
+    /** User and system time of the whole process */
+    uint64_t cpuMicros;
+    /** The high-water mark of the resident set */
+    uint64_t peakRssKiB;
+  };
+
+  Usage current();
+}
+
+}
+
+#endif
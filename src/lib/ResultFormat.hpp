@@ -0,0 +1,57 @@
+#ifndef __RESULT_FORMAT_HPP__
+#define __RESULT_FORMAT_HPP__
+
+#include <cstdint>
+
+namespace commandline {
+
+// Layout shared by CommandLineResult and CommandLineResultView. All offsets
+// are relative to the start of the buffer; strings are NUL-terminated and
+// their length excludes the NUL; a list is an array of Refs to strings.
+namespace result {
+  struct Ref {
+    uint32_t offset;
+    uint32_t length;
+  };
+
+  enum Flags : uint16_t {
+    HasAction = 1,
+    HasRemainder = 2,
+    HasActionRemainder = 4
+  };
+
+  // Index 0 describes the parser's own parameters, index 1 the selected action's.
+  struct Header {
+    char magic[4];
+    uint16_t version;
+    uint16_t flags;
+    uint32_t totalSize;
+    uint32_t entryCount[2];
+    uint32_t entriesOffset[2];
+    // entry ids ordered by name, for lookups by name
+    uint32_t sortedOffset[2];
+    Ref actionName;
+    Ref remainder[2];
+    uint32_t reserved;
+  };
+
+  struct Entry {
+    Ref name;
+    // the string of Choice and String parameters, the list of StringList parameters
+    Ref data;
+    // bool, int64_t, uint64_t, the bits of a double, nanoseconds or the choice index
+    uint64_t scalar;
+    uint8_t kind;
+    uint8_t source;
+    uint8_t reserved[6];
+  };
+
+  static_assert(sizeof(Header) == 64, "unexpected result header size");
+  static_assert(sizeof(Entry) == 32, "unexpected result entry size");
+
+  static const char magic[4] = { 'C', 'L', 'R', 'S' };
+}
+
+}
+
+#endif
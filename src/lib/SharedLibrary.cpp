@@ -0,0 +1,65 @@
+#ifdef _WIN32
+#ifndef WIN32_LEAN_AND_MEAN
+#define WIN32_LEAN_AND_MEAN
+#endif
+#include <Windows.h>
+#else
+#include <dlfcn.h>
+#endif
+
+#include "SharedLibrary.hpp"
+
+namespace commandline {
+
+namespace dl {
+
+#ifdef _WIN32
+static std::string lastError() {
+  return "error code " + std::to_string(GetLastError());
+}
+#endif
+
+void* open(const std::string& path, std::string& error) {
+#ifdef _WIN32
+  void* handle = reinterpret_cast<void*>(LoadLibraryA(path.c_str()));
+  if (handle == nullptr) {
+    error = lastError();
+  }
+#else
+  void* handle = dlopen(path.c_str(), RTLD_NOW | RTLD_LOCAL);
+  if (handle == nullptr) {
+    const char* message = dlerror();
+    error = message != nullptr ? message : "unknown error";
+  }
+#endif
+  return handle;
+}
+
+void* symbol(void* handle, const std::string& name, std::string& error) {
+#ifdef _WIN32
+  void* sym = reinterpret_cast<void*>(GetProcAddress(reinterpret_cast<HMODULE>(handle), name.c_str()));
+  if (sym == nullptr) {
+    error = lastError();
+  }
+#else
+  dlerror();
+  void* sym = dlsym(handle, name.c_str());
+  if (sym == nullptr) {
+    const char* message = dlerror();
+    error = message != nullptr ? message : "symbol is null";
+  }
+#endif
+  return sym;
+}
+
+void close(void* handle) {
+#ifdef _WIN32
+  FreeLibrary(reinterpret_cast<HMODULE>(handle));
+#else
+  dlclose(handle);
+#endif
+}
+
+}
+
+}
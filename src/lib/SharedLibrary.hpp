@@ -0,0 +1,16 @@
+#ifndef __SHARED_LIBRARY_HPP__
+#define __SHARED_LIBRARY_HPP__
+
+#include <string>
+
+namespace commandline {
+
+namespace dl {
+  void* open(const std::string& path, std::string& error);
+  void* symbol(void* handle, const std::string& name, std::string& error);
+  void close(void* handle);
+}
+
+}
+
+#endif
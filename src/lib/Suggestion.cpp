@@ -0,0 +1,139 @@
+#include <algorithm>
+#include <cstring>
+
+#include "Suggestion.hpp"
+
+namespace commandline {
+
+namespace suggest {
+
+namespace {
+
+// Bigrams are counted in 64 buckets. Collisions only raise the number of
+// shared bigrams, so the filter may let a candidate through but never drops one.
+inline unsigned bucket(char a, char b) {
+  return (static_cast<unsigned char>(a) * 31u + static_cast<unsigned char>(b)) & 63u;
+}
+
+void countBigrams(const std::string& text, uint8_t (&counts)[64]) {
+  std::memset(counts, 0, sizeof(counts));
+  for (size_t i = 1; i < text.size(); i++) {
+    uint8_t& count = counts[bucket(text[i - 1], text[i])];
+    if (count != 255) count++;
+  }
+}
+
+size_t sharedBigrams(const uint8_t (&counts)[64], const std::string& text) {
+  uint8_t left[64];
+  std::memcpy(left, counts, sizeof(left));
+  size_t shared = 0;
+  for (size_t i = 1; i < text.size(); i++) {
+    uint8_t& count = left[bucket(text[i - 1], text[i])];
+    if (count != 0) {
+      count--;
+      shared++;
+    }
+  }
+  return shared;
+}
+
+// Two-row dynamic programming, for patterns too long for one machine word
+size_t classicDistance(const std::string& a, const std::string& b) {
+  std::vector<size_t> row(b.size() + 1);
+  for (size_t j = 0; j <= b.size(); j++) row[j] = j;
+  for (size_t i = 1; i <= a.size(); i++) {
+    size_t diagonal = row[0];
+    row[0] = i;
+    for (size_t j = 1; j <= b.size(); j++) {
+      size_t above = row[j];
+      row[j] = std::min(std::min(row[j] + 1, row[j - 1] + 1), diagonal + (a[i - 1] == b[j - 1] ? 0 : 1));
+      diagonal = above;
+    }
+  }
+  return row[b.size()];
+}
+
+}
+
+Matcher::Matcher(const std::string& pattern): _pattern(pattern) {
+  std::memset(this->_peq, 0, sizeof(this->_peq));
+  for (size_t i = 0; i < pattern.size() && i < 64; i++) {
+    this->_peq[static_cast<unsigned char>(pattern[i])] |= uint64_t(1) << i;
+  }
+  countBigrams(pattern, this->_bigrams);
+}
+
+size_t Matcher::distance(const std::string& text, size_t limit) const {
+  const size_t m = this->_pattern.size();
+  const size_t n = text.size();
+  const size_t lengthDifference = m > n ? m - n : n - m;
+  if (lengthDifference > limit) {
+    return limit + 1;
+  }
+  // Every edit destroys at most two bigrams
+  const size_t longest = std::max(m, n);
+  if (longest > 1 + 2 * limit && sharedBigrams(this->_bigrams, text) + 1 + 2 * limit < longest) {
+    return limit + 1;
+  }
+  if (m == 0) {
+    return n;
+  }
+  if (m > 64) {
+    return classicDistance(this->_pattern, text);
+  }
+
+  // One column of the distance matrix per text character, as vertical
+  // deltas: Pv has the +1 rows, Mv the -1 rows
+  const uint64_t last = uint64_t(1) << (m - 1);
+  uint64_t pv = ~uint64_t(0);
+  uint64_t mv = 0;
+  size_t score = m;
+  for (size_t j = 0; j < n; j++) {
+    const uint64_t eq = this->_peq[static_cast<unsigned char>(text[j])];
+    const uint64_t xv = eq | mv;
+    const uint64_t xh = (((eq & pv) + pv) ^ pv) | eq;
+    uint64_t ph = mv | ~(xh | pv);
+    uint64_t mh = pv & xh;
+    if (ph & last) {
+      score++;
+    } else if (mh & last) {
+      score--;
+    }
+    // The first row is the distance to the empty pattern, which grows by one per column
+    ph = (ph << 1) | 1;
+    mh <<= 1;
+    pv = mh | ~(xv | ph);
+    mv = ph & xv;
+    // The remaining columns can lower the score by at most one each
+    if (score > limit + (n - j - 1)) {
+      return limit + 1;
+    }
+  }
+  return score;
+}
+
+size_t limitFor(const std::string& word) {
+  return std::min<size_t>(3, std::max<size_t>(1, (word.size() + 2) / 3));
+}
+
+std::string nearest(const std::string& word, const std::vector<std::string>& candidates) {
+  const Matcher matcher(word);
+  size_t limit = limitFor(word);
+  const std::string* best = nullptr;
+  for (const std::string& candidate : candidates) {
+    size_t distance = matcher.distance(candidate, limit);
+    if (distance <= limit && distance > 0) {
+      best = &candidate;
+      if (distance == 1) {
+        break;
+      }
+      // Later candidates have to be strictly closer
+      limit = distance - 1;
+    }
+  }
+  return best != nullptr ? *best : std::string();
+}
+
+}
+
+}
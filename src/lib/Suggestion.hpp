@@ -0,0 +1,38 @@
+#ifndef __SUGGESTION_HPP__
+#define __SUGGESTION_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace commandline {
+
+// "Did you mean" for unknown options and actions. The candidates are all
+// names of a scope, several thousand for large tools, so most of them are
+// dismissed by their length and their bigrams before the edit distance is
+// computed with the bit-parallel algorithm of Myers, as formulated by Hyyrö.
+namespace suggest {
+  class Matcher {
+   private:
+    std::string _pattern;
+    // Bit i of _peq[c] is set when _pattern[i] == c; only for patterns of up to 64 characters
+    uint64_t _peq[256];
+    uint8_t _bigrams[64];
+
+   public:
+    explicit Matcher(const std::string& pattern);
+
+    /** Levenshtein distance to text, or any value above limit once it is known to exceed it. */
+    size_t distance(const std::string& text, size_t limit) const;
+  };
+
+  /** How far a candidate may be from word to be suggested. */
+  size_t limitFor(const std::string& word);
+
+  /** The closest candidate within limitFor(word), the first one on ties, or "". */
+  std::string nearest(const std::string& word, const std::vector<std::string>& candidates);
+}
+
+}
+
+#endif
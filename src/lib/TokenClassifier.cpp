@@ -0,0 +1,75 @@
+#include <cstring>
+
+#include "TokenClassifier.hpp"
+
+namespace commandline {
+
+namespace token {
+
+static inline bool isDigit(char c) {
+  return static_cast<unsigned char>(c - '0') < 10;
+}
+
+static inline bool isLetter(char c) {
+  return static_cast<unsigned char>((c | 0x20) - 'a') < 26;
+}
+
+// true if [begin, end) is non-empty and made of digits only
+static bool allDigits(const char* begin, const char* end) {
+  if (begin == end) return false;
+  for (; begin != end; begin++) {
+    if (!isDigit(*begin)) return false;
+  }
+  return true;
+}
+
+Kind classify(const std::string& text, uint32_t& valueOffset) {
+  valueOffset = 0;
+  size_t size = text.size();
+  if (size == 0) {
+    return Empty;
+  }
+  const char* p = text.data();
+  const char* end = p + size;
+  if (p[0] != '-') {
+    if (p[0] == '@') return ResponseFile;
+    return p[0] != '0' && allDigits(p, end) ? Integer : Positional;
+  }
+  if (size == 1) {
+    return Dash;
+  }
+  if (p[1] == '-') {
+    if (size == 2) return EndOfOptions;
+    // memchr is vectorized by the C library, which matters for long values
+    const void* eq = std::memchr(p + 2, '=', size - 2);
+    if (eq == nullptr) return LongOption;
+    valueOffset = static_cast<uint32_t>(static_cast<const char*>(eq) - p) + 1;
+    return LongOptionWithValue;
+  }
+  if (isDigit(p[1]) || p[1] == '.') {
+    return p[1] != '0' && allDigits(p + 1, end) ? NegativeInteger : NegativeNumber;
+  }
+  if (size == 2) {
+    return ShortOption;
+  }
+  valueOffset = 2;
+  for (const char* c = p + 1; c != end; c++) {
+    if (!isLetter(*c)) return ShortWithValue;
+  }
+  return ShortCluster;
+}
+
+void classify(const std::vector<std::string>& args, Classification& out) {
+  size_t count = args.size();
+  out.kinds.resize(count);
+  out.valueOffsets.resize(count);
+  Kind* kinds = out.kinds.data();
+  uint32_t* offsets = out.valueOffsets.data();
+  for (size_t i = 0; i < count; i++) {
+    kinds[i] = classify(args[i], offsets[i]);
+  }
+}
+
+}
+
+}
@@ -0,0 +1,70 @@
+#ifndef __TOKEN_CLASSIFIER_HPP__
+#define __TOKEN_CLASSIFIER_HPP__
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace commandline {
+
+// A single lexical pass over argv that records what every token looks like,
+// so that argument dispatch only inspects this metadata instead of the bytes
+// of each token and its neighbours.
+namespace token {
+  enum Kind : uint8_t {
+    Positional,
+    Empty,
+    /** "@file" */
+    ResponseFile,
+    /** "-" */
+    Dash,
+    /** "--" */
+    EndOfOptions,
+    /** "--name" */
+    LongOption,
+    /** "--name=value" */
+    LongOptionWithValue,
+    /** "-n" */
+    ShortOption,
+    /** "-abc", letters only */
+    ShortCluster,
+    /** "-n9000" */
+    ShortWithValue,
+    /** "123", no leading zero */
+    Integer,
+    /** "-123", no leading zero */
+    NegativeInteger,
+    /** any other token starting with "-" and a digit or ".", e.g. "-0.5" */
+    NegativeNumber
+  };
+
+  struct Classification {
+    std::vector<Kind> kinds;
+    // For LongOptionWithValue the offset of the value after "=", for
+    // ShortCluster and ShortWithValue 2, otherwise 0
+    std::vector<uint32_t> valueOffsets;
+  };
+
+  Kind classify(const std::string&, uint32_t& valueOffset);
+  void classify(const std::vector<std::string>&, Classification&);
+
+  // The token begins with "-"
+  inline bool isDashed(Kind kind) {
+    return kind >= Dash && kind != Integer;
+  }
+  // "-x..." but not "--..."
+  inline bool isShort(Kind kind) {
+    return kind >= ShortOption && kind != Integer;
+  }
+  // Matches ^-?[1-9]\d*$
+  inline bool isInteger(Kind kind) {
+    return kind == Integer || kind == NegativeInteger;
+  }
+  inline bool isNegativeNumber(Kind kind) {
+    return kind == NegativeInteger || kind == NegativeNumber;
+  }
+}
+
+}
+
+#endif
@@ -0,0 +1,352 @@
+#include "ValueParser.hpp"
+#include <cerrno>
+#include <cstdlib>
+#include <limits>
+#include <locale>
+#include <sstream>
+#include <locale.h>
+#ifdef __APPLE__
+#include <xlocale.h>
+#endif
+
+namespace commandline {
+
+namespace value {
+
+static bool isDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+static uint64_t gcd(uint64_t a, uint64_t b) {
+  while (b != 0) {
+    uint64_t r = a % b;
+    a = b;
+    b = r;
+  }
+  return a;
+}
+
+// strtod() expects the decimal point of the current locale; this converts
+// with the C locale, created once
+static double strtodClassic(const char* text) {
+#ifdef _WIN32
+  static const _locale_t classic = _create_locale(LC_NUMERIC, "C");
+  return _strtod_l(text, nullptr, classic);
+#else
+  static const locale_t classic = newlocale(LC_NUMERIC_MASK, "C", static_cast<locale_t>(0));
+  return strtod_l(text, nullptr, classic);
+#endif
+}
+
+// Reads "digits[.digits]" at pos. The fraction is kept as fraction / scale.
+static const char* parseDecimal(const std::string& text, size_t& pos, uint64_t& integer, uint64_t& fraction, uint64_t& scale, size_t& errorOffset) {
+  const size_t length = text.length();
+  const size_t start = pos;
+  integer = 0;
+  fraction = 0;
+  scale = 1;
+  while (pos < length && isDigit(text[pos])) {
+    uint64_t digit = static_cast<uint64_t>(text[pos] - '0');
+    if (integer > (UINT64_MAX - digit) / 10) {
+      errorOffset = pos;
+      return "value is too large";
+    }
+    integer = integer * 10 + digit;
+    pos++;
+  }
+  if (pos < length && text[pos] == '.') {
+    pos++;
+    while (pos < length && isDigit(text[pos])) {
+      if (scale < 1000000000000000000ULL) {
+        fraction = fraction * 10 + static_cast<uint64_t>(text[pos] - '0');
+        scale *= 10;
+      }
+      pos++;
+    }
+  }
+  if (pos == start || (pos == start + 1 && text[start] == '.')) {
+    errorOffset = start;
+    return "a number is expected";
+  }
+  return nullptr;
+}
+
+const char* parseDouble(const std::string& text, double& out, size_t& errorOffset) {
+  const size_t length = text.length();
+  size_t pos = 0;
+  if (pos < length && text[pos] == '-') {
+    pos++;
+  }
+  size_t digits = 0;
+  while (pos < length && isDigit(text[pos])) {
+    pos++;
+    digits++;
+  }
+  if (pos < length && text[pos] == '.') {
+    pos++;
+    while (pos < length && isDigit(text[pos])) {
+      pos++;
+      digits++;
+    }
+  }
+  if (digits == 0) {
+    errorOffset = pos;
+    return "a number is expected";
+  }
+  if (pos < length && (text[pos] == 'e' || text[pos] == 'E')) {
+    pos++;
+    if (pos < length && (text[pos] == '+' || text[pos] == '-')) {
+      pos++;
+    }
+    if (pos == length || !isDigit(text[pos])) {
+      errorOffset = pos;
+      return "an exponent is expected";
+    }
+    while (pos < length && isDigit(text[pos])) {
+      pos++;
+    }
+  }
+  if (pos != length) {
+    errorOffset = pos;
+    return "unexpected character";
+  }
+  errno = 0;
+  out = strtodClassic(text.c_str());
+  if (errno == ERANGE && (out > 1 || out < -1)) {
+    errorOffset = 0;
+    return "value is out of the representable range";
+  }
+  return nullptr;
+}
+
+const char* parseUnsigned(const std::string& text, uint64_t& out, size_t& errorOffset) {
+  const size_t length = text.length();
+  if (length == 0) {
+    errorOffset = 0;
+    return "a number is expected";
+  }
+  out = 0;
+  for (size_t pos = 0; pos < length; pos++) {
+    if (!isDigit(text[pos])) {
+      errorOffset = pos;
+      return pos == 0 && text[pos] == '-' ? "value must not be negative" : "unexpected character";
+    }
+    uint64_t digit = static_cast<uint64_t>(text[pos] - '0');
+    if (out > (UINT64_MAX - digit) / 10) {
+      errorOffset = pos;
+      return "value is too large";
+    }
+    out = out * 10 + digit;
+  }
+  return nullptr;
+}
+
+const char* parseByteSize(const std::string& text, uint64_t& out, size_t& errorOffset) {
+  const size_t length = text.length();
+  size_t pos = 0;
+  if (length > 0 && text[0] == '-') {
+    errorOffset = 0;
+    return "value must not be negative";
+  }
+  uint64_t integer, fraction, scale;
+  const char* error = parseDecimal(text, pos, integer, fraction, scale, errorOffset);
+  if (error != nullptr) {
+    return error;
+  }
+
+  const size_t unitOffset = pos;
+  uint64_t multiplier = 1;
+  if (pos < length && text[pos] != 'B') {
+    int exponent = 0;
+    switch (text[pos]) {
+      case 'k': case 'K': exponent = 1; break;
+      case 'm': case 'M': exponent = 2; break;
+      case 'g': case 'G': exponent = 3; break;
+      case 't': case 'T': exponent = 4; break;
+      case 'p': case 'P': exponent = 5; break;
+      case 'e': case 'E': exponent = 6; break;
+      default:
+        errorOffset = unitOffset;
+        return "unknown size unit";
+    }
+    pos++;
+    uint64_t base = 1000;
+    if (pos < length && text[pos] == 'i') {
+      base = 1024;
+      pos++;
+    }
+    for (int i = 0; i < exponent; i++) {
+      multiplier *= base;
+    }
+  }
+  if (pos < length && text[pos] == 'B') {
+    pos++;
+  }
+  if (pos != length) {
+    errorOffset = unitOffset;
+    return "unknown size unit";
+  }
+
+  if (integer > UINT64_MAX / multiplier) {
+    errorOffset = 0;
+    return "value is too large";
+  }
+  // fraction / scale * multiplier has to be whole: with g = gcd(multiplier,
+  // scale), scale / g must divide fraction. Digits parseDecimal() dropped
+  // beyond its precision can never make up a whole byte.
+  uint64_t fractionBytes = 0;
+  if (fraction != 0 || scale > 1) {
+    const size_t fractionOffset = text.find('.') + 1;
+    uint64_t g = gcd(multiplier, scale);
+    bool whole = fraction % (scale / g) == 0;
+    for (size_t i = fractionOffset + 18; whole && i < unitOffset; i++) {
+      whole = text[i] == '0';
+    }
+    if (!whole) {
+      errorOffset = fractionOffset;
+      return "value is not a whole number of bytes";
+    }
+    fractionBytes = fraction / (scale / g) * (multiplier / g);
+  }
+  out = integer * multiplier;
+  if (out > UINT64_MAX - fractionBytes) {
+    errorOffset = 0;
+    return "value is too large";
+  }
+  out += fractionBytes;
+  return nullptr;
+}
+
+const char* parseDuration(const std::string& text, int64_t& nanoseconds, size_t& errorOffset) {
+  const size_t length = text.length();
+  if (length > 0 && text[0] == '-') {
+    errorOffset = 0;
+    return "value must not be negative";
+  }
+  if (text == "0") {
+    nanoseconds = 0;
+    return nullptr;
+  }
+
+  const uint64_t limit = static_cast<uint64_t>(INT64_MAX);
+  uint64_t total = 0;
+  size_t pos = 0;
+  do {
+    uint64_t integer, fraction, scale;
+    const char* error = parseDecimal(text, pos, integer, fraction, scale, errorOffset);
+    if (error != nullptr) {
+      return error;
+    }
+
+    const size_t unitOffset = pos;
+    uint64_t unit = 0;
+    if (pos + 1 < length && text[pos + 1] == 's' && (text[pos] == 'n' || text[pos] == 'u' || text[pos] == 'm')) {
+      unit = text[pos] == 'n' ? 1ULL : (text[pos] == 'u' ? 1000ULL : 1000000ULL);
+      pos += 2;
+    } else if (pos + 2 < length && text[pos] == '\xC2' && text[pos + 1] == '\xB5' && text[pos + 2] == 's') {
+      unit = 1000ULL;
+      pos += 3;
+    } else if (pos < length) {
+      switch (text[pos]) {
+        case 's': unit = 1000000000ULL; break;
+        case 'm': unit = 60ULL * 1000000000ULL; break;
+        case 'h': unit = 3600ULL * 1000000000ULL; break;
+        case 'd': unit = 86400ULL * 1000000000ULL; break;
+        default: break;
+      }
+      if (unit != 0) {
+        pos++;
+      }
+    }
+    if (unit == 0) {
+      errorOffset = unitOffset;
+      return unitOffset == length ? "a duration unit (ns, us, ms, s, m, h, d) is expected" : "unknown duration unit";
+    }
+
+    if (integer > limit / unit) {
+      errorOffset = 0;
+      return "value is too large";
+    }
+    uint64_t part = integer * unit + static_cast<uint64_t>(static_cast<long double>(fraction) / scale * unit);
+    if (part > limit - total) {
+      errorOffset = 0;
+      return "value is too large";
+    }
+    total += part;
+  } while (pos < length);
+
+  nanoseconds = static_cast<int64_t>(total);
+  return nullptr;
+}
+
+std::string formatDouble(double value) {
+  std::ostringstream out;
+  out.imbue(std::locale::classic());
+  out.precision(15);
+  out << value;
+  double parsed = 0;
+  size_t offset = 0;
+  if (parseDouble(out.str(), parsed, offset) != nullptr || parsed != value) {
+    out.str("");
+    out.precision(17);
+    out << value;
+  }
+  return out.str();
+}
+
+std::string formatUnsigned(uint64_t value) {
+  char buf[24];
+  char* p = buf + sizeof(buf);
+  *--p = '\0';
+  do {
+    *--p = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+  return p;
+}
+
+std::string formatByteSize(uint64_t bytes) {
+  static const char* const units = "KMGTPE";
+  if (bytes != 0) {
+    for (int exponent = 6; exponent > 0; exponent--) {
+      uint64_t iec = 1ULL << (10 * exponent);
+      if (bytes % iec == 0) {
+        return formatUnsigned(bytes / iec) + units[exponent - 1] + "iB";
+      }
+    }
+    uint64_t si = 1000000000000000000ULL;
+    for (int exponent = 6; exponent > 0; exponent--, si /= 1000) {
+      if (bytes % si == 0) {
+        return formatUnsigned(bytes / si) + units[exponent - 1] + "B";
+      }
+    }
+  }
+  return formatUnsigned(bytes) + "B";
+}
+
+std::string formatDuration(int64_t nanoseconds) {
+  static const struct {
+    uint64_t factor;
+    const char* suffix;
+  } units[] = {
+    { 3600000000000ULL, "h" },
+    { 60000000000ULL, "m" },
+    { 1000000000ULL, "s" },
+    { 1000000ULL, "ms" },
+    { 1000ULL, "us" }
+  };
+  if (nanoseconds <= 0) {
+    return "0s";
+  }
+  uint64_t value = static_cast<uint64_t>(nanoseconds);
+  for (const auto& unit : units) {
+    if (value % unit.factor == 0) {
+      return formatUnsigned(value / unit.factor) + unit.suffix;
+    }
+  }
+  return formatUnsigned(value) + "ns";
+}
+
+}
+
+}
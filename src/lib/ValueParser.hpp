@@ -0,0 +1,26 @@
+#ifndef __VALUE_PARSER_HPP__
+#define __VALUE_PARSER_HPP__
+
+#include <string>
+#include <cstddef>
+#include <cstdint>
+
+namespace commandline {
+
+namespace value {
+  // The parsers never allocate. On failure they return a static message and
+  // set errorOffset to the offset of the first offending character.
+  const char* parseDouble(const std::string& text, double& out, size_t& errorOffset);
+  const char* parseUnsigned(const std::string& text, uint64_t& out, size_t& errorOffset);
+  const char* parseByteSize(const std::string& text, uint64_t& out, size_t& errorOffset);
+  const char* parseDuration(const std::string& text, int64_t& nanoseconds, size_t& errorOffset);
+
+  std::string formatDouble(double value);
+  std::string formatUnsigned(uint64_t value);
+  std::string formatByteSize(uint64_t bytes);
+  std::string formatDuration(int64_t nanoseconds);
+}
+
+}
+
+#endif
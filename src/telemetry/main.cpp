@@ -0,0 +1,40 @@
+// Prints the percentiles recorded in a telemetry file, see
+// CommandLineParserOptions::telemetryPath.
+// Usage: commandline-telemetry <file> [action...]
+
+#include <iostream>
+
+#include "commandline/CommandLineTelemetry.hpp"
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    std::cerr << "usage: commandline-telemetry <file> [action...]" << std::endl;
+    return 2;
+  }
+  std::vector<commandline::CommandLineActionTelemetry> actions;
+  try {
+    actions = commandline::CommandLineTelemetry::read(argv[1]);
+  } catch (const std::exception& err) {
+    std::cerr << "commandline-telemetry: " << err.what() << std::endl;
+    return 1;
+  }
+
+  if (argc > 2) {
+    std::vector<commandline::CommandLineActionTelemetry> selected;
+    for (const commandline::CommandLineActionTelemetry& action : actions) {
+      for (int i = 2; i < argc; i++) {
+        if (action.actionName == argv[i]) {
+          selected.push_back(action);
+          break;
+        }
+      }
+    }
+    actions.swap(selected);
+  }
+  if (actions.empty()) {
+    std::cerr << "commandline-telemetry: no executions recorded" << std::endl;
+    return 1;
+  }
+  std::cout << commandline::CommandLineTelemetry::renderReport(actions);
+  return 0;
+}
@@ -0,0 +1,23 @@
+#include "commandline/commandline.hpp"
+
+#include <iostream>
+
+using namespace commandline;
+
+static void onDefineParameters(DynamicCommandLineAction* action) {
+  CommandLineStringDefinition d;
+  d.parameterLongName = "--message";
+  d.description = "The message to print";
+  d.argumentName = "TEXT";
+  action->defineStringParameter(d);
+}
+
+static void onExecute(DynamicCommandLineAction* action) {
+  std::cout << action->getStringParameter("--message")->value() << std::endl;
+}
+
+COMMANDLINE_PLUGIN_EXPORT void commandline_test_plugin_entry(CommandLinePluginDefinition* definition) {
+  definition->onDefineParameters = onDefineParameters;
+  definition->onExecute = onExecute;
+  definition->documentation = "Prints a message from a plugin";
+}
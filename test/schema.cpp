@@ -0,0 +1,37 @@
+#include "commandline/commandline.hpp"
+
+// The schema whose help the build renders ahead of time, see
+// commandline_prerender_help() in cmake/test.cmake
+commandline::CommandLineParser* commandline::createPrerenderParser() {
+  CommandLineParserOptions options;
+  options.toolFilename = "widget";
+  options.toolDescription = "Builds \"widgets\" from C:\\sources, quickly?";
+  DynamicCommandLineParser* parser = new DynamicCommandLineParser(options);
+
+  CommandLineFlagDefinition verboseDef;
+  verboseDef.parameterLongName = "--verbose";
+  verboseDef.parameterShortName = "-v";
+  verboseDef.description = "Print every step";
+  parser->defineFlagParameter(verboseDef);
+
+  CommandLineActionOptions buildOptions;
+  buildOptions.actionName = "build";
+  buildOptions.summary = "Compile the widgets";
+  buildOptions.documentation = "Compiles every widget.\nCaf\xc3\xa9 tabs\tand all.";
+  DynamicCommandLineAction* build = new DynamicCommandLineAction(buildOptions);
+  parser->addAction(build);
+  CommandLineIntegerDefinition jobsDef;
+  jobsDef.parameterLongName = "--jobs";
+  jobsDef.parameterShortName = "-j";
+  jobsDef.description = "Parallel jobs";
+  jobsDef.argumentName = "COUNT";
+  jobsDef.defaultValue = 4;
+  build->defineIntegerParameter(jobsDef);
+
+  CommandLineActionOptions cleanOptions;
+  cleanOptions.actionName = "clean";
+  cleanOptions.summary = "Delete the outputs";
+  cleanOptions.documentation = "Removes the output directory.";
+  parser->addAction(new DynamicCommandLineAction(cleanOptions));
+  return parser;
+}
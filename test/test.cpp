@@ -3,13 +3,30 @@
 #include "commandline/commandline.hpp"
 
 #include <iostream>
+#include <fstream>
+#include <cstdio>
 #include <memory>
 #include <exception>
+#include <sstream>
+#include <csignal>
+#include <future>
+#include <locale>
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
 
 #include "cmocha/cmocha.h"
 
 using namespace commandline;
 
+#ifdef COMMANDLINE_TEST_PRERENDERED_HELP
+// Rendered from test/schema.cpp by the build
+extern const CommandLinePrerenderedHelp testPrerenderedHelp;
+#endif
+
 class TestAction : public CommandLineAction {
  public:
   bool done;
@@ -37,6 +54,57 @@ class TestAction : public CommandLineAction {
   }
 };
 
+class AsyncTestAction : public CommandLineAction {
+ public:
+  typedef enum Mode { Post, WaitForCancellation, RaiseSignal, Deferred } Mode;
+  Mode mode;
+  bool done;
+  AsyncTestAction(Mode m, std::chrono::milliseconds timeout): CommandLineAction(), mode(m), done(false) {
+    CommandLineActionOptions o;
+    o.actionName = "wait";
+    o.summary = "waits";
+    o.timeout = timeout;
+    this->_init(o);
+  }
+ protected:
+  void onDefineParameters() {}
+  void onExecute() {}
+
+  std::future<void> onExecuteAsync(CommandLineExecutionContext& context) {
+    if (mode == Post) {
+      std::shared_ptr<std::promise<void>> promise = std::make_shared<std::promise<void>>();
+      context.executor().post([this, promise]() {
+        done = true;
+        promise->set_value();
+      });
+      return promise->get_future();
+    }
+    if (mode == Deferred) {
+      return std::async(std::launch::deferred, [this]() {
+        done = true;
+      });
+    }
+    if (mode == RaiseSignal) {
+      std::raise(SIGINT);
+    }
+    const CommandLineCancellationToken* token = &context.token();
+    return std::async(std::launch::async, [this, token]() {
+      token->waitFor(std::chrono::seconds(10));
+      done = true;
+    });
+  }
+};
+
+class AsyncTestCommandLine : public CommandLineParser {
+ public:
+  AsyncTestCommandLine(AsyncTestAction* action): CommandLineParser() {
+    CommandLineParserOptions o;
+    o.toolFilename = "example";
+    this->_init(o);
+    this->addAction(action);
+  }
+};
+
 class TestCommandLine : public CommandLineParser {
  public:
   TestCommandLine(): CommandLineParser() {
@@ -48,6 +116,46 @@ class TestCommandLine : public CommandLineParser {
   }
 };
 
+static int registeredActionsConstructed = 0;
+
+class RegisteredPublishAction : public CommandLineAction {
+ public:
+  bool done;
+  RegisteredPublishAction(): CommandLineAction(), done(false) {
+    CommandLineActionOptions o;
+    o.actionName = "publish";
+    o.summary = "Publish the package";
+    this->_init(o);
+    registeredActionsConstructed++;
+  }
+  void onDefineParameters() {
+    CommandLineStringDefinition d;
+    d.parameterLongName = "--registry";
+    d.description = "Registry URL";
+    d.argumentName = "URL";
+    this->defineStringParameter(d);
+  }
+  void onExecute() {
+    this->done = true;
+  }
+};
+
+class RegisteredUnpublishAction : public CommandLineAction {
+ public:
+  RegisteredUnpublishAction(): CommandLineAction() {
+    CommandLineActionOptions o;
+    o.actionName = "unpublish";
+    o.summary = "Remove the package";
+    this->_init(o);
+    registeredActionsConstructed++;
+  }
+  void onDefineParameters() {}
+  void onExecute() {}
+};
+
+COMMANDLINE_REGISTER_ACTION(RegisteredPublishAction, "publish", "Publish the package")
+COMMANDLINE_REGISTER_ACTION(RegisteredUnpublishAction, "unpublish", "Remove the package")
+
 class ActionlessParser : public CommandLineParser {
  public:
   CommandLineFlagParameter* flag;
@@ -102,6 +210,50 @@ static int executes_an_action() {
 }
 
 
+static int executes_an_action_asynchronously() {
+  AsyncTestAction* action = new AsyncTestAction(AsyncTestAction::Post, std::chrono::milliseconds::zero());
+  AsyncTestCommandLine commandLineParser(action);
+  commandLineParser.executeAsync({ "wait" });
+  expect(action->done == true);
+  return 0;
+}
+
+static int runs_a_deferred_action() {
+  AsyncTestAction* action = new AsyncTestAction(AsyncTestAction::Deferred, std::chrono::milliseconds(20));
+  AsyncTestCommandLine commandLineParser(action);
+  commandLineParser.executeAsync({ "wait" });
+  expect(action->done == true);
+  return 0;
+}
+
+static int cancels_an_action_after_its_timeout() {
+  AsyncTestAction* action = new AsyncTestAction(AsyncTestAction::WaitForCancellation, std::chrono::milliseconds(20));
+  AsyncTestCommandLine commandLineParser(action);
+  auto start = std::chrono::steady_clock::now();
+  try {
+    commandLineParser.executeAsync({ "wait" });
+  } catch (const CommandLineError& err) {
+    expect(err.code() == EXECUTION_TIMEOUT);
+    expect(action->done == true);
+    expect(std::chrono::steady_clock::now() - start < std::chrono::seconds(5));
+    return 0;
+  }
+  return 1;
+}
+
+static int cancels_an_action_on_sigint() {
+  AsyncTestAction* action = new AsyncTestAction(AsyncTestAction::RaiseSignal, std::chrono::milliseconds::zero());
+  AsyncTestCommandLine commandLineParser(action);
+  try {
+    commandLineParser.executeAsync({ "wait" });
+  } catch (const CommandLineError& err) {
+    expect(err.code() == EXECUTION_CANCELLED);
+    expect(action->done == true);
+    return 0;
+  }
+  return 1;
+}
+
 static int parse_an_action() {
   CommandLineParserOptions options;
   options.toolFilename = "example";
@@ -273,6 +425,103 @@ static int parses_an_action_input_with_remainder() {
   return 0;
 }
 
+static void setTestEnv(const char* name, const char* value) {
+#ifdef _WIN32
+  _putenv_s(name, value == nullptr ? "" : value);
+#else
+  if (value == nullptr) {
+    unsetenv(name);
+  } else {
+    setenv(name, value, 1);
+  }
+#endif
+}
+
+static int renders_an_argument_buffer() {
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser2());
+  CommandLineAction* action = commandLineParser->getAction("run");
+  CommandLineArgumentBuffer buffer("worker");
+  buffer.addProvider(commandLineParser.get());
+  buffer.addProvider(action);
+  buffer.setPassthroughArgs({ "--unknown" });
+  buffer.setInheritEnvironment(false);
+  buffer.setEnvironmentVariable("WORKER_ID", "1");
+
+  commandLineParser->execute({ "--verbose", "run", "--title", "The title", "the", "args" });
+
+  char* const* argv = buffer.argv();
+  const std::vector<std::string> expected = { "worker", "--verbose", "--title", "The title", "the", "args", "--unknown" };
+  expect(buffer.argc() == expected.size());
+  for (size_t i = 0; i < expected.size(); i++) {
+    expect(expected[i] == argv[i]);
+  }
+  expect(argv[expected.size()] == nullptr);
+  expect(std::string(buffer.envp()[0]) == "WORKER_ID=1");
+  expect(buffer.envp()[1] == nullptr);
+
+  // unchanged values reuse the rendered buffer
+  expect(buffer.argv() == argv);
+  expect(buffer.argv()[3] == argv[3]);
+
+  CommandLineArgumentBuffer filtered("worker");
+  filtered.addProvider(action, false);
+  filtered.setFilter([](const CommandLineParameter* p) { return p->longName != "--title"; });
+  expect(filtered.argc() == 1);
+
+  // A flag that defaults to true is passed when it was turned off
+  DynamicCommandLineParser flagParser;
+  CommandLineFlagDefinition colorDef;
+  colorDef.parameterLongName = "--color";
+  colorDef.description = "Colored output";
+  colorDef.defaultValue = true;
+  const CommandLineFlagParameter* color = flagParser.defineFlagParameter(colorDef);
+  flagParser.execute({ "--color", "false" });
+  expect(color->value() == false);
+  CommandLineArgumentBuffer flags("worker");
+  flags.addProvider(&flagParser);
+  expect(flags.argc() == 3 && std::string(flags.argv()[1]) == "--color" && std::string(flags.argv()[2]) == "false");
+  DynamicCommandLineParser child;
+  const CommandLineFlagParameter* childColor = child.defineFlagParameter(colorDef);
+  child.execute(std::vector<std::string>(flags.argv() + 1, flags.argv() + flags.argc()));
+  expect(childColor->value() == false);
+
+  // The inherited environment is read live, with "=" allowed in values
+  setTestEnv("COMMANDLINE_TEST_EQ", "a=b=c");
+  CommandLineArgumentBuffer inherited("worker");
+  auto findEnv = [&inherited](const std::string& entry) {
+    for (char* const* e = inherited.envp(); *e != nullptr; e++) {
+      if (entry == *e) return true;
+    }
+    return false;
+  };
+  expect(findEnv("COMMANDLINE_TEST_EQ=a=b=c"));
+  setTestEnv("COMMANDLINE_TEST_LATER", "1");
+  inherited.invalidate();
+  expect(findEnv("COMMANDLINE_TEST_LATER=1"));
+  setTestEnv("COMMANDLINE_TEST_EQ", nullptr);
+  setTestEnv("COMMANDLINE_TEST_LATER", nullptr);
+
+  // Writes of the application to bound fields are forwarded once invalidated
+  std::string output;
+  DynamicCommandLineParser boundParser;
+  CommandLineStringDefinition outputDef;
+  outputDef.parameterLongName = "--output";
+  outputDef.argumentName = "PATH";
+  outputDef.description = "Output path";
+  boundParser.defineStringParameter(outputDef)->bind(output);
+  boundParser.execute({ "--output", "a" });
+  CommandLineArgumentBuffer bound("worker");
+  bound.addProvider(&boundParser);
+  expect(bound.argc() == 3 && std::string(bound.argv()[2]) == "a");
+  char* const* boundArgv = bound.argv();
+  expect(bound.argv() == boundArgv);
+  output = "b";
+  expect(bound.argv() == boundArgv && std::string(bound.argv()[2]) == "a");
+  bound.invalidate();
+  expect(std::string(bound.argv()[2]) == "b");
+  return 0;
+}
+
 static int prints_the_action_help() {
   std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser2());
   try {
@@ -334,6 +583,587 @@ static int parses_an_input_with_ALL_parameters() {
   return 0;
 }
 
+static int encodes_a_parse_result() {
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
+  try {
+    commandLineParser->execute({ "--global-flag", "do:the-job", "--choice", "two", "--integer", "123",
+      "--integer-required", "321", "--string-list", "first", "--string-list", "second" });
+    std::vector<uint64_t> buffer = CommandLineResult::encode(*commandLineParser);
+    expect(buffer.size() * 8 >= CommandLineResult::encodedSize(*commandLineParser));
+
+    CommandLineResultView view(buffer.data(), buffer.size() * 8);
+    expect(view.global().getFlagParameter("--global-flag") == true);
+    expect(view.hasAction());
+    expect(view.actionName() == "do:the-job");
+    const CommandLineResultScope& action = view.action();
+    expect(action.parameterCount() == commandLineParser->selectedAction->parameters().size());
+    expect(action.getChoiceParameter("--choice") == "two");
+    expect(action.getChoiceIndex("--choice") == 1);
+    expect(action.getIntegerParameter("--integer") == 123);
+    expect(action.getIntegerParameter("--integer-with-default") == 123);
+    expect(action.getStringParameter("--string-with-default") == "123");
+    expect(action.getStringListParameter("--string-list").str() == std::vector<std::string>({ "first", "second" }));
+    expect(action.valueSource(action.idOf("--integer")) == CommandLineValueSource::CommandLine);
+    expect(action.valueSource(action.idOf("--integer-with-default")) == CommandLineValueSource::Default);
+    expect(action.idOf("--missing") == -1);
+    try {
+      action.getStringParameter("--integer");
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == PARAMETER_TYPE_ERROR);
+    }
+
+    reinterpret_cast<char*>(buffer.data())[0] = 'X';
+    try {
+      CommandLineResultView corrupted(buffer.data(), buffer.size() * 8);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == RESULT_INVALID);
+    }
+
+#ifdef __linux__
+    int fd = CommandLineResult::encodeToMemfd(*commandLineParser);
+    size_t size = CommandLineResult::encodedSize(*commandLineParser);
+    void* mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    expect(mapping != MAP_FAILED);
+    CommandLineResultView mapped(mapping, size);
+    expect(mapped.action().getIntegerParameter("--integer-required") == 321);
+    munmap(mapping, size);
+#endif
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int parses_global_values_before_the_action() {
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
+  CommandLineStringDefinition d;
+  d.parameterLongName = "--profile";
+  d.description = "A global string";
+  d.argumentName = "NAME";
+  commandLineParser->defineStringParameter(d);
+  CommandLineAction* action = commandLineParser->getAction("do:the-job");
+  try {
+    commandLineParser->execute({ "--profile", "staging", "-g", "true", "do:the-job", "--string=a=b", "--integer-required", "-5" });
+    expect(commandLineParser->selectedAction == action);
+    expect(commandLineParser->getStringParameter("--profile")->value() == "staging");
+    expect(commandLineParser->getFlagParameter("--global-flag")->value() == true);
+    expect(action->getStringParameter("--string")->value() == "a=b");
+    expect(action->getIntegerParameter("--integer-required")->value() == -5);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int accepts_global_values_after_the_action() {
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
+  CommandLineStringDefinition d;
+  d.parameterLongName = "--profile";
+  d.description = "A global string";
+  d.argumentName = "NAME";
+  commandLineParser->defineStringParameter(d);
+  CommandLineAction* action = commandLineParser->getAction("do:the-job");
+  try {
+    commandLineParser->execute({ "do:the-job", "--integer-required", "1", "-g", "--profile", "staging" });
+    expect(commandLineParser->selectedAction == action);
+    expect(commandLineParser->getFlagParameter("--global-flag")->value() == true);
+    expect(commandLineParser->getStringParameter("--profile")->value() == "staging");
+    expect(action->getIntegerParameter("--integer-required")->value() == 1);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  // Live validation accepts the same input
+  {
+    CommandLineIncrementalParser incremental(*commandLineParser);
+    incremental.reset({ "do:the-job", "--integer-required", "1", "-g", "--profile", "staging" });
+    expect(incremental.diagnostics().empty());
+    expect(incremental.tokens()[3].parameter == commandLineParser->getFlagParameter("--global-flag"));
+    expect(incremental.tokens()[5].kind == CommandLineTokenKind::Value);
+  }
+  {
+    CommandLineParserOptions o;
+    o.allowAbbreviations = true;
+    DynamicCommandLineParser abbreviating(o);
+    CommandLineFlagDefinition verbose;
+    verbose.parameterLongName = "--verbose";
+    verbose.description = "A global flag";
+    abbreviating.defineFlagParameter(verbose);
+    CommandLineActionOptions actionOptions;
+    actionOptions.actionName = "build";
+    actionOptions.summary = "builds";
+    abbreviating.addAction(new DynamicCommandLineAction(actionOptions));
+    CommandLineIncrementalParser incremental(abbreviating);
+    incremental.reset({ "build", "--verb" });
+    expect(incremental.diagnostics().empty());
+    expect(incremental.tokens()[1].parameter == abbreviating.getFlagParameter("--verbose"));
+  }
+
+  // An action parameter of the same name wins over the global one
+  commandLineParser.reset(createParser());
+  commandLineParser->defineStringParameter(d);
+  action = commandLineParser->getAction("do:the-job");
+  action->defineStringParameter(d);
+  try {
+    commandLineParser->execute({ "--profile", "global", "do:the-job", "--integer-required", "1", "--profile", "local" });
+    expect(commandLineParser->getStringParameter("--profile")->value() == "global");
+    expect(action->getStringParameter("--profile")->value() == "local");
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int suggests_names_for_unknown_options_and_actions() {
+  const std::vector<std::vector<std::string>> inputs = {
+    { "do:the-job", "--integer-requird", "1" },
+    { "do:the-job", "--integer-required", "1", "--global-flg" },
+    { "do:teh-job" },
+    { "--nothing-like-it" }
+  };
+  const char* messages[] = {
+    "The parameter \"--integer-requird\" is not defined. Did you mean \"--integer-required\"?",
+    "The parameter \"--global-flg\" is not defined. Did you mean \"--global-flag\"?",
+    "Unrecognized action. Did you mean \"do:the-job\"?",
+    "The parameter \"--nothing-like-it\" is not defined"
+  };
+  for (size_t i = 0; i < inputs.size(); i++) {
+    std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
+    try {
+      commandLineParser->execute(inputs[i]);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(std::string(err.what()) == messages[i]);
+    }
+  }
+
+  CommandLineParserOptions options;
+  options.allowAbbreviations = true;
+  DynamicCommandLineParser commandLineParser(options);
+  const char* names[] = { "--verbose", "--version", "--output" };
+  for (const char* name : names) {
+    CommandLineFlagDefinition d;
+    d.parameterLongName = name;
+    d.description = "A flag";
+    commandLineParser.defineFlagParameter(d);
+  }
+  try {
+    commandLineParser.execute({ "--verb", "--out" });
+    expect(commandLineParser.getFlagParameter("--verbose")->value() == true);
+    expect(commandLineParser.getFlagParameter("--output")->value() == true);
+    expect(commandLineParser.getFlagParameter("--version")->value() == false);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  // "--ver" could be either
+  DynamicCommandLineParser ambiguous(options);
+  for (const char* name : names) {
+    CommandLineFlagDefinition d;
+    d.parameterLongName = name;
+    d.description = "A flag";
+    ambiguous.defineFlagParameter(d);
+  }
+  try {
+    ambiguous.execute({ "--ver" });
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == PARAMETER_UNDEFINED);
+  }
+  return 0;
+}
+
+static int rejects_input_beyond_strict_limits() {
+  CommandLineParserOptions options;
+  options.strict = true;
+  options.limits.maxArguments = 8;
+  options.limits.maxArgumentLength = 16;
+  options.limits.maxListValues = 2;
+  options.limits.maxTotalBytes = 40;
+  const std::vector<std::vector<std::string>> inputs = {
+    { "--item", "a", "--item", "b", "--item", "c" },
+    { "--item", "a", "--item", "bbbbbbbbbbbbbbbbb" },
+    { "--item", "aaaaaaaaaaaaaaaa", "--item", "bbbbbbbbbbbbbbbb" },
+    { "-v", "-v", "-v", "-v", "-v", "-v", "-v", "-v", "-v" }
+  };
+  const CommandLineErrorCode codes[] = { TOO_MANY_VALUES, ARGUMENT_TOO_LONG, INPUT_TOO_LARGE, TOO_MANY_ARGUMENTS };
+  const size_t positions[] = { CommandLineError::noPosition, 3, 3, 8 };
+  for (size_t i = 0; i < inputs.size(); i++) {
+    DynamicCommandLineParser commandLineParser(options);
+    CommandLineStringListDefinition itemDef;
+    itemDef.parameterLongName = "--item";
+    itemDef.description = "An item";
+    itemDef.argumentName = "ITEM";
+    commandLineParser.defineStringListParameter(itemDef);
+    CommandLineFlagDefinition verboseDef;
+    verboseDef.parameterLongName = "--verbose";
+    verboseDef.parameterShortName = "-v";
+    verboseDef.description = "Verbose output";
+    commandLineParser.defineFlagParameter(verboseDef);
+    try {
+      commandLineParser.execute(inputs[i]);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == codes[i]);
+      expect(err.position() == positions[i]);
+    }
+  }
+
+  DynamicCommandLineParser commandLineParser(options);
+  CommandLineStringListDefinition itemDef;
+  itemDef.parameterLongName = "--item";
+  itemDef.description = "An item";
+  itemDef.argumentName = "ITEM";
+  const CommandLineStringListParameter* items = commandLineParser.defineStringListParameter(itemDef);
+  CommandLineRemainderDefinition remainderDef;
+  commandLineParser.defineCommandLineRemainder(remainderDef);
+  try {
+    commandLineParser.execute({ "--item", "a", "x", "y", "z" });
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == TOO_MANY_VALUES);
+    expect(err.position() == 4);
+  }
+  // Within the limits the list keeps the storage reserved for it
+  DynamicCommandLineParser accepted(options);
+  items = accepted.defineStringListParameter(itemDef);
+  try {
+    accepted.execute({ "--item", "a", "--item", "b" });
+    expect(items->values().size() == 2);
+    expect(items->values().capacity() == 2);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int reports_the_position_of_scan_errors() {
+  const std::vector<std::vector<std::string>> inputs = {
+    { "do:the-job", "--integer-required", "1", "--nope" },
+    { "-g", "do:the-job", "--integer-required", "1", "--string" },
+    { "--global-flag", "maybe" }
+  };
+  const CommandLineErrorCode codes[] = { PARAMETER_UNDEFINED, VALUE_REQUIRED, ACTION_UNDEFINED };
+  const size_t positions[] = { 3, 4, 1 };
+  for (size_t i = 0; i < inputs.size(); i++) {
+    std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
+    try {
+      commandLineParser->execute(inputs[i]);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == codes[i]);
+      expect(err.position() == positions[i]);
+    }
+  }
+
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
+  CommandLineAction* action = commandLineParser->getAction("do:the-job");
+  try {
+    // A flag takes only a boolean literal; "-" and "" are ordinary values
+    commandLineParser->execute({ "do:the-job", "--flag", "false", "--string", "-", "--integer-required", "7", "--string-with-default", "" });
+    expect(action->getFlagParameter("--flag")->value() == false);
+    expect(action->getFlagParameter("--flag")->hasValue());
+    expect(action->getStringParameter("--string")->value() == "-");
+    expect(action->getStringParameter("--string-with-default")->value() == "");
+    expect(action->getIntegerParameter("--integer-required")->value() == 7);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int keeps_static_schema_text_in_place() {
+  using namespace commandline::literals;
+  static const char* const documentation = "Copies files between hosts.";
+  DynamicCommandLineParser commandLineParser;
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "copy";
+  actionOptions.summary = "copies files"_text;
+  actionOptions.documentation = CommandLineText::fromStatic(documentation);
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser.addAction(action);
+
+  CommandLineFlagDefinition definition;
+  definition.parameterLongName = "--recursive";
+  definition.description = "Copies directories and everything below them"_text;
+  const CommandLineFlagParameter* recursive = action->defineFlagParameter(definition);
+  CommandLineFlagDefinition copied;
+  copied.parameterLongName = "--force";
+  copied.description = std::string("Overwrites existing files");
+  const CommandLineFlagParameter* force = action->defineFlagParameter(copied);
+
+  expect(recursive->description.isStatic());
+  expect(recursive->description.data() == definition.description.data());
+  expect(action->summary.isStatic());
+  expect(action->documentation.data() == documentation);
+  expect(!force->description.isStatic());
+  expect(force->description == "Overwrites existing files");
+  std::string help = action->renderHelpText("tool");
+  expect(help.find("Copies directories and everything below them") != std::string::npos);
+  expect(help.find(documentation) != std::string::npos);
+  return 0;
+}
+
+static int keeps_help_text_compressed_until_read() {
+  const std::vector<std::string> texts = {
+    "Compile the project",
+    "Number of parallel jobs; defaults to the number of cores. The number of jobs is capped at 256.",
+    "",
+    "Directory for the build outputs"
+  };
+  std::string blob = CommandLineTextResource::pack(texts);
+  CommandLineTextResource resource(blob);
+  expect(resource.size() == texts.size());
+
+  auto createTool = [](const std::vector<CommandLineText>& text) {
+    DynamicCommandLineParser* parser = new DynamicCommandLineParser();
+    CommandLineActionOptions actionOptions;
+    actionOptions.actionName = "build";
+    actionOptions.summary = text[0];
+    DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+    parser->addAction(action);
+    CommandLineIntegerDefinition jobsDef;
+    jobsDef.parameterLongName = "--jobs";
+    jobsDef.description = text[1];
+    jobsDef.argumentName = "COUNT";
+    action->defineIntegerParameter(jobsDef);
+    CommandLineStringDefinition outputDef;
+    outputDef.parameterLongName = "--output";
+    outputDef.description = text[3];
+    outputDef.argumentName = "DIR";
+    action->defineStringParameter(outputDef);
+    return parser;
+  };
+  std::vector<CommandLineText> compressed;
+  for (size_t i = 0; i < resource.size(); i++) {
+    compressed.push_back(resource.text(i));
+  }
+  std::unique_ptr<DynamicCommandLineParser> tool(createTool(compressed));
+  try {
+    tool->execute({ "build", "--jobs", "4" });
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  // Neither defining nor parsing reads the text
+  expect(!resource.isLoaded());
+  expect(compressed[2].empty() && compressed[1].size() == texts[1].size());
+
+  std::unique_ptr<DynamicCommandLineParser> plain(createTool(std::vector<CommandLineText>(texts.begin(), texts.end())));
+  expect(tool->renderHelpText() == plain->renderHelpText());
+  expect(tool->getAction("build")->renderHelpText("tool") == plain->getAction("build")->renderHelpText("tool"));
+  expect(resource.isLoaded());
+  expect(compressed[3] == texts[3]);
+
+  std::string damaged = blob;
+  damaged[damaged.size() - 1] ^= 0x5a;
+  damaged.resize(damaged.size() - 2);
+  CommandLineTextResource broken(damaged);
+  try {
+    broken.text(1).str();
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == RESOURCE_INVALID);
+  }
+  return 0;
+}
+
+static int shares_a_parameter_set_between_scopes() {
+  std::shared_ptr<CommandLineParameterSet> common(new CommandLineParameterSet());
+  CommandLineFlagDefinition verboseDef;
+  verboseDef.parameterLongName = "--verbose";
+  verboseDef.parameterShortName = "-v";
+  verboseDef.description = "Verbose output";
+  const CommandLineFlagParameter* verbose = common->defineFlagParameter(verboseDef);
+  CommandLineIntegerDefinition jobsDef;
+  jobsDef.parameterLongName = "--jobs";
+  jobsDef.description = "Parallel jobs";
+  jobsDef.argumentName = "COUNT";
+  jobsDef.defaultValue = 1;
+  const CommandLineIntegerParameter* jobs = common->defineIntegerParameter(jobsDef);
+
+  DynamicCommandLineParser commandLineParser;
+  commandLineParser.attachParameterSet(common);
+  const char* names[] = { "build", "test" };
+  for (const char* name : names) {
+    CommandLineActionOptions actionOptions;
+    actionOptions.actionName = name;
+    DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+    commandLineParser.addAction(action);
+    action->attachParameterSet(common);
+  }
+  CommandLineAction* build = commandLineParser.getAction("build");
+  CommandLineAction* test = commandLineParser.getAction("test");
+
+  try {
+    expect(build->getFlagParameter("-v") == verbose);
+    expect(test->getIntegerParameter("--jobs") == jobs);
+    expect(build->parameters().size() == 2);
+    expect(build->renderHelpText("tool").find("--jobs") != std::string::npos);
+    // The value given before the action survives the action scope
+    commandLineParser.execute({ "-v", "build", "--jobs", "4" });
+    expect(commandLineParser.selectedAction == build);
+    expect(verbose->value() == true);
+    expect(jobs->value() == 4);
+    expect(test->getIntegerParameter("--jobs")->value() == 4);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  // An attached set is fixed, and its names cannot be taken twice in a scope
+  CommandLineFlagDefinition lateDef;
+  lateDef.parameterLongName = "--late";
+  lateDef.description = "Defined after attaching";
+  CommandLineFlagDefinition quietDef;
+  quietDef.parameterLongName = "--quiet";
+  quietDef.parameterShortName = "-v";
+  quietDef.description = "Takes the short name of --verbose";
+  std::vector<std::function<void()>> conflicts = {
+    [&]() { common->defineFlagParameter(lateDef); },
+    [&]() { commandLineParser.defineFlagParameter(quietDef); },
+    [&]() { build->attachParameterSet(common); },
+    [&]() {
+      DynamicCommandLineParser other;
+      other.defineFlagParameter(quietDef);
+      other.attachParameterSet(common);
+    }
+  };
+  for (size_t i = 0; i < conflicts.size(); i++) {
+    try {
+      conflicts[i]();
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == (i == 0 ? PARAMETER_SET_ATTACHED : PARAMETER_NAME_CONFLICT));
+    }
+  }
+  expect(build->parameters().size() == 2);
+  return 0;
+}
+
+static int writes_values_into_bound_fields() {
+  struct Config {
+    bool verbose = false;
+    int64_t jobs = 0;
+    std::string output;
+    std::vector<std::string> includes;
+    int mode = -1;
+  } config;
+
+  DynamicCommandLineParser commandLineParser;
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "build";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser.addAction(action);
+
+  CommandLineFlagDefinition verboseDef;
+  verboseDef.parameterLongName = "--verbose";
+  verboseDef.description = "Verbose output";
+  commandLineParser.defineFlagParameter(verboseDef)->bind(config.verbose);
+  CommandLineIntegerDefinition jobsDef;
+  jobsDef.parameterLongName = "--jobs";
+  jobsDef.description = "Parallel jobs";
+  jobsDef.argumentName = "COUNT";
+  jobsDef.defaultValue = 2;
+  action->defineIntegerParameter(jobsDef)->bind(config.jobs);
+  CommandLineStringDefinition outputDef;
+  outputDef.parameterLongName = "--output";
+  outputDef.description = "Output directory";
+  outputDef.argumentName = "DIR";
+  action->defineStringParameter(outputDef)->bind(config.output);
+  CommandLineStringListDefinition includeDef;
+  includeDef.parameterLongName = "--include";
+  includeDef.description = "Include directory";
+  includeDef.argumentName = "DIR";
+  action->defineStringListParameter(includeDef)->bind(config.includes);
+  CommandLineChoiceDefinition modeDef;
+  modeDef.parameterLongName = "--mode";
+  modeDef.description = "Build mode";
+  modeDef.alternatives = { "debug", "release" };
+  modeDef.defaultValue = "debug";
+  action->defineChoiceParameter(modeDef)->bindConverter([&config](const CommandLineParameter& p) {
+    config.mode = static_cast<int>(static_cast<const CommandLineChoiceParameter&>(p).index());
+  });
+
+  try {
+    commandLineParser.execute({ "--verbose", "build", "--output", "out", "--include", "a", "--include", "b", "--mode", "release" });
+    expect(config.verbose == true);
+    // Defaults are written too, without anyone reading the parameter
+    expect(config.jobs == 2);
+    expect(config.output == "out");
+    expect(config.includes.size() == 2 && config.includes[1] == "b");
+    expect(config.mode == 1);
+    expect(action->getStringListParameter("--include")->values().size() == 2);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int resolves_environment_values_on_first_read() {
+  DynamicCommandLineParser commandLineParser;
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "run";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser.addAction(action);
+
+  CommandLineIntegerDefinition retriesDef;
+  retriesDef.parameterLongName = "--retries";
+  retriesDef.description = "Never read unless needed";
+  retriesDef.argumentName = "COUNT";
+  retriesDef.environmentVariable = "COMMANDLINE_TEST_RETRIES";
+  const CommandLineIntegerParameter* retries = action->defineIntegerParameter(retriesDef);
+  CommandLineStringListDefinition tagDef;
+  tagDef.parameterLongName = "--tag";
+  tagDef.description = "Tags";
+  tagDef.argumentName = "TAG";
+  tagDef.environmentVariable = "COMMANDLINE_TEST_TAG";
+  const CommandLineStringListParameter* tag = action->defineStringListParameter(tagDef);
+  CommandLineStringDefinition userDef;
+  userDef.parameterLongName = "--user";
+  userDef.description = "The user";
+  userDef.argumentName = "NAME";
+  userDef.environmentVariable = "COMMANDLINE_TEST_USER";
+  userDef.defaultValue = "nobody";
+  const CommandLineStringParameter* user = action->defineStringParameter(userDef);
+
+  setTestEnv("COMMANDLINE_TEST_RETRIES", "many");
+  setTestEnv("COMMANDLINE_TEST_TAG", "from-env");
+  setTestEnv("COMMANDLINE_TEST_USER", "alice");
+  int result = 0;
+  try {
+    // The invalid environment value is only reported when --retries is read
+    commandLineParser.execute({ "run", "--tag", "a", "--tag", "b" });
+    expect(tag->valueSource() == CommandLineValueSource::CommandLine);
+    expect(tag->values().size() == 2);
+    expect(user->valueSource() == CommandLineValueSource::Environment);
+    expect(user->value() == "alice");
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    result = 1;
+  }
+  setTestEnv("COMMANDLINE_TEST_TAG", nullptr);
+  setTestEnv("COMMANDLINE_TEST_USER", nullptr);
+  try {
+    retries->value();
+    result = 1;
+  } catch (const CommandLineError& err) {
+    if (err.code() != INVALID_ENV_VALUE) result = 1;
+  }
+  setTestEnv("COMMANDLINE_TEST_RETRIES", nullptr);
+  return result;
+}
+
 static int parses_an_input_with_NO_parameters() {
   std::unique_ptr<DynamicCommandLineParser> commandLineParser(createParser());
   CommandLineAction* action = commandLineParser->getAction("do:the-job");
@@ -372,6 +1202,215 @@ static int test_action_help() {
     return 1;
   }
 
+  // Nothing after the help option is scanned
+  const std::vector<std::vector<std::string>> inputs = {
+    { "do:the-job", "-h", "--bogus" },
+    { "-h", "--bogus" },
+    { "do:the-job", "--help", "--integer-required", "not-a-number" }
+  };
+  for (const std::vector<std::string>& input : inputs) {
+    commandLineParser.reset(createParser());
+    try {
+      commandLineParser->execute(input);
+    } catch (const std::exception& err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+    if (commandLineParser->selectedAction != nullptr) {
+      expect(!commandLineParser->selectedAction->getIntegerParameter("--integer-required")->hasValue());
+    }
+  }
+
+  return 0;
+}
+
+static int searches_the_help_of_all_actions() {
+  DynamicCommandLineParser commandLineParser;
+  const char* actions[][3] = {
+    { "build", "Compile the project", "Builds every target of the workspace." },
+    { "build-docs", "Render the documentation", "Writes HTML pages." },
+    { "clean", "Delete build outputs", "Removes the output directory." },
+    { "deploy", "Upload the release", "Needs credentials for the registry." }
+  };
+  for (const auto& a : actions) {
+    CommandLineActionOptions actionOptions;
+    actionOptions.actionName = a[0];
+    actionOptions.summary = a[1];
+    actionOptions.documentation = a[2];
+    commandLineParser.addAction(new DynamicCommandLineAction(actionOptions));
+  }
+  CommandLineStringDefinition registryDef;
+  registryDef.parameterLongName = "--registry";
+  registryDef.description = "Registry URL";
+  registryDef.argumentName = "URL";
+  commandLineParser.getAction("deploy")->defineStringParameter(registryDef);
+
+  std::vector<const CommandLineAction*> found = commandLineParser.searchActions("build");
+  expect(found.size() == 3);
+  // The action named after the word ranks first
+  expect(found[0]->actionName == "build");
+  // Every word has to match
+  found = commandLineParser.searchActions("Build output");
+  expect(found.size() == 1 && found[0]->actionName == "clean");
+  found = commandLineParser.searchActions("regis");
+  expect(found.size() == 1 && found[0]->actionName == "deploy");
+  expect(commandLineParser.searchActions("nothing").empty());
+  expect(commandLineParser.renderSearchResults("docs").find("build-docs") != std::string::npos);
+
+  try {
+    commandLineParser.execute({ "help", "--search", "html" });
+    expect(commandLineParser.selectedAction == nullptr);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int prerenders_the_help_at_build_time() {
+  std::unique_ptr<CommandLineParser> parser(createPrerenderParser());
+#ifdef COMMANDLINE_TEST_PRERENDERED_HELP
+  const CommandLinePrerenderedHelp& help = testPrerenderedHelp;
+  expect(std::string(help.text, help.size) == parser->renderHelpText() + "\n");
+  expect(help.actionCount == parser->actions().size());
+  for (size_t i = 0; i < help.actionCount; i++) {
+    const CommandLineAction* action = parser->actions()[i];
+    expect(action->actionName == help.actions[i].actionName);
+    expect(std::string(help.actions[i].text, help.actions[i].size) == action->renderHelpText(parser->toolFilename) + "\n");
+  }
+#endif
+  std::string source = renderPrerenderedHelpSource(*parser, "toolHelpText");
+  expect(source.find("const commandline::CommandLinePrerenderedHelp toolHelpText = {") != std::string::npos);
+  expect(source.find("C:\\\\sources, quickly\\077") != std::string::npos);
+
+  // "-h" writes the prerendered text as it is
+  const CommandLinePrerenderedAction actions[] = { { "build", "build help\n", 11 } };
+  const CommandLinePrerenderedHelp prerendered = { "tool help\n", 10, actions, 1 };
+  const char* inputs[][2] = { { "-h", nullptr }, { "build", "-h" } };
+  const char* outputs[] = { "tool help\n", "build help\n" };
+  for (size_t i = 0; i < 2; i++) {
+    std::unique_ptr<CommandLineParser> tool(createPrerenderParser());
+    tool->usePrerenderedHelp(&prerendered);
+    std::vector<std::string> args = { inputs[i][0] };
+    if (inputs[i][1] != nullptr) args.push_back(inputs[i][1]);
+    std::stringstream captured;
+    std::streambuf* previous = std::cout.rdbuf(captured.rdbuf());
+    try {
+      tool->execute(args);
+    } catch (const std::exception& err) {
+      std::cout.rdbuf(previous);
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+    std::cout.rdbuf(previous);
+    expect(captured.str() == outputs[i]);
+  }
+  return 0;
+}
+
+static int constructs_only_the_selected_registered_action() {
+  registeredActionsConstructed = 0;
+  DynamicCommandLineParser commandLineParser;
+  commandLineParser.addRegisteredActions();
+  std::string help = commandLineParser.renderHelpText();
+  expect(help.find("publish") != std::string::npos && help.find("Remove the package") != std::string::npos);
+  expect(registeredActionsConstructed == 0);
+  CommandLineActionRegistry registry = registeredActions();
+  expect(registry.find("unpublish") != nullptr && std::string(registry.find("publish")->actionName) == "publish");
+  expect(registry.find("publis") == nullptr && registry.find("zzz") == nullptr && registry.find("") == nullptr);
+  // Searching reads the descriptors, it constructs nothing either
+  std::string results = commandLineParser.renderSearchResults("package remove");
+  expect(results.find("unpublish") != std::string::npos && results.find("  publish") == std::string::npos);
+  DynamicCommandLineParser searching;
+  searching.addRegisteredActions();
+  try {
+    searching.execute({ "help", "--search", "publish" });
+    expect(searching.selectedAction == nullptr);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  expect(registeredActionsConstructed == 0);
+  DynamicCommandLineParser withRemainder;
+  CommandLineRemainderDefinition remainderDef;
+  remainderDef.description = "Arguments";
+  withRemainder.defineCommandLineRemainder(remainderDef);
+  withRemainder.addRegisteredActions();
+  try {
+    withRemainder.execute({ "publish" });
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == REMAINDER_DEFINED);
+  }
+  try {
+    commandLineParser.execute({ "publish", "--registry", "https://example.org" });
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  expect(registeredActionsConstructed == 1);
+  expect(commandLineParser.actions().size() == 1);
+  RegisteredPublishAction* publish = static_cast<RegisteredPublishAction*>(commandLineParser.selectedAction);
+  expect(publish->actionName == "publish" && publish->done);
+  expect(publish->getStringParameter("--registry")->value() == "https://example.org");
+  return 0;
+}
+
+static int records_execution_telemetry() {
+  const char* telemetryPath = "commandlinetest-telemetry.bin";
+  std::remove(telemetryPath);
+
+  expect(CommandLineHistogram::bucketOf(15) == 15);
+  expect(CommandLineHistogram::bucketLimit(CommandLineHistogram::bucketOf(1000)) >= 1000);
+  expect(CommandLineHistogram::bucketLimit(CommandLineHistogram::bucketOf(1000)) <= 1125);
+  expect(CommandLineHistogram::bucketOf(UINT64_MAX) == CommandLineHistogram::bucketCount - 1);
+
+  for (int run = 0; run < 2; run++) {
+    CommandLineParserOptions o;
+    o.telemetryPath = telemetryPath;
+    DynamicCommandLineParser commandLineParser(o);
+    CommandLineActionOptions actionOptions;
+    actionOptions.actionName = "serve";
+    actionOptions.summary = "serves";
+    commandLineParser.addAction(new DynamicCommandLineAction(actionOptions));
+    try {
+      commandLineParser.execute({ "serve" });
+    } catch (const std::exception& err) {
+      std::cerr << err.what() << std::endl;
+      return 1;
+    }
+  }
+  {
+    CommandLineTelemetry telemetry(telemetryPath);
+    for (uint64_t i = 1; i <= 100; i++) {
+      CommandLineExecutionSample sample = { i * 1000, i * 10, 0, i > 95 };
+      telemetry.record("build", sample);
+    }
+  }
+
+  std::vector<CommandLineActionTelemetry> actions = CommandLineTelemetry::read(telemetryPath);
+  std::remove(telemetryPath);
+  expect(actions.size() == 2);
+  expect(actions[0].actionName == "build" && actions[1].actionName == "serve");
+  expect(actions[1].runs == 2 && actions[1].failures == 0 && actions[1].wallMicros.count == 2);
+  const CommandLineActionTelemetry& build = actions[0];
+  expect(build.runs == 100 && build.failures == 5);
+  expect(build.wallMicros.max == 100000 && build.wallMicros.sum == 5050000);
+  expect(build.wallMicros.percentile(0.5) >= 50000 && build.wallMicros.percentile(0.5) < 50000 * 9 / 8);
+  expect(build.wallMicros.percentile(0.99) >= 99000 && build.wallMicros.percentile(0.99) <= 100000);
+  expect(build.cpuMicros.percentile(1) == 1000);
+
+  std::string report = CommandLineTelemetry::renderReport(actions);
+  expect(report.find("build: 100 runs, 5 failed") != std::string::npos);
+  expect(report.find("serve: 2 runs, 0 failed") != std::string::npos);
+  expect(report.find("100.00ms") != std::string::npos);
+
+  try {
+    CommandLineTelemetry::read(telemetryPath);
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == TELEMETRY_FAILED);
+  }
   return 0;
 }
 
@@ -387,11 +1426,668 @@ static int test_global_help() {
   return 0;
 }
 
+static DynamicCommandLineParser* createNumericParser() {
+  DynamicCommandLineParser* commandLineParser = new DynamicCommandLineParser();
+
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "serve";
+  actionOptions.summary = "serves";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser->addAction(action);
+
+  CommandLineDoubleDefinition doubleDef;
+  doubleDef.parameterLongName = "--ratio";
+  doubleDef.parameterShortName = "-r";
+  doubleDef.argumentName = "RATIO";
+  doubleDef.description = "A ratio";
+  doubleDef.minimum = -1;
+  doubleDef.maximum = 1;
+  action->defineDoubleParameter(doubleDef);
+
+  CommandLineUnsignedDefinition unsignedDef;
+  unsignedDef.parameterLongName = "--count";
+  unsignedDef.argumentName = "COUNT";
+  unsignedDef.description = "A count";
+  unsignedDef.defaultValue = 3;
+  unsignedDef.maximum = 10;
+  action->defineUnsignedParameter(unsignedDef);
+
+  CommandLineByteSizeDefinition sizeDef;
+  sizeDef.parameterLongName = "--buffer";
+  sizeDef.argumentName = "SIZE";
+  sizeDef.description = "A buffer size";
+  sizeDef.defaultValue = 4096;
+  action->defineByteSizeParameter(sizeDef);
+
+  CommandLineDurationDefinition durationDef;
+  durationDef.parameterLongName = "--timeout";
+  durationDef.argumentName = "DURATION";
+  durationDef.description = "A timeout";
+  durationDef.environmentVariable = "COMMANDLINE_TEST_TIMEOUT";
+  durationDef.defaultValue = std::chrono::seconds(30);
+  action->defineDurationParameter(durationDef);
+
+  return commandLineParser;
+}
+
+static int parses_numeric_size_and_duration_parameters() {
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createNumericParser());
+  CommandLineAction* action = commandLineParser->getAction("serve");
+  try {
+    commandLineParser->execute({ "serve", "-r", "-0.75e0", "--count", "7", "--buffer=1.5MiB", "--timeout", "1m30s" });
+    expect(action->getDoubleParameter("--ratio")->value() == -0.75);
+    expect(action->getUnsignedParameter("--count")->value() == 7);
+    expect(action->getByteSizeParameter("--buffer")->value() == 1572864);
+    expect(action->getDurationParameter("--timeout")->value() == std::chrono::seconds(90));
+
+    std::vector<std::string> argList;
+    for (const CommandLineParameter* p : action->parameters()) {
+      p->appendToArgList(argList);
+    }
+    expect(argList.size() == 8);
+    expect(argList[3] == "7");
+    expect(argList[5] == "1536KiB");
+    expect(argList[7] == "90s");
+
+    std::string help = action->renderHelpText("example");
+    expect(help.find("--timeout, $COMMANDLINE_TEST_TIMEOUT [Duration] (30s)") != std::string::npos);
+    expect(help.find("--buffer [ByteSize] (4KiB)") != std::string::npos);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  // Doubles are written with a dot whatever the locale of the application
+  struct CommaDecimal : std::numpunct<char> {
+    char do_decimal_point() const { return ','; }
+  };
+  std::locale previous = std::locale::global(std::locale(std::locale::classic(), new CommaDecimal()));
+  std::unique_ptr<DynamicCommandLineParser> localized(createNumericParser());
+  double ratio = 0;
+  std::vector<std::string> ratioArgs;
+  std::string rendered;
+  try {
+    localized->execute({ "serve", "--ratio", "0.25" });
+    ratio = localized->getAction("serve")->getDoubleParameter("--ratio")->value();
+    localized->getAction("serve")->getDoubleParameter("--ratio")->appendToArgList(ratioArgs);
+    CommandLineArgumentBuffer buffer("worker");
+    buffer.addProvider(localized->getAction("serve"));
+    buffer.setFilter([](const CommandLineParameter* p) { return p->longName == "--ratio"; });
+    rendered = buffer.argc() == 3 ? buffer.argv()[2] : "";
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+  }
+  std::locale::global(previous);
+  expect(ratio == 0.25);
+  expect(ratioArgs.size() == 2 && ratioArgs[1] == "0.25");
+  expect(rendered == "0.25");
+  return 0;
+}
+
+static int rejects_invalid_numeric_values() {
+  const std::vector<std::vector<std::string>> inputs = {
+    { "serve", "--ratio", "2" },
+    { "serve", "--count", "11" },
+    { "serve", "--count", "-1" },
+    { "serve", "--buffer", "64XiB" },
+    { "serve", "--buffer", "1.5B" },
+    { "serve", "--buffer", "0.1KiB" },
+    { "serve", "--timeout", "1500" },
+    { "serve", "--timeout", "1x" }
+  };
+  const CommandLineErrorCode codes[] = {
+    VALUE_OUT_OF_RANGE, VALUE_OUT_OF_RANGE, INVALID_VALUE, INVALID_VALUE, INVALID_VALUE, INVALID_VALUE, INVALID_VALUE, INVALID_VALUE
+  };
+  for (size_t i = 0; i < inputs.size(); i++) {
+    std::unique_ptr<DynamicCommandLineParser> commandLineParser(createNumericParser());
+    try {
+      commandLineParser->execute(inputs[i]);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == codes[i]);
+    }
+  }
+
+  // The implicit default 0 is checked against the range like any other
+  DynamicCommandLineParser rangeParser;
+  CommandLineDoubleDefinition levelDef;
+  levelDef.parameterLongName = "--level";
+  levelDef.argumentName = "LEVEL";
+  levelDef.description = "A level";
+  levelDef.minimum = 1;
+  levelDef.maximum = 10;
+  try {
+    rangeParser.defineDoubleParameter(levelDef);
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == VALUE_OUT_OF_RANGE);
+  }
+  levelDef.required = true;
+  expect(rangeParser.defineDoubleParameter(levelDef) != nullptr);
+  return 0;
+}
+
+static DynamicCommandLineParser* createPatternParser() {
+  DynamicCommandLineParser* commandLineParser = new DynamicCommandLineParser();
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "create";
+  actionOptions.summary = "creates";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser->addAction(action);
+
+  CommandLineStringDefinition nameDef;
+  nameDef.parameterLongName = "--name";
+  nameDef.description = "The name";
+  nameDef.argumentName = "NAME";
+  nameDef.pattern = "^[a-z0-9-]{1,63}$";
+  action->defineStringParameter(nameDef);
+
+  CommandLineStringListDefinition tagDef;
+  tagDef.parameterLongName = "--tag";
+  tagDef.description = "A tag";
+  tagDef.argumentName = "TAG";
+  tagDef.pattern = "^[a-z]+=[^=]*$";
+  action->defineStringListParameter(tagDef);
+  return commandLineParser;
+}
+
+static int matches_values_against_patterns() {
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createPatternParser());
+  std::vector<std::string> args = { "create", "--name", "web-01" };
+  for (int i = 0; i < 10000; i++) {
+    args.push_back("--tag");
+    args.push_back("k=" + std::to_string(i));
+  }
+  try {
+    commandLineParser->execute(args);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  CommandLineAction* action = commandLineParser->selectedAction;
+  expect(action->getStringParameter("--name")->value() == "web-01");
+  expect(action->getStringListParameter("--tag")->values().size() == 10000);
+  std::vector<std::string> notes;
+  action->getStringParameter("--name")->_getSupplementaryNotes(notes);
+  expect(notes.back() == "The value must match the pattern \"^[a-z0-9-]{1,63}$\".");
+
+  const std::vector<std::vector<std::string>> inputs = {
+    { "create", "--name", "Web-01" },
+    { "create", "--name", std::string(64, 'a') },
+    { "create", "--tag", "k=v", "--tag", "k=v=w" }
+  };
+  for (const std::vector<std::string>& input : inputs) {
+    std::unique_ptr<DynamicCommandLineParser> parser(createPatternParser());
+    try {
+      parser->execute(input);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == INVALID_VALUE);
+    }
+  }
+
+  DynamicCommandLineParser definitions;
+  CommandLineStringDefinition searched;
+  searched.parameterLongName = "--id";
+  searched.argumentName = "VALUE";
+  searched.pattern = "[0-9]+|^none$";
+  const CommandLineStringParameter* id = definitions.defineStringParameter(searched);
+  expect(id->matchesPattern("id-42") && id->matchesPattern("none") && !id->matchesPattern("none-x"));
+  CommandLineStringDefinition invalid;
+  invalid.parameterLongName = "--invalid";
+  invalid.argumentName = "VALUE";
+  invalid.pattern = "^[a-z+$";
+  try {
+    definitions.defineStringParameter(invalid);
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == PATTERN_INVALID);
+    expect(std::string(err.what()).find("at offset 1") != std::string::npos);
+  }
+  CommandLineStringDefinition mismatchedDefault;
+  mismatchedDefault.parameterLongName = "--default";
+  mismatchedDefault.argumentName = "VALUE";
+  mismatchedDefault.pattern = "^[a-z]+$";
+  mismatchedDefault.defaultValue = "A";
+  try {
+    definitions.defineStringParameter(mismatchedDefault);
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == INVALID_VALUE);
+  }
+  return 0;
+}
+
+enum class Region { North, South, East, West };
+
+static int maps_choice_alternatives_to_indexes() {
+  DynamicCommandLineParser commandLineParser;
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "deploy";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser.addAction(action);
+
+  CommandLineChoiceDefinition regionDef;
+  regionDef.parameterLongName = "--region";
+  regionDef.description = "The region";
+  regionDef.alternatives = { "north", "south", "east", "west" };
+  regionDef.defaultValue = "east";
+  CommandLineEnumChoiceParameter<Region> region(action->defineChoiceParameter(regionDef));
+
+  CommandLineChoiceDefinition targetDef;
+  targetDef.parameterLongName = "--target";
+  targetDef.description = "The target";
+  for (int i = 0; i < 5000; i++) {
+    targetDef.alternatives.push_back("target-" + std::to_string(i));
+  }
+  CommandLineChoiceParameter* target = action->defineChoiceParameter(targetDef);
+
+  try {
+    commandLineParser.execute({ "deploy", "--target", "target-4321" });
+    expect(region.value() == Region::East);
+    expect(region.parameter()->value() == "east");
+    expect(target->index() == 4321);
+    expect(target->value() == "target-4321");
+    expect(target->indexOf("target-9999") == -1);
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static DynamicCommandLineParser* createConstrainedParser() {
+  DynamicCommandLineParser* commandLineParser = new DynamicCommandLineParser();
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "copy";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser->addAction(action);
+
+  CommandLineChoiceDefinition modeDef;
+  modeDef.parameterLongName = "--mode";
+  modeDef.description = "The copy mode";
+  modeDef.alternatives = { "local", "remote" };
+  modeDef.defaultValue = "local";
+  action->defineChoiceParameter(modeDef);
+  const char* names[] = { "--host", "--json", "--yaml", "--key", "--cert", "--source", "--stdin" };
+  for (const char* name : names) {
+    CommandLineStringDefinition definition;
+    definition.parameterLongName = name;
+    definition.description = "A string";
+    definition.argumentName = "VALUE";
+    action->defineStringParameter(definition);
+  }
+  action->defineRequiredWhen("--mode", "remote", { "--host" });
+  action->defineMutuallyExclusive({ "--json", "--yaml" });
+  action->defineRequires("--key", { "--cert" });
+  action->defineAtLeastOneOf({ "--source", "--stdin" });
+  return commandLineParser;
+}
+
+static int reports_every_constraint_violation() {
+  std::vector<CommandLineError> violations;
+  std::unique_ptr<DynamicCommandLineParser> commandLineParser(createConstrainedParser());
+  try {
+    commandLineParser->execute({ "copy", "--mode", "remote", "--json", "a", "--yaml", "b", "--key", "k" });
+    return 1;
+  } catch (const CommandLineConstraintError& err) {
+    expect(err.code() == VALUE_REQUIRED);
+    violations = err.violations();
+  }
+  expect(violations.size() == 4);
+  expect(violations[0].code() == VALUE_REQUIRED);
+  expect(std::string(violations[0].what()) == "--host is required when --mode is remote");
+  expect(violations[1].code() == PARAMETERS_MUTUALLY_EXCLUSIVE);
+  expect(violations[2].code() == PARAMETER_DEPENDENCY_MISSING);
+  expect(std::string(violations[2].what()) == "--key requires --cert");
+  expect(violations[3].code() == PARAMETER_GROUP_EMPTY);
+
+  commandLineParser.reset(createConstrainedParser());
+  try {
+    commandLineParser->execute({ "copy", "--json", "a", "--stdin", "in.txt" });
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  try {
+    commandLineParser->selectedAction->defineMutuallyExclusive({ "--json", "--xml" });
+    return 1;
+  } catch (const CommandLineError& err) {
+    expect(err.code() == PARAMETER_UNDEFINED);
+  }
+  return 0;
+}
+
+static const char* testSpec = R"({
+  "toolFilename": "spec-tool",
+  "toolDescription": "A tool defined by a spec",
+  "parameters": [
+    { "kind": "Flag", "parameterLongName": "--verbose", "parameterShortName": "-v", "description": "Verbose output" }
+  ],
+  "actions": [
+    {
+      "actionName": "build",
+      "summary": "Builds the project",
+      "parameters": [
+        { "kind": "Choice", "parameterLongName": "--mode", "description": "Build mode", "alternatives": ["debug", "release"], "defaultValue": "release" },
+        { "kind": "Integer", "parameterLongName": "--jobs", "parameterShortName": "-j", "argumentName": "COUNT", "description": "Parallel jobs", "defaultValue": 4 },
+        { "kind": "StringList", "parameterLongName": "--target", "argumentName": "NAME", "description": "Targets \u2713" }
+      ]
+    }
+  ]
+})";
+
+static int loads_a_spec_file() {
+  const char* specPath = "commandlinetest-spec.json";
+  const std::string cachePath = std::string(specPath) + ".cache";
+  {
+    std::ofstream spec(specPath);
+    spec << testSpec;
+  }
+  std::remove(cachePath.c_str());
+
+  int result = 0;
+  for (int run = 0; run < 2; run++) {
+    DynamicCommandLineParser commandLineParser;
+    try {
+      commandLineParser.loadSpec(specPath, true);
+      expect(commandLineParser.toolFilename == "spec-tool");
+      commandLineParser.execute({ "-v", "build", "-j", "8", "--target", "a", "--target", "b" });
+      CommandLineAction* action = commandLineParser.getAction("build");
+      expect(commandLineParser.selectedAction == action);
+      expect(action->documentation == "Builds the project");
+      expect(commandLineParser.getFlagParameter("--verbose")->value() == true);
+      expect(action->getChoiceParameter("--mode")->value() == "release");
+      expect(action->getIntegerParameter("--jobs")->value() == 8);
+      expect(action->getStringListParameter("--target")->values().size() == 2);
+      expect(action->getStringListParameter("--target")->description == "Targets \xE2\x9C\x93");
+      std::ifstream cache(cachePath);
+      expect(cache.is_open());
+    } catch (const std::exception& err) {
+      std::cerr << err.what() << std::endl;
+      result = 1;
+      break;
+    }
+  }
+  if (result == 0) {
+    {
+      std::ofstream spec(specPath, std::ios::trunc);
+      spec << R"({ "toolFilename": "changed-tool" })";
+    }
+    DynamicCommandLineParser commandLineParser;
+    commandLineParser.loadSpec(specPath, true);
+    expect(commandLineParser.toolFilename == "changed-tool");
+  }
+  std::remove(specPath);
+  std::remove(cachePath.c_str());
+  return result;
+}
+
+static int rejects_an_invalid_spec() {
+  const char* specPath = "commandlinetest-invalid-spec.json";
+  std::vector<std::string> specs = {
+    R"({ "parameters": [ { "kind": "Flag", "parameterLongName": "--x" }, ] })",
+    R"({ "parameters": [ { "kind": "Integer", "parameterLongName": "--x", "argumentName": "N", "defaultValue": 1.5 } ] })",
+    R"({ "parameters": [ { "kind": "Integer", "parameterLongName": "--x", "argumentName": "N", "defaultValue": 9223372036854775808 } ] })",
+    R"({ "parameters": [ { "kind": "Unsigned", "parameterLongName": "--x", "argumentName": "N", "minimum": -1 } ] })",
+    R"({ "parameters": [ { "kind": "Unsigned", "parameterLongName": "--x", "argumentName": "N", "maximum": 1e30 } ] })",
+    R"({ "parameters": [ { "kind": "Double", "parameterLongName": "--x", "argumentName": "N", "maximum": 1e999 } ] })",
+    "{ \"parameters\": " + std::string(300, '[') + std::string(300, ']') + " }"
+  };
+  for (const std::string& text : specs) {
+    {
+      std::ofstream spec(specPath);
+      spec << text;
+    }
+    DynamicCommandLineParser commandLineParser;
+    try {
+      commandLineParser.loadSpec(specPath);
+      std::remove(specPath);
+      return 1;
+    } catch (const CommandLineError& err) {
+      expect(err.code() == SPEC_INVALID);
+    }
+  }
+  std::remove(specPath);
+  return 0;
+}
+
+#ifdef COMMANDLINE_TEST_PLUGIN_PATH
+static int loads_only_the_selected_plugin() {
+  const char* manifestPath = "commandlinetest-plugins.manifest";
+  {
+    std::ofstream manifest(manifestPath);
+    manifest << "# test plugins" << std::endl;
+    manifest << "print\t" << COMMANDLINE_TEST_PLUGIN_PATH << "\tcommandline_test_plugin_entry\tPrints a message" << std::endl;
+    manifest << "missing\t/nonexistent/libmissing.so\tmissing_entry\tNever loaded" << std::endl;
+  }
+
+  CommandLineParserOptions options;
+  options.toolFilename = "example";
+  options.toolDescription = "An example project";
+  DynamicCommandLineParser commandLineParser(options);
+  try {
+    commandLineParser.loadPluginManifest(manifestPath);
+    std::remove(manifestPath);
+    expect(commandLineParser.actions().size() == 2);
+
+    CommandLinePluginAction* print = static_cast<CommandLinePluginAction*>(commandLineParser.getAction("print"));
+    CommandLinePluginAction* missing = static_cast<CommandLinePluginAction*>(commandLineParser.getAction("missing"));
+    expect(print->loaded() == false);
+    expect(missing->summary == "Never loaded");
+    expect(commandLineParser.renderHelpText().find("Never loaded") != std::string::npos);
+
+    commandLineParser.execute({ "print", "--message", "hello" });
+    expect(commandLineParser.selectedAction == print);
+    expect(print->loaded() == true);
+    expect(missing->loaded() == false);
+    expect(print->documentation == "Prints a message from a plugin");
+    expect(print->getStringParameter("--message")->value() == "hello");
+  } catch (const std::exception& err) {
+    std::remove(manifestPath);
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+  return 0;
+}
+
+static int reports_an_unloadable_plugin() {
+  CommandLinePluginManifestEntry entry;
+  entry.actionName = "missing";
+  entry.summary = "Never loaded";
+  entry.libraryPath = "/nonexistent/libmissing.so";
+  entry.entrySymbol = "missing_entry";
+
+  DynamicCommandLineParser commandLineParser;
+  commandLineParser.addAction(new CommandLinePluginAction(entry));
+  try {
+    commandLineParser.execute({ "missing" });
+  } catch (const CommandLineError& err) {
+    expect(err.code() == PLUGIN_LOAD_FAILED);
+    return 0;
+  }
+  return 1;
+}
+#endif
+
+static int reparses_only_the_edited_tokens() {
+  DynamicCommandLineParser commandLineParser;
+  CommandLineFlagDefinition verboseDef;
+  verboseDef.parameterLongName = "--verbose";
+  verboseDef.description = "Verbose output";
+  commandLineParser.defineFlagParameter(verboseDef);
+
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "do:the-job";
+  actionOptions.summary = "does the job";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  commandLineParser.addAction(action);
+  CommandLineIntegerDefinition countDef;
+  countDef.parameterLongName = "--count";
+  countDef.parameterShortName = "-c";
+  countDef.description = "How many times";
+  countDef.argumentName = "N";
+  action->defineIntegerParameter(countDef);
+  CommandLineChoiceDefinition modeDef;
+  modeDef.parameterLongName = "--mode";
+  modeDef.description = "How to do it";
+  modeDef.alternatives = { "fast", "slow" };
+  action->defineChoiceParameter(modeDef);
+
+  CommandLineIncrementalParser incremental(commandLineParser);
+  incremental.reset({ "--verbose", "do:the-job", "--count", "x" });
+  expect(incremental.selectedAction() == action);
+  expect(incremental.tokens()[1].kind == CommandLineTokenKind::Action);
+  std::vector<CommandLineDiagnostic> diagnostics = incremental.diagnostics();
+  expect(diagnostics.size() == 1);
+  expect(diagnostics[0].tokenIndex == 3);
+  expect(diagnostics[0].code == INVALID_VALUE);
+
+  CommandLineReparseRange range = incremental.apply(CommandLineEdit{ 3, 1, { "5" } });
+  expect(range.first == 2);
+  expect(range.count == 2);
+  expect(incremental.diagnostics().empty());
+
+  incremental.apply(CommandLineEdit{ 4, 0, { "--mode" } });
+  diagnostics = incremental.diagnostics();
+  expect(diagnostics.size() == 1);
+  expect(diagnostics[0].code == VALUE_REQUIRED);
+  CommandLineCompletionContext completion = incremental.completion(5);
+  expect(completion.kind == CommandLineCompletionKind::ParameterValue);
+  expect(completion.candidates == std::vector<std::string>({ "fast", "slow" }));
+
+  incremental.apply(CommandLineEdit{ 5, 0, { "s" } });
+  expect(incremental.tokens()[5].kind == CommandLineTokenKind::Value);
+  expect(incremental.diagnostics().size() == 1);
+  expect(incremental.completion(5).candidates == std::vector<std::string>({ "slow" }));
+  incremental.apply(CommandLineEdit{ 5, 1, { "slow" } });
+  expect(incremental.diagnostics().empty());
+
+  completion = incremental.completion(6);
+  expect(completion.kind == CommandLineCompletionKind::None);
+  incremental.apply(CommandLineEdit{ 6, 0, { "--c" } });
+  completion = incremental.completion(6);
+  expect(completion.kind == CommandLineCompletionKind::ParameterName);
+  expect(completion.candidates == std::vector<std::string>({ "--count" }));
+
+  // Removing the action changes the meaning of everything after it
+  range = incremental.apply(CommandLineEdit{ 1, 1, {} });
+  expect(incremental.selectedAction() == nullptr);
+  expect(range.count == incremental.tokens().size());
+  expect(incremental.tokens()[1].errorCode == PARAMETER_UNDEFINED);
+  expect(incremental.completion(1).kind == CommandLineCompletionKind::ParameterName);
+
+  std::vector<std::string> line = { "do:the-job" };
+  for (int i = 0; i < 5000; i++) {
+    line.push_back("-c");
+    line.push_back(std::to_string(i + 1));
+  }
+  incremental.reset(line);
+  expect(incremental.diagnostics().empty());
+  range = incremental.apply(CommandLineEdit{ 5000, 1, { "--mode" } });
+  expect(range.count <= 3);
+  expect(incremental.tokens()[5000].parameter == action->getChoiceParameter("--mode"));
+  // both "-c" and "--mode" now lack a value
+  expect(incremental.diagnostics().size() == 2);
+  return 0;
+}
+
+#ifndef _WIN32
+static void defineGreetParameters(DynamicCommandLineAction* action) {
+  CommandLineStringDefinition d;
+  d.parameterLongName = "--name";
+  d.description = "Who to greet";
+  d.argumentName = "NAME";
+  d.environmentVariable = "COMMANDLINE_TEST_GREET_NAME";
+  action->defineStringParameter(d);
+}
+
+static void executeGreet(DynamicCommandLineAction* action) {
+  std::cout << "hello " << action->getStringParameter("--name")->value() << std::endl;
+}
+
+static std::string readAll(int fd) {
+  std::string out;
+  char buffer[256];
+  ssize_t n;
+  while ((n = read(fd, buffer, sizeof(buffer))) > 0) {
+    out.append(buffer, static_cast<size_t>(n));
+  }
+  return out;
+}
+
+static int serves_clients_from_a_resident_parser() {
+  const std::string socketPath = "commandlinetest-server.sock";
+  CommandLineParserOptions options;
+  options.toolFilename = "example";
+  options.toolDescription = "An example project";
+  DynamicCommandLineParser commandLineParser(options);
+  CommandLineActionOptions actionOptions;
+  actionOptions.actionName = "greet";
+  actionOptions.summary = "greets someone";
+  DynamicCommandLineAction* action = new DynamicCommandLineAction(actionOptions);
+  action->setCallbacks(defineGreetParameters, executeGreet);
+  commandLineParser.addAction(action);
+
+  CommandLineServer commandLineServer(&commandLineParser, socketPath);
+  commandLineServer.listen();
+  struct stat st;
+  expect(stat(socketPath.c_str(), &st) == 0 && (st.st_mode & 0777) == 0600);
+  std::fflush(nullptr);
+  pid_t server = fork();
+  if (server == 0) {
+    commandLineServer.serve();
+    _exit(0);
+  }
+
+  // A live server keeps its socket
+  CommandLineServer secondServer(&commandLineParser, socketPath);
+  bool replaced = true;
+  try {
+    secondServer.listen();
+  } catch (const CommandLineError& err) {
+    replaced = err.code() != SERVER_ERROR;
+  }
+
+  int first = -1, second = -1, third = -1;
+  std::string output;
+  int out[2];
+  if (pipe(out) == 0) {
+    try {
+      setenv("COMMANDLINE_TEST_GREET_NAME", "environment", 1);
+      first = CommandLineServer::forward(socketPath, { "greet" }, 0, out[1], 2);
+      unsetenv("COMMANDLINE_TEST_GREET_NAME");
+      second = CommandLineServer::forward(socketPath, { "greet", "--name", "world" }, 0, out[1], 2);
+      third = CommandLineServer::forward(socketPath, { "unknown" }, 0, out[1], out[1]);
+    } catch (const std::exception& err) {
+      std::cerr << err.what() << std::endl;
+    }
+    close(out[1]);
+    output = readAll(out[0]);
+    close(out[0]);
+  }
+  kill(server, SIGTERM);
+  waitpid(server, nullptr, 0);
+
+  expect(!replaced);
+  expect(first == 0);
+  expect(second == 0);
+  expect(third == 1);
+  expect(output.find("hello environment\nhello world\n") == 0);
+  expect(commandLineParser.selectedAction == nullptr);
+  return 0;
+}
+#endif
+
 int main() {
   int r = 0;
   int ret = 0;
   r = describe("CommandLineParser", 
-    executes_an_action
+    executes_an_action,
+    executes_an_action_asynchronously,
+    runs_a_deferred_action,
+    cancels_an_action_after_its_timeout,
+    cancels_an_action_on_sigint
   );
   if (r != 0) {
     ret = r;
@@ -407,6 +2103,7 @@ int main() {
 
   r = describe("CommandLineRemainder", 
     parses_an_action_input_with_remainder,
+    renders_an_argument_buffer,
     prints_the_action_help,
     prints_the_global_help
   );
@@ -415,19 +2112,67 @@ int main() {
   }
 
   r = describe("DynamicCommandLineParser", 
-    parse_an_action
+    parse_an_action,
+    loads_a_spec_file,
+    rejects_an_invalid_spec
   );
   if (r != 0) {
     ret = r;
   }
+
+  r = describe("CommandLineIncrementalParser",
+    reparses_only_the_edited_tokens
+  );
+  if (r != 0) {
+    ret = r;
+  }
+#ifdef COMMANDLINE_TEST_PLUGIN_PATH
+  r = describe("CommandLinePluginAction", 
+    loads_only_the_selected_plugin,
+    reports_an_unloadable_plugin
+  );
+  if (r != 0) {
+    ret = r;
+  }
+#endif
+
   r = describe("CommandLineParameter", 
     parses_an_input_with_ALL_parameters,
     parses_an_input_with_NO_parameters,
+    parses_global_values_before_the_action,
+    accepts_global_values_after_the_action,
+    reports_the_position_of_scan_errors,
+    suggests_names_for_unknown_options_and_actions,
+    rejects_input_beyond_strict_limits,
+    resolves_environment_values_on_first_read,
+    encodes_a_parse_result,
+    parses_numeric_size_and_duration_parameters,
+    rejects_invalid_numeric_values,
+    matches_values_against_patterns,
+    maps_choice_alternatives_to_indexes,
+    keeps_static_schema_text_in_place,
+    keeps_help_text_compressed_until_read,
+    shares_a_parameter_set_between_scopes,
+    writes_values_into_bound_fields,
+    reports_every_constraint_violation,
+    searches_the_help_of_all_actions,
+    prerenders_the_help_at_build_time,
+    constructs_only_the_selected_registered_action,
+    records_execution_telemetry,
     test_global_help,
     test_action_help
   );
   if (r != 0) {
     ret = r;
   }
+
+#ifndef _WIN32
+  r = describe("CommandLineServer",
+    serves_clients_from_a_resident_parser
+  );
+  if (r != 0) {
+    ret = r;
+  }
+#endif
   return ret;
 }